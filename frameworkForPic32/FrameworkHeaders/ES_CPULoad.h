@@ -0,0 +1,60 @@
+/****************************************************************************
+ Module
+     ES_CPULoad.h
+ Description
+     header file for the CPU utilization accounting done by ES_Run
+ Notes
+     The accounting is only compiled in when ES_USE_CPU_LOAD is defined in
+     ES_Configure.h
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/18/26       karthi24     the accounting state is kept in the framework context
+ 10/18/26       karthi24     started coding
+*****************************************************************************/
+
+#ifndef ES_CPULoad_H
+#define ES_CPULoad_H
+
+#include "ES_Types.h"
+
+// the places that ES_Run charges its time to
+typedef enum
+{
+  CPU_LOAD_RUN = 0,   // run functions & timer tick responses
+  CPU_LOAD_CHECK,     // event checker passes that found an event
+  CPU_LOAD_UART,      // moving bytes from the transmit buffer to the UART
+  CPU_LOAD_IDLE,      // passes through the loop that found nothing to do
+  CPU_LOAD_NUM_BUCKETS
+}ES_CPULoadBucket_t;
+
+// number of 1 second windows that make up the long average
+#define CPU_LOAD_LONG_WINDOWS 10
+
+// the accounting for one framework context (see ES_Context.h)
+typedef struct
+{
+  // core count at the last charge
+  uint32_t LastMark;
+  // core counts charged to each bucket in the current 1s window
+  uint32_t BucketCounts[CPU_LOAD_NUM_BUCKETS];
+  // core counts in the current 1s window
+  uint32_t WindowCounts;
+  // results from the last completed 1s window
+  uint8_t BucketPercent[CPU_LOAD_NUM_BUCKETS];
+  uint8_t Utilization1s;
+  // the last CPU_LOAD_LONG_WINDOWS 1s utilization figures
+  uint8_t History[CPU_LOAD_LONG_WINDOWS];
+  uint8_t HistoryIndex;
+  uint8_t HistoryFilled;
+  // windows until the next telemetry line, see CPU_LOAD_TELEMETRY_PERIOD
+  uint8_t SecondsToTelemetry;
+}ES_CPULoadState_t;
+
+void ES_CPULoad_Init(void);
+void ES_CPULoad_Charge(ES_CPULoadBucket_t Bucket);
+uint8_t ES_CPULoad_GetUtilization1s(void);
+uint8_t ES_CPULoad_GetUtilization10s(void);
+uint8_t ES_CPULoad_GetBucketPercent(ES_CPULoadBucket_t Bucket);
+
+#endif /* ES_CPULoad_H */
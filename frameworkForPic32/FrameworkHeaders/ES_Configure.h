@@ -9,6 +9,30 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/18/26   karthi24     added threaded executor switches, LEDService on worker 1
+ 10/18/26   karthi24     the shell is service 0, the lowest priority, the others
+                          move up one and keep their order
+ 10/18/26   karthi24     GameSM given an event mask, MotorCtrl's drops ES_TIMEOUT
+ 10/18/26   karthi24     added ES_MODE_DONE for the 3 s mode timer
+ 10/18/26   karthi24     gear servo timer is TIMER_UNUSED, it only runs a callback
+ 10/18/26   karthi24     game services registered as instances, SERV_2..4_CONTEXT,
+                         ES_MULTI_CONTEXT notes say what is shared
+ 10/18/26   karthi24     ES_MULTI_CONTEXT described as framework state only
+ 10/18/26   karthi24     added the command shell as service 4, with ES_SHELL_RX
+ 10/18/26   karthi24     added TIMER_CALLBACK_MAX_US, gear servo timer is a callback
+ 10/18/26   karthi24     added the timer events ES_BALLOON_FRAME, ES_COUNTDOWN_TICK,
+                          ES_GAME_OVER & ES_USER_INACTIVE
+ 10/18/26   karthi24     added state machine statistics switch
+ 10/18/26   karthi24     added ES_NUM_EVENT_TYPES for event tables
+ 10/18/26   karthi24     added queue statistics switches
+ 10/18/26   karthi24     added per-service accepted event masks
+ 10/18/26   karthi24     added EVENT_CHECK_SOURCES to gate the event checkers
+ 10/18/26   karthi24     added the short timer interrupt post ring
+ 10/18/26   karthi24     added timing wheel switch
+ 10/18/26   karthi24     added ES_MULTI_CONTEXT switch
+ 10/18/26   karthi24     documented SERV_n_CONTEXT for multi-instance services
+ 10/18/26   karthi24     added interrupt post ring definitions
+ 10/18/26   karthi24     added CPU load accounting switches
  11/10/25   karthi24     began modification for me218a project
  12/19/16 20:19  jec     removed EVENT_CHECK_HEADER definition. This goes with
                          the V2.3 move to a single wrapper for event checking
@@ -36,11 +60,13 @@
 // This macro determines that number of services that are *actually* used in
 // a particular application. It will vary in value from 1 to MAX_NUM_SERVICES
 
-// Service 0: TestHarness service
-// Service 0: GameSM
-// Service 1: MotorCtrl
+// Service 0: the command shell, lowest so typing can't hold up the game
+// Service 1: TestHarness service
+// Service 2: GameSM
+// Service 3: MotorCtrl
+// Service 4: LEDService
 
-#define NUM_SERVICES 4
+#define NUM_SERVICES 5
 
 /****************************************************************************/
 // These are the definitions for Service 0, the lowest priority service.
@@ -48,13 +74,24 @@
 // services are added in numeric sequence (1,2,3,...) with increasing
 // priorities
 // the header file with the public function prototypes
-#define SERV_0_HEADER "TestHarnessService0.h"
+#define SERV_0_HEADER "ES_Shell.h"
 // the name of the Init function
-#define SERV_0_INIT InitTestHarnessService0
+#define SERV_0_INIT InitShellService
 // the name of the run function
-#define SERV_0_RUN RunTestHarnessService0
+#define SERV_0_RUN RunShellService
 // How big should this services Queue be?
 #define SERV_0_QUEUE_SIZE 3
+// the keys go to the other services as ES_NEW_KEY, not to the shell
+#define SERV_0_EVENT_MASK (ES_EVENT_BIT(ES_INIT) | \
+                           ES_EVENT_BIT(ES_SHELL_RX))
+// To register one instance of a multi-instance service, also define
+// SERV_n_CONTEXT as the address of that instance's context, e.g.
+// #define SERV_n_CONTEXT (&BalloonAxis[0])
+// SERV_n_INIT & SERV_n_RUN then name the instance init & run functions
+// Optionally, define SERV_n_EVENT_MASK as the ES_EVENT_BIT()s of the event
+// types that service n handles. Posts of any other type (below 32) are
+// dropped before they reach its queue, and counted (ES_GetFilterDrops).
+// Without it, a service takes every event.
 
 /****************************************************************************/
 // The following sections are used to define the parameters for each of the
@@ -63,45 +100,78 @@
 /****************************************************************************/
 // These are the definitions for Service 1
 #if NUM_SERVICES > 1
-    #define SERV_1_HEADER      "GameSM.h"
-    #define SERV_1_INIT        InitGameSM
-    #define SERV_1_RUN         RunGameSM
-    #define SERV_1_QUEUE_SIZE  5
+// the header file with the public function prototypes
+#define SERV_1_HEADER "TestHarnessService0.h"
+// the name of the Init function
+#define SERV_1_INIT InitTestHarnessService0
+// the name of the run function
+#define SERV_1_RUN RunTestHarnessService0
+// How big should this services Queue be?
+#define SERV_1_QUEUE_SIZE 3
 #endif
 
 /****************************************************************************/
 // These are the definitions for Service 2
 #if NUM_SERVICES > 2
-
-    #define SERV_2_HEADER "MotorCtrl.h"
-    #define SERV_2_INIT   InitMotorCtrl
-    #define SERV_2_RUN    RunMotorCtrl
-    #define SERV_2_QUEUE_SIZE 5
-
+    #define SERV_2_HEADER      "GameSM.h"
+    #define SERV_2_INIT        InitGameSM
+    #define SERV_2_RUN         RunGameSM
+    // the game's state is kept per framework context
+    #define SERV_2_CONTEXT     (&GameSMInstance)
+    #define SERV_2_QUEUE_SIZE  5
+    // the events that have a handler in GameTable. ES_NEW_KEY is for test
+    // mode, which is left through the shell
+    #define SERV_2_EVENT_MASK (ES_EVENT_BIT(ES_INIT) | \
+                               ES_EVENT_BIT(ES_NEW_KEY) | \
+                               ES_EVENT_BIT(ES_HAND_WAVE_DETECTED) | \
+                               ES_EVENT_BIT(ES_DIFFICULTY_CHANGED) | \
+                               ES_EVENT_BIT(DIRECT_HIT_B1) | \
+                               ES_EVENT_BIT(DIRECT_HIT_B2) | \
+                               ES_EVENT_BIT(DIRECT_HIT_B3) | \
+                               ES_EVENT_BIT(NO_HIT_B1) | \
+                               ES_EVENT_BIT(NO_HIT_B2) | \
+                               ES_EVENT_BIT(NO_HIT_B3) | \
+                               ES_EVENT_BIT(ES_OBJECT_CRASHED) | \
+                               ES_EVENT_BIT(ES_LED_PUSH_STEP) | \
+                               ES_EVENT_BIT(ES_COUNTDOWN_TICK) | \
+                               ES_EVENT_BIT(ES_GAME_OVER) | \
+                               ES_EVENT_BIT(ES_USER_INACTIVE) | \
+                               ES_EVENT_BIT(ES_MODE_DONE))
 #endif
 
 /****************************************************************************/
 // These are the definitions for Service 3
 #if NUM_SERVICES > 3
 
-#define SERV_3_HEADER      "LEDService.h"
-#define SERV_3_INIT        InitLEDService
-#define SERV_3_RUN         RunLEDService
-#define SERV_3_QUEUE_SIZE  5
+    #define SERV_3_HEADER "MotorCtrl.h"
+    #define SERV_3_INIT   InitMotorCtrl
+    #define SERV_3_RUN    RunMotorCtrl
+    #define SERV_3_CONTEXT (&MotorCtrlInstance)
+    #define SERV_3_QUEUE_SIZE 5
+    // only the balloon frames, so broadcast keystrokes don't fill the queue.
+    // The gear servo timer runs a callback, it doesn't post.
+    #define SERV_3_EVENT_MASK (ES_EVENT_BIT(ES_INIT) | \
+                               ES_EVENT_BIT(ES_BALLOON_FRAME))
 
 #endif
 
 /****************************************************************************/
 // These are the definitions for Service 4
 #if NUM_SERVICES > 4
-// the header file with the public function prototypes
-#define SERV_4_HEADER "TestHarnessService3.h"
-// the name of the Init function
-#define SERV_4_INIT InitTestHarnessService3
-// the name of the run function
-#define SERV_4_RUN RunTestHarnessService3
-// How big should this services Queue be?
-#define SERV_4_QUEUE_SIZE 3
+
+#define SERV_4_HEADER      "LEDService.h"
+#define SERV_4_INIT        InitLEDService
+#define SERV_4_RUN         RunLEDService
+#define SERV_4_CONTEXT     (&LEDServiceInstance)
+#define SERV_4_QUEUE_SIZE  5
+#define SERV_4_EVENT_MASK  (ES_EVENT_BIT(ES_INIT) | \
+                            ES_EVENT_BIT(ES_DIFFICULTY_CHANGED) | \
+                            ES_EVENT_BIT(ES_LED_SHOW_MESSAGE) | \
+                            ES_EVENT_BIT(ES_LED_SHOW_SCORE) | \
+                            ES_EVENT_BIT(ES_LED_SHOW_COUNTDOWN) | \
+                            ES_EVENT_BIT(ES_LED_SHOW_DIFFICULTY) | \
+                            ES_EVENT_BIT(ES_LED_PUSH_STEP))
+
 #endif
 
 /****************************************************************************/
@@ -274,7 +344,17 @@ typedef enum
     ES_LED_SHOW_SCORE,        // 16 EventParam: score (uint16_t)
     ES_LED_SHOW_COUNTDOWN,    // 17 EventParam: seconds (0?60)
     ES_LED_SHOW_DIFFICULTY,   // 18 EventParam: 0?100 %
-    ES_LED_PUSH_STEP          // 19 Internal LED row-push
+    ES_LED_PUSH_STEP,         // 19 Internal LED row-push
+
+    /* posted by timers, see ES_Timer_SetEvent */
+    ES_BALLOON_FRAME,         // 20 time to slew the balloon servos
+    ES_COUNTDOWN_TICK,        // 21 1 s game tick
+    ES_GAME_OVER,             // 22 60 s game time is up
+    ES_USER_INACTIVE,         // 23 20 s without a hit
+    ES_MODE_DONE,             // 24 3 s end of game display is over
+    ES_SHELL_RX,              // 25 the terminal has received characters
+
+    ES_NUM_EVENT_TYPES        // not an event, the count of them: keep last
 } ES_EventType_t;
 
 /****************************************************************************/
@@ -310,20 +390,27 @@ typedef enum
 /****************************************************************************/
 // This is the list of event checking functions
 #define EVENT_CHECK_LIST Check4Keystroke,Check4LaserHits, Check4HandWave, Check4Difficulty
+// Optional. The hardware source that has to signal a change before each of
+// the checkers above is called, in the same order. CHECK_SRC_ALWAYS runs it
+// on every pass. See ES_CheckSource_t in ES_Port.h. Comment out to call
+// every checker on every pass.
+#define EVENT_CHECK_SOURCES CHECK_SRC_UART_RX, CHECK_SRC_ADC, CHECK_SRC_CN_B, \
+                            CHECK_SRC_ADC
 //
 /****************************************************************************/
 // These are the definitions for the post functions to be executed when the
 // corresponding timer expires. All 16 must be defined. If you are not using
-// a timer, then you should use TIMER_UNUSED
+// a timer, then you should use TIMER_UNUSED. A timer that only runs a
+// callback (ES_Timer_SetCallback) doesn't post, so it is TIMER_UNUSED too.
 // Unlike services, any combination of timers may be used and there is no
 // priority in servicing them
 #define TIMER_UNUSED ((pPostFunc)0)
 #define TIMER0_RESP_FUNC PostGameSM   // 60s gameplay
 #define TIMER1_RESP_FUNC PostGameSM   // 20s inactivity
 #define TIMER2_RESP_FUNC PostGameSM   // 1s tick
-#define TIMER3_RESP_FUNC PostGameSM   // 3s mode end
+#define TIMER3_RESP_FUNC PostGameSM   // 3s mode end, posts ES_MODE_DONE
 #define TIMER4_RESP_FUNC PostMotorCtrl // balloon update tick
-#define TIMER5_RESP_FUNC PostMotorCtrl // gear servo dwell
+#define TIMER5_RESP_FUNC TIMER_UNUSED  // gear servo dwell, MotorCtrl callback
 #define TIMER6_RESP_FUNC TIMER_UNUSED 
 #define TIMER7_RESP_FUNC TIMER_UNUSED
 #define TIMER8_RESP_FUNC TIMER_UNUSED
@@ -352,4 +439,97 @@ typedef enum
 #define TID_GEAR_SERVO      5   // TIMER5
 #define SERVICE0_TIMER 15
 
+/****************************************************************************/
+// Interrupt post rings. An interrupt response that needs to post an event
+// does it through ES_PostFromISR into its own ring, without a critical
+// region. The rings are emptied into the service queues by
+// _HW_Process_Pending_Ints. Each ring may only be written by one interrupt.
+// Set to 0 if no interrupts post events.
+#define NUM_INT_POST_RINGS 2
+// How many events can each ring hold? Must be a power of 2, 128 at most
+#define INT_POST_RING_SIZE 8
+
+// Give the rings symbolic names, like the timers
+#define TEST_HARNESS_INT_RING 0   // Timer2 ISR in TestHarnessService0
+#define SHORT_TIMER_INT_RING 1    // Timer4 & 5 ISRs in ES_ShortTimer.c
+
+/****************************************************************************/
+// CPU load accounting. With ES_USE_CPU_LOAD defined, ES_Run charges the time
+// it spends in run functions, event checkers, UART output and idle polling
+// to separate buckets (see ES_CPULoad.h). Comment it out to remove the
+// accounting from the scheduler loop entirely.
+#define ES_USE_CPU_LOAD
+// If non-zero, a utilization line is printed every this many seconds
+#define CPU_LOAD_TELEMETRY_PERIOD 0
+
+/****************************************************************************/
+// Framework contexts. The framework's own state (ready flags, queues, timers,
+// tick counts, interrupt post rings and CPU load) lives in an ES_Context_t
+// (see ES_Context.h). Defining ES_MULTI_CONTEXT lets ES_SetContext switch
+// between several of them, one per thread, as the host test in
+// ES_Framework.c does. The game services are instances (SERV_n_CONTEXT), so
+// each context has its own game. The shell, the test harness service, the
+// event checkers, the difficulty mailbox and the state machine statistics
+// are plain modules that all contexts share. Leave it undefined on the PIC32.
+//#define ES_MULTI_CONTEXT
+
+/****************************************************************************/
+// Threaded executor (see ES_Executor.h). For host builds only (ES_HOST_PORT):
+// runs the services on NUM_WORKERS worker threads in place of the ES_Run
+// loop, while the thread that called ES_Run keeps the ticks, the event
+// checkers and the output. SERV_n_WORKER picks the worker for service n;
+// services without one run on worker 0. Services that call each other's
+// functions, like GameSM and MotorCtrl, must share a worker. LEDService is
+// only ever posted to, so it can have a worker of its own.
+// Only the ES_Run thread and the workers may post. Queue statistics are not
+// collected, and CPU load only covers the ES_Run thread.
+//#define ES_THREADED_EXECUTOR
+#define NUM_WORKERS 2
+// events each posting thread can have in flight to each service, power of 2
+#define EXEC_RING_SIZE 16
+#define SERV_4_WORKER 1
+
+/****************************************************************************/
+// Queue statistics. With ES_QUEUE_STATS defined, every post records how deep
+// the service's queue is afterward, and ES_QueueStats_PrintAdvice (key 's'
+// in TestHarnessService0) prints the smallest SERV_n_QUEUE_SIZE values that
+// would have lost no more than QUEUE_STATS_LOSS_PPM parts per million of the
+// posts seen. Exercise the application, then paste the printed lines above.
+// Not collected under ES_THREADED_EXECUTOR.
+// To size from several runs, or for another loss target, capture the
+// terminal output of each run and give the captures to
+// tools/queue_advisor.py.
+//#define ES_QUEUE_STATS
+#define QUEUE_STATS_LOSS_PPM 1000
+
+/****************************************************************************/
+// State machine statistics. With ES_SM_STATS defined, machines that call
+// ES_SMStats_Update (GameSM, and any ES_Hsm machine given statistics) count
+// entries, dwell times and transitions for each state. Key 't' in
+// TestHarnessService0 prints them.
+//#define ES_SM_STATS
+
+/****************************************************************************/
+// Timing wheel timers. With ES_USE_TIMER_WHEEL defined, services can also
+// allocate timers from a pool of TIMER_WHEEL_POOL_SIZE with
+// ES_TimerWheel_Alloc (see ES_TimerWheel.h), instead of using one of the 16
+// numbered timers above. The tick cost doesn't grow with the number running.
+//#define ES_USE_TIMER_WHEEL
+#define TIMER_WHEEL_POOL_SIZE 32
+
+/****************************************************************************/
+// Callback timers. A timer given a function with ES_Timer_SetCallback calls
+// it from the tick response instead of posting. Callbacks are timed, and any
+// that take longer than this many microseconds are counted (key 'k' in
+// TestHarnessService0 prints the statistics).
+#define TIMER_CALLBACK_MAX_US 20
+
+/****************************************************************************/
+// The command shell (ES_Shell.c). The longest line, including the command
+// name, is SHELL_LINE_SIZE - 1 characters, and words after the first
+// SHELL_MAX_ARGS are dropped. SHELL_MAX_COMMANDS includes the help command.
+#define SHELL_LINE_SIZE 64
+#define SHELL_MAX_ARGS 8
+#define SHELL_MAX_COMMANDS 16
+
 #endif /* ES_CONFIGURE_H */
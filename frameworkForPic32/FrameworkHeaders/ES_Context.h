@@ -0,0 +1,162 @@
+/****************************************************************************
+ Module
+     ES_Context.h
+ Description
+     The framework context holds all of the state of one copy of the
+     framework: the Ready flags, the service queues, the instance contexts,
+     the timers, the tick counts, the interrupt post rings and the CPU load
+     accounting.
+ Notes
+     Normally there is just the one context, ES_DefaultContext, and ES_CTX
+     is its (constant) address, so the framework code costs no more than it
+     did with the state in module variables.
+
+     With ES_MULTI_CONTEXT defined in ES_Configure.h, ES_CTX is instead a
+     pointer that is set with ES_SetContext before ES_Initialize and ES_Run
+     are called. The pointer is declared ES_THREAD_LOCAL (see ES_Port.h).
+
+     Plain services keep their state in module variables, so there is only
+     one copy of them however many contexts there are. Services that need a
+     copy per context must be multi-instance services (see ES_Framework.h);
+     a context given no instance of its own in pServiceContext[] before
+     ES_Initialize gets the one named by SERV_n_CONTEXT. The game services
+     (GameSM, MotorCtrl & LEDService) are written that way. A context must
+     start out zeroed. The TEST harness in ES_Framework.c runs two contexts
+     on separate threads at the same time.
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/18/26       karthi24     LastQueued note for the threaded executor
+ 10/18/26       karthi24     added the interrupt post rings & CPU load accounting
+ 10/18/26       karthi24     notes say what is not in a context
+ 10/18/26       karthi24     SysTickCounter widened, with SysTickHigh for 64 bits
+ 10/18/26       karthi24     added the timing wheel
+ 10/18/26       karthi24     added LastQueued
+ 10/18/26       karthi24     added FilterDrops
+ 10/18/26       karthi24     started coding
+*****************************************************************************/
+
+#ifndef ES_Context_H
+#define ES_Context_H
+
+#include "ES_Configure.h"
+#include "ES_Types.h"
+#include "ES_Port.h"
+#include "ES_Events.h"
+#include "ES_Timers.h"
+#include "ES_TimerWheel.h"
+#include "ES_CPULoad.h"
+
+#if NUM_INT_POST_RINGS > 0
+/* An interrupt post ring, see ES_PostFromISR in ES_Port.c. The ISR is the
+   only writer of Head and the main loop is the only writer of Tail.
+ */
+typedef struct
+{
+  ES_Event_t        Event;
+  uint8_t           WhichService;
+}ES_IntPostEntry_t;
+
+typedef struct
+{
+  ES_IntPostEntry_t Entries[INT_POST_RING_SIZE];
+  volatile uint8_t  Head;       // next slot the ISR will write
+  volatile uint8_t  Tail;       // next slot the main loop will read
+  volatile uint8_t  Overflows;  // posts lost because the ring was full
+}ES_IntPostRing_t;
+#endif
+
+typedef struct
+{
+  // which queues have events in them
+  uint16_t Ready;
+  // the service queues, 1 extra entry for the queue header
+  ES_Event_t Queue0[SERV_0_QUEUE_SIZE + 1];
+#if NUM_SERVICES > 1
+  ES_Event_t Queue1[SERV_1_QUEUE_SIZE + 1];
+#endif
+#if NUM_SERVICES > 2
+  ES_Event_t Queue2[SERV_2_QUEUE_SIZE + 1];
+#endif
+#if NUM_SERVICES > 3
+  ES_Event_t Queue3[SERV_3_QUEUE_SIZE + 1];
+#endif
+#if NUM_SERVICES > 4
+  ES_Event_t Queue4[SERV_4_QUEUE_SIZE + 1];
+#endif
+#if NUM_SERVICES > 5
+  ES_Event_t Queue5[SERV_5_QUEUE_SIZE + 1];
+#endif
+#if NUM_SERVICES > 6
+  ES_Event_t Queue6[SERV_6_QUEUE_SIZE + 1];
+#endif
+#if NUM_SERVICES > 7
+  ES_Event_t Queue7[SERV_7_QUEUE_SIZE + 1];
+#endif
+#if NUM_SERVICES > 8
+  ES_Event_t Queue8[SERV_8_QUEUE_SIZE + 1];
+#endif
+#if NUM_SERVICES > 9
+  ES_Event_t Queue9[SERV_9_QUEUE_SIZE + 1];
+#endif
+#if NUM_SERVICES > 10
+  ES_Event_t Queue10[SERV_10_QUEUE_SIZE + 1];
+#endif
+#if NUM_SERVICES > 11
+  ES_Event_t Queue11[SERV_11_QUEUE_SIZE + 1];
+#endif
+#if NUM_SERVICES > 12
+  ES_Event_t Queue12[SERV_12_QUEUE_SIZE + 1];
+#endif
+#if NUM_SERVICES > 13
+  ES_Event_t Queue13[SERV_13_QUEUE_SIZE + 1];
+#endif
+#if NUM_SERVICES > 14
+  ES_Event_t Queue14[SERV_14_QUEUE_SIZE + 1];
+#endif
+#if NUM_SERVICES > 15
+  ES_Event_t Queue15[SERV_15_QUEUE_SIZE + 1];
+#endif
+  // context passed to each multi-instance service, NULL entries are filled
+  // in from SERV_n_CONTEXT by ES_Initialize
+  void *pServiceContext[NUM_SERVICES];
+  // posts dropped because the service doesn't accept that event type
+  uint16_t FilterDrops[NUM_SERVICES];
+  // the service that the last ES_PostToService queued an event for. The
+  // periodic timers set it to ES_NO_SERVICE before they post, to find out
+  // whether their timeout was queued or filtered out. Under
+  // ES_THREADED_EXECUTOR only the ES_Run thread's posts set it.
+  uint8_t LastQueued;
+  // the framework timers
+  ES_TimerState_t Timers;
+#ifdef ES_USE_TIMER_WHEEL
+  // the timing wheel timers
+  ES_TimerWheelState_t Wheel;
+#endif
+  // ticks that have happened but not yet been run through the timers
+  volatile uint8_t TickCount;
+  // ticks since start up, for ES_Timer_GetTime. SysTickHigh holds bits 31
+  // and up of the 64 bit count (see _HW_GetTickCount64).
+  volatile uint32_t SysTickCounter;
+  volatile uint32_t SysTickHigh;
+#if NUM_INT_POST_RINGS > 0
+  // events posted by interrupts, waiting for _HW_Process_Pending_Ints
+  ES_IntPostRing_t IntPostRings[NUM_INT_POST_RINGS];
+#endif
+#ifdef ES_USE_CPU_LOAD
+  // where ES_Run has spent its time
+  ES_CPULoadState_t CPULoad;
+#endif
+}ES_Context_t;
+
+extern ES_Context_t ES_DefaultContext;
+
+#ifdef ES_MULTI_CONTEXT
+extern ES_THREAD_LOCAL ES_Context_t *ES_pCurrentContext;
+#define ES_CTX ES_pCurrentContext
+void ES_SetContext(ES_Context_t *pNewContext);
+#else
+#define ES_CTX (&ES_DefaultContext)
+#endif
+
+#endif /* ES_Context_H */
@@ -26,7 +26,7 @@
 
 /****************************************************************************
  Function
-   ES_DeferEvent  (wrapper for ES_EnQueueLIFO)
+   ES_DeferEvent  (wrapper for ES_EnQueueFIFO)
    this is a straight re-naming to aid readability
  Parameters
    ES_Event * pBlock : pointer to the block of memory in use as the Queue
@@ -35,8 +35,11 @@
    bool : true if the add was successful, false if not
  Description
    if it will fit, adds Event2Add to the Queue
+ Notes
+   deferred events are kept oldest first, so that ES_RecallEvents can move
+   them all in one step
  ***************************************************************************/
-#define ES_DeferEvent(a, b) ES_EnQueueLIFO(a, b)
+#define ES_DeferEvent(a, b) ES_EnQueueFIFO(a, b)
 
 /****************************************************************************
  Function
@@ -46,13 +49,13 @@
       ES_Event * pBlock, pointer to the block of memory that implements the
         Defer/Recall queue
  Returns
-     bool true if an event was recalled, false if no event was left in queue
+     bool true if events were recalled, false if the deferral queue was
+     empty or the service's queue did not have room for all of them
  Description
-     pulls an event off the deferral queue if one is available. It there was
-     something in the queue, then it posts it LIFO fashion to the queue
-     indicated by WhichService
+     moves all of the events on the deferral queue to the front of the queue
+     indicated by WhichService, in the order that they were deferred
  Notes
-     None.
+     all or nothing: if they don't all fit, they all stay deferred
  Author
      J. Edward Carryer, 11/20/13 16:49
 ****************************************************************************/
@@ -0,0 +1,77 @@
+/****************************************************************************
+ Module
+     ES_EventTable.h
+ Description
+     macros for dispatching events through const tables of handler
+     functions, in place of nested switch statements
+ Notes
+     A flat state machine keeps a table with one row per state and one
+     column per event type. Dispatch is one indexed call:
+
+       ES_TABLE_BEGIN
+       static ES_EventHandler_t const Table[NUM_STATES][ES_NUM_EVENT_TYPES] =
+       {
+         ES_TABLE_DEFAULTS(NUM_STATES),
+         [STATE_ONE] = { ES_ROW_DEFAULTS,
+           [ES_TIMEOUT] = StateOne_Timeout,
+           [ES_NEW_KEY] = StateOne_Key },
+         ...
+       };
+       ES_TABLE_END
+       ...
+       return ES_DISPATCH_TABLE(Table, CurrentState, ThisEvent);
+
+     A service with no states keeps a single row and uses ES_DISPATCH_ROW.
+
+     The defaults use the GNU range designator, which XC32 supports. They
+     fill every cell with ES_NoHandler, and the cells named after them
+     override it, so any (state, event) pair without a handler goes to
+     ES_NoHandler without a run time test. Every row must start with
+     ES_ROW_DEFAULTS (or ES_ROW_FILL), since naming a row replaces the
+     table default for it.
+
+     Overriding a default is what GCC's -Woverride-init (part of -Wextra)
+     warns about, so tables are wrapped in ES_TABLE_BEGIN & ES_TABLE_END,
+     which turn that one warning off for the table alone.
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/18/26       karthi24     added ES_TABLE_BEGIN & ES_TABLE_END for -Woverride-init
+ 10/18/26       karthi24     started coding
+*****************************************************************************/
+
+#ifndef ES_EventTable_H
+#define ES_EventTable_H
+
+#include "ES_Types.h"
+#include "ES_Events.h"
+
+typedef ES_Event_t (*ES_EventHandler_t)(ES_Event_t ThisEvent);
+
+// what a handler returns when all went well
+#define ES_EVENT_HANDLED ((ES_Event_t){ ES_NO_EVENT, 0 })
+
+// the shared handler for events that a state has no use for
+ES_Event_t ES_NoHandler(ES_Event_t ThisEvent);
+
+// fill a row with one handler, before naming the cells that differ
+#define ES_ROW_FILL(Handler) [0 ... ES_NUM_EVENT_TYPES - 1] = (Handler)
+#define ES_ROW_DEFAULTS ES_ROW_FILL(ES_NoHandler)
+// fill every row of a table, for states that are not given rows
+#define ES_TABLE_DEFAULTS(NumStates) \
+  [0 ... (NumStates) - 1] = { ES_ROW_DEFAULTS }
+
+// around each table, the overrides of the defaults are intended
+#define ES_TABLE_BEGIN \
+  _Pragma("GCC diagnostic push") \
+  _Pragma("GCC diagnostic ignored \"-Woverride-init\"")
+#define ES_TABLE_END _Pragma("GCC diagnostic pop")
+
+#define ES_DISPATCH_ROW(Row, Event) \
+  (((Event).EventType < ES_NUM_EVENT_TYPES) ? \
+    (Row)[(Event).EventType](Event) : ES_NoHandler(Event))
+
+#define ES_DISPATCH_TABLE(Table, State, Event) \
+  ES_DISPATCH_ROW((Table)[State], Event)
+
+#endif /* ES_EventTable_H */
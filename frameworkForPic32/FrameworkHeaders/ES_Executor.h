@@ -0,0 +1,56 @@
+/****************************************************************************
+ Module
+     ES_Executor.h
+ Description
+     header file for the threaded executor, an alternative to the single
+     threaded loop in ES_Run for host builds
+ Notes
+     Selected by defining ES_THREADED_EXECUTOR in ES_Configure.h. Each
+     service is assigned to one of NUM_WORKERS worker threads by
+     SERV_n_WORKER, so a service's run function never runs on two threads
+     and still runs each event to completion. Events posted between threads
+     travel over single producer/single consumer rings, one for each pair of
+     posting thread and receiving service, so the events from any one thread
+     arrive in the order that they were posted.
+
+     The port must supply the thread functions declared below, and the
+     _HW_LoadAcquire & _HW_StoreRelease that pass the ring indices between
+     threads. ES_HostPort.c does, the PIC32 port has no threads.
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/18/26       karthi24     started coding
+*****************************************************************************/
+
+#ifndef ES_Executor_H
+#define ES_Executor_H
+
+#include "ES_Types.h"
+#include "ES_Events.h"
+#include "ES_Framework.h"
+
+// cost of posting between threads, as seen by one posting thread
+typedef struct
+{
+  uint32_t Posts;       // events put into a ring
+  uint32_t Rejects;     // posts that failed because the ring was full
+  uint32_t PostTicks;   // core counts spent in the successful posts
+}ES_ExecutorStats_t;
+
+typedef void WorkerFunc_t (uint8_t WhichWorker);
+
+ES_Return_t ES_Executor_Run(void);
+bool ES_Executor_Post(uint8_t WhichService, ES_Event_t TheEvent, bool ToFront);
+bool ES_Executor_Splice(uint8_t WhichService, ES_Event_t *pBlock);
+bool ES_Executor_GetPostStats(uint8_t WhichThread, ES_ExecutorStats_t *pStats);
+
+// used by the executor to get at the framework's queues and services
+ES_Event_t *ES_GetQueueMem(uint8_t WhichService);
+ES_Event_t ES_DispatchEvent(uint8_t WhichService, ES_Event_t ThisEvent);
+
+// supplied by the port. _HW_WorkerIdle is called by any of the threads when
+// it found nothing to do, so that it can yield or sleep.
+bool _HW_StartWorker(WorkerFunc_t *pWorker, uint8_t WhichWorker);
+void _HW_WorkerIdle(void);
+
+#endif /* ES_Executor_H */
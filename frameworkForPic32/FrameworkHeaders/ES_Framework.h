@@ -8,6 +8,12 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/18/26       karthi24 added ES_GetServiceContext
+ 10/18/26       karthi24 added ES_CountQueued & ES_NO_SERVICE
+ 10/18/26       karthi24 added ES_EVENT_BIT and ES_GetFilterDrops
+ 10/18/26       karthi24 added ES_SpliceToService prototype
+ 10/18/26       karthi24 added types for multi-instance services
+ 10/18/26       karthi24 added ES_PostFromISR prototype
  11/02/13 17:06 jec      added ES_PostToServiceLIFO prototype
  08/05/13 15:00 jec      added #include for ES_Port.h to get portability stuff
  10/17/06 07:41 jec      started coding
@@ -40,10 +46,38 @@ typedef enum
   FailedOther
 }ES_Return_t;
 
+// Multi-instance services: one implementation can be registered as several
+// services by defining SERV_n_CONTEXT for each of them in ES_Configure.h.
+// The init & run functions then take the context of the instance as their
+// first parameter. Every context must start with an ES_Instance_t.
+typedef struct
+{
+  uint8_t Priority;   // filled in by ES_Initialize before the init function
+}ES_Instance_t;
+
+typedef bool InstInitFunc_t (void *pContext, uint8_t Priority);
+typedef ES_Event_t InstRunFunc_t (void *pContext, ES_Event_t ThisEvent);
+
+// used to build the SERV_n_EVENT_MASK accepted event masks
+#define ES_EVENT_BIT(EventType) ((uint32_t)1 << (EventType))
+#define ES_ALL_EVENTS 0xFFFFFFFF
+
+// a service number that no service has
+#define ES_NO_SERVICE 0xFF
+
 ES_Return_t ES_Initialize(TimerRate_t NewRate);
 ES_Return_t ES_Run(void);
 bool ES_PostAll(ES_Event_t ThisEvent);
 bool ES_PostToService(uint8_t WhichService, ES_Event_t ThisEvent);
 bool ES_PostToServiceLIFO(uint8_t WhichService, ES_Event_t TheEvent);
+bool ES_PostToInstance(void *pContext, ES_Event_t TheEvent);
+void *ES_GetServiceContext(uint8_t WhichService);
+bool ES_SpliceToService(uint8_t WhichService, ES_Event_t *pBlock);
+uint16_t ES_GetFilterDrops(uint8_t WhichService);
+uint8_t ES_CountQueued(uint8_t WhichService, ES_Event_t ThisEvent);
+// defined in ES_Port.c, since the rings are emptied by the port layer
+bool ES_PostFromISR(uint8_t WhichRing, uint8_t WhichService,
+    ES_Event_t ThisEvent);
+uint8_t ES_GetIntPostOverflows(uint8_t WhichRing);
 
 #endif   // ES_Framework_H
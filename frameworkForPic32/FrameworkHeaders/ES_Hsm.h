@@ -0,0 +1,109 @@
+/****************************************************************************
+ Module
+     ES_Hsm.h
+ Description
+     header file for the table driven hierarchical state machine engine
+ Notes
+     A machine is described by two const tables. The state table gives each
+     state's parent, initial child, history flag, entry & exit functions and
+     the block of rows it owns in the transition table. The transition table
+     gives, for each row, the event type, an optional guard, an optional
+     action and the target state.
+
+     The rows for each state must be contiguous in the transition table, e.g.:
+
+       static const ES_HsmStateDesc_t States[] = {
+       //  Parent          Initial         History  Entry    Exit  First Num
+         { ES_HSM_NO_STATE, IDLE,           false,   NULL,    NULL,    0, 1 },
+         { TOP,             ES_HSM_NO_STATE, false, IdleIn,   NULL,    1, 1 },
+         ...
+       };
+       static const ES_HsmTransition_t Transitions[] = {
+       //  Event      Guard    Action   Target
+         { ES_RESET,  NULL,    NULL,    TOP },   // TOP's row
+         { ES_GO,     CanGo,   LogGo,   RUN },   // IDLE's row
+         ...
+       };
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/18/26       karthi24     added optional state statistics
+ 10/18/26       karthi24     started coding
+*****************************************************************************/
+
+#ifndef ES_Hsm_H
+#define ES_Hsm_H
+
+#include "ES_Types.h"
+#include "ES_Events.h"
+#include "ES_SMStats.h"
+
+// deepest nesting allowed, counting a top level state as depth 1
+#define ES_HSM_MAX_DEPTH 8
+
+typedef uint8_t ES_HsmState_t;
+
+// no state: the parent of a top level state, or a leaf's initial child
+#define ES_HSM_NO_STATE 0xFF
+// a transition target that runs the action without leaving the state
+#define ES_HSM_INTERNAL 0xFE
+
+typedef void (*ES_HsmEntryExit_t)(void *pContext);
+typedef bool (*ES_HsmGuard_t)(void *pContext, ES_Event_t Event);
+typedef void (*ES_HsmAction_t)(void *pContext, ES_Event_t Event);
+
+typedef struct
+{
+  ES_HsmState_t     Parent;     // ES_HSM_NO_STATE for a top level state
+  ES_HsmState_t     Initial;    // child entered by default, or ES_HSM_NO_STATE
+  bool              History;    // re-enter the child that was last active
+  ES_HsmEntryExit_t Entry;      // may be NULL
+  ES_HsmEntryExit_t Exit;       // may be NULL
+  uint8_t           FirstTrans; // this state's first row in the transitions
+  uint8_t           NumTrans;   // and how many rows it has
+}ES_HsmStateDesc_t;
+
+typedef struct
+{
+  ES_EventType_t    EventType;
+  ES_HsmGuard_t     Guard;      // may be NULL, the row is taken if it's true
+  ES_HsmAction_t    Action;     // may be NULL
+  ES_HsmState_t     Target;     // a state, or ES_HSM_INTERNAL
+}ES_HsmTransition_t;
+
+typedef struct
+{
+  const ES_HsmStateDesc_t   *pStates;
+  uint8_t                   NumStates;
+  const ES_HsmTransition_t  *pTransitions;
+  uint8_t                   NumTransitions;
+  ES_HsmState_t             Initial;    // top level state entered by Start
+}ES_HsmDef_t;
+
+// one running machine. The two arrays are supplied by the user, History
+// with NumStates entries and Lca with NumTransitions entries.
+typedef struct
+{
+  const ES_HsmDef_t *pDef;
+  void              *pContext;  // passed to every entry, exit, guard & action
+  ES_HsmState_t     Current;    // the active leaf state
+  ES_HsmState_t     *pHistory;  // last active child of each state
+  ES_HsmState_t     *pLca;      // where each transition's exits stop
+#ifdef ES_SM_STATS
+  ES_SMStats_t      *pStats;    // leaf state statistics, or NULL
+#endif
+}ES_Hsm_t;
+
+bool ES_Hsm_Init(ES_Hsm_t *pHsm, const ES_HsmDef_t *pDef, void *pContext,
+    ES_HsmState_t *pHistory, ES_HsmState_t *pLca);
+void ES_Hsm_Start(ES_Hsm_t *pHsm);
+bool ES_Hsm_Dispatch(ES_Hsm_t *pHsm, ES_Event_t Event);
+ES_HsmState_t ES_Hsm_GetState(ES_Hsm_t *pHsm);
+bool ES_Hsm_IsIn(ES_Hsm_t *pHsm, ES_HsmState_t State);
+#ifdef ES_SM_STATS
+void ES_Hsm_SetStats(ES_Hsm_t *pHsm, ES_SMStats_t *pStats,
+    const char *pName, const char * const *pStateNames);
+#endif
+
+#endif /* ES_Hsm_H */
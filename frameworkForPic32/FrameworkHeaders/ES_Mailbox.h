@@ -0,0 +1,43 @@
+/****************************************************************************
+ Module
+     ES_Mailbox.h
+ Description
+     header file for the latest-value mailboxes of the Events & Services
+     framework
+ Notes
+     A mailbox holds one value that is overwritten by every write. Readers
+     always get the latest value, and a version number that changes with it,
+     without going through an event queue.
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/18/26       karthi24     started coding
+*****************************************************************************/
+
+#ifndef ES_Mailbox_H
+#define ES_Mailbox_H
+
+#include "ES_Types.h"
+#include "ES_Events.h"
+
+typedef struct
+{
+  uint16_t        Value;        // the latest value written
+  uint16_t        Version;      // bumped each time Value changes
+  ES_EventType_t  NotifyEvent;  // posted to subscribers, ES_NO_EVENT for none
+  uint16_t        Subscribers;  // bit n set: service n wants NotifyEvent
+  uint16_t        Pending;      // bit n set: service n has not taken it yet
+}ES_Mailbox_t;
+
+// for a mailbox defined at file scope, in place of ES_Mailbox_Init
+#define ES_MAILBOX_INITIALIZER(InitialValue, NotifyEvent) \
+  { (InitialValue), 0, (NotifyEvent), 0, 0 }
+
+void ES_Mailbox_Init(ES_Mailbox_t *pBox, uint16_t InitialValue,
+    ES_EventType_t NotifyEvent);
+void ES_Mailbox_Subscribe(ES_Mailbox_t *pBox, uint8_t WhichService);
+bool ES_Mailbox_Write(ES_Mailbox_t *pBox, uint16_t NewValue);
+uint16_t ES_Mailbox_Read(ES_Mailbox_t *pBox, uint16_t *pVersion);
+uint16_t ES_Mailbox_Take(ES_Mailbox_t *pBox, uint8_t WhichService);
+
+#endif /* ES_Mailbox_H */
@@ -9,6 +9,17 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/18/26       karthi24     added ES_HOST_PORT for host builds, see ES_HostPort.c
+ 10/18/26       karthi24     ES_THREAD_LOCAL can be given on the command line
+ 10/18/26       karthi24     critical region stats are now off by default
+ 10/18/26       karthi24     added tick interrupt statistics, ES_TickStats_t
+ 10/18/26       karthi24     added 64 bit core & tick counts
+ 10/18/26       karthi24     added event checker gating sources
+ 10/18/26       karthi24     added ES_THREAD_LOCAL for framework contexts
+ 10/18/26       karthi24     critical regions now raise IPL to a ceiling and nest,
+                             with stats on the longest region
+ 10/18/26       karthi24     added _HW_MemoryBarrier for the interrupt post rings
+ 10/18/26       karthi24     added _HW_GetCoreCount for CPU load accounting
  10/26/17 18:39 jec     moves definition of ALL_BITS to here
  10/14/15 21:50 jec     added prototype for ES_Timer_GetTime
  01/18/15 13:24 jec     clean up and adapt to use TI driver lib functions
@@ -22,8 +33,15 @@
 #ifndef ES_PORT_H
 #define ES_PORT_H
 
+// A host build (ES_HOST_PORT defined on the command line) swaps the PIC32
+// hardware for ES_HostPort.c, which runs on POSIX threads and the host's
+// monotonic clock. It is for running the framework, and the threaded
+// executor in particular, on a PC.
+#ifndef ES_HOST_PORT
 // pull in the hardware header files that we need
 #include <xc.h>
+#include <cp0defs.h>        // for the core timer access macros
+#endif
 
 #include <stdio.h>
 #include <stdint.h>
@@ -71,18 +89,59 @@ extern  uint8_t _INTCON_temp;
 
 // in the MIPS architecture, interrupts are not disabled on entry to an ISR
 // the interrupt controller simply prevents interrupts from lower or the
-// same priority. As a result, we can create a critical region by simply
-// disabling interrupts. 
-// NOTE: This means that critical regions can not be nested
-// I don't think that this should be a serious limitation for the framework
+// same priority. As a result, we can create a critical region by raising the
+// CPU priority (IPL) to the highest priority of any interrupt that touches
+// framework data, rather than disabling all interrupts. Interrupts above that
+// ceiling are never held off by the framework.
+// The first EnterCritical saves the CPU status and the matching outermost
+// ExitCritical restores it, so critical regions can be nested.
+// NOTE: interrupts with a priority above ES_CRITICAL_IPL must not call any
+// framework functions, post events or use EnterCritical/ExitCritical
+#define ES_CRITICAL_IPL 3
+
+// with this defined, the length of the longest critical region is recorded
+// (see _HW_GetMaxCriticalTicks). It adds two core timer reads to every
+// outermost critical region, so leave it off except in measurement builds.
+//#define CRITICAL_REGION_STATS
+
 #ifdef POST_FROM_INTS
-#define EnterCritical()__builtin_disable_interrupts()
-#define ExitCritical() __builtin_enable_interrupts()
+#define EnterCritical() _HW_EnterCritical()
+#define ExitCritical()  _HW_ExitCritical()
 #else
 #define EnterCritical()
 #define ExitCritical()
 #endif
 
+#ifndef ES_HOST_PORT
+// The M4K core is single issue and in-order, so the only re-ordering that we
+// need to worry about between an ISR and the main loop comes from the
+// compiler. This keeps the compiler from moving memory accesses across it.
+#define _HW_MemoryBarrier() __asm__ __volatile__("" ::: "memory")
+#else
+// a host has several cores, each of which may re-order memory accesses
+#define _HW_MemoryBarrier() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+// The threaded executor's rings hand their indices from one thread to
+// another with these. The entries written before a release store are seen
+// by the thread that acquire loads the new index.
+#define _HW_LoadAcquire(pIndex) __atomic_load_n((pIndex), __ATOMIC_ACQUIRE)
+#define _HW_StoreRelease(pIndex, Value) \
+  __atomic_store_n((pIndex), (Value), __ATOMIC_RELEASE)
+#endif
+
+// storage class for the pointer to the current framework context (see
+// ES_Context.h). A port that runs several contexts on separate threads makes
+// this its compiler's thread local storage class. The PIC32 has one thread,
+// a host build of the TEST harnesses may pass -DES_THREAD_LOCAL=__thread.
+// The host port has threads, so it always needs it.
+#ifndef ES_THREAD_LOCAL
+#ifdef ES_HOST_PORT
+#define ES_THREAD_LOCAL __thread
+#else
+#define ES_THREAD_LOCAL
+#endif
+#endif
+
 /* Rate constants for programming the SysTick Period to generate tick interrupts.
    These assume that we are using the M4K core timer running at 20MHz. Even
    thought the processor clock is 40MHz the core timer increments every other 
@@ -98,6 +157,34 @@ typedef enum
   ES_Timer_RATE_5mS  = 100000,       /* 5ms timer tick */
 }TimerRate_t;
 
+/* The core timer is also used as a free running counter for measuring how
+   long things take (CPU load accounting, etc.). It counts at 20MHz, so it
+   wraps every 214 seconds. Take differences as uint32_t to handle the wrap.
+   _HW_GetCoreCount64 extends it so that it never wraps.
+   The host port counts at the same rate, from its monotonic clock.
+ */
+#define CORE_TICKS_PER_SEC 20000000UL
+#define CORE_TICKS_PER_US (CORE_TICKS_PER_SEC / 1000000UL)
+#ifndef ES_HOST_PORT
+#define _HW_GetCoreCount() _CP0_GET_COUNT()
+#else
+#define _HW_GetCoreCount() ((uint32_t)_HW_GetCoreCount64())
+#endif
+
+/* Hardware "something changed" flags that can gate event checkers, see
+   EVENT_CHECK_SOURCES in ES_Configure.h. These are the interrupt flags of the
+   sources, which the hardware sets whether or not the interrupt is enabled.
+   The change notice sources need CNCONx.ON and the CNENx bits for the pins.
+ */
+typedef enum
+{
+  CHECK_SRC_ALWAYS = 0, // not gated, the checker runs on every pass
+  CHECK_SRC_CN_A,       // change notice on port A
+  CHECK_SRC_CN_B,       // change notice on port B
+  CHECK_SRC_ADC,        // the ADC finished a scan
+  CHECK_SRC_UART_RX     // a character arrived on UART1
+}ES_CheckSource_t;
+
 #if 0 // Moved to terminal.h
 // map the generic functions for testing the serial port to actual functions
 // for this platform. If the C compiler does not provide functions to test
@@ -112,11 +199,36 @@ void putch(char data);
 bool kbhit(void);                // is a charcter ready on the EUSART?
 #endif
 
+// how well the tick interrupt is keeping up, see _HW_GetTickStats
+typedef struct
+{
+  // ticks that went by while the interrupt was held off, and were counted
+  // late by a following interrupt
+  uint32_t MissedTicks;
+  // the interrupts that had to count missed ticks
+  uint32_t LateInts;
+  // longest from the compare match to the interrupt reading the core timer,
+  // in core timer counts (CORE_TICKS_PER_US per us)
+  uint32_t MaxLatency;
+  // most ticks waiting for _HW_Process_Pending_Ints at once, 1 is normal
+  uint8_t  MaxBacklog;
+}ES_TickStats_t;
+
 // prototypes for the hardware specific routines
 void _HW_PIC32Init(void);
+void _HW_EnterCritical(void);
+void _HW_ExitCritical(void);
+uint32_t _HW_GetMaxCriticalTicks(void);
+uint32_t _HW_GetMaxCriticalCaller(void);
+void _HW_ResetCriticalStats(void);
 void _HW_Timer_Init(const TimerRate_t Rate);
 bool _HW_Process_Pending_Ints(void);
 uint16_t _HW_GetTickCount(void);
+uint64_t _HW_GetTickCount64(void);
+uint64_t _HW_GetCoreCount64(void);
+void _HW_GetTickStats(ES_TickStats_t *pStats);
+void _HW_ResetTickStats(void);
+uint8_t _HW_TakeDirtySources(void);
 void _HW_ConsoleInit(void);
 void _HW_SysTickIntHandler(void);
 
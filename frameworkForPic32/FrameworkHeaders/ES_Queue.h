@@ -9,6 +9,9 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/18/26       karthi24 added ES_CountMatches prototype
+ 10/18/26       karthi24 added ES_GetNumEntries prototype
+ 10/18/26       karthi24 added ES_SpliceQueueFront prototype
  08/05/13 15:19 jec      modifications to suit new portable type definitions
  01/15/12 09:36 jec      converted to use new types from ES_Types.h
  10/17/11 07:49 jec      new header to match the rest of the framework
@@ -28,6 +31,9 @@ bool ES_EnQueueLIFO(ES_Event_t *pBlock, ES_Event_t Event2Add);
 uint8_t ES_DeQueue(ES_Event_t *pBlock, ES_Event_t *pReturnEvent);
 //void EF_FlushQueue( unsigned char * pBlock );
 bool ES_IsQueueEmpty(ES_Event_t *pBlock);
+uint8_t ES_GetNumEntries(ES_Event_t *pBlock);
+bool ES_SpliceQueueFront(ES_Event_t *pDest, ES_Event_t *pSrc);
+uint8_t ES_CountMatches(ES_Event_t *pBlock, ES_Event_t Event2Match);
 
 #endif /*ES_Queue_H */
 
@@ -0,0 +1,27 @@
+/****************************************************************************
+ Module
+     ES_QueueStats.h
+ Description
+     header file for the queue occupancy statistics and the queue size
+     advisor
+ Notes
+     Only compiled in when ES_QUEUE_STATS is defined in ES_Configure.h
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/18/26       karthi24     started coding
+*****************************************************************************/
+
+#ifndef ES_QueueStats_H
+#define ES_QueueStats_H
+
+#include "ES_Types.h"
+
+void ES_QueueStats_RecordPost(uint8_t WhichService, uint8_t Depth);
+void ES_QueueStats_Reset(void);
+uint8_t ES_QueueStats_GetPeak(uint8_t WhichService);
+uint8_t ES_QueueStats_GetPercentile(uint8_t WhichService, uint16_t PerThousand);
+uint8_t ES_QueueStats_Recommend(uint8_t WhichService);
+void ES_QueueStats_PrintAdvice(void);
+
+#endif /* ES_QueueStats_H */
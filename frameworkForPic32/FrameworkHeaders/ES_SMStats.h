@@ -0,0 +1,55 @@
+/****************************************************************************
+ Module
+     ES_SMStats.h
+ Description
+     header file for the state machine statistics: entries, dwell times and
+     transition counts for each state
+ Notes
+     Only compiled in when ES_SM_STATS is defined in ES_Configure.h. A state
+     machine defines its statistics with ES_SM_STATS_DEFINE, calls
+     ES_SMStats_Init from its init function and ES_SMStats_Update with its
+     current state after every event that it processes.
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/18/26       karthi24     started coding
+*****************************************************************************/
+
+#ifndef ES_SMStats_H
+#define ES_SMStats_H
+
+#include "ES_Types.h"
+
+typedef struct
+{
+  uint32_t  Entries;
+  uint32_t  TotalDwell;   // ms, over all completed visits
+  uint32_t  MaxDwell;     // ms, longest completed visit
+}ES_SMStateStats_t;
+
+typedef struct ES_SMStats
+{
+  uint8_t                 NumStates;
+  ES_SMStateStats_t       *pStates;       // NumStates entries
+  uint16_t                *pTransitions;  // [from * NumStates + to]
+  const char              *pName;
+  const char * const      *pStateNames;   // may be NULL to print numbers
+  uint8_t                 Current;
+  uint16_t                LastSample;     // ES_Timer_GetTime at last update
+  uint32_t                Dwell;          // ms in Current so far
+  struct ES_SMStats       *pNext;         // the next machine to report on
+}ES_SMStats_t;
+
+// defines the statistics, and the arrays behind them, for a machine
+#define ES_SM_STATS_DEFINE(Name, NumStates) \
+  static ES_SMStateStats_t Name##_States[NumStates]; \
+  static uint16_t Name##_Transitions[(NumStates) * (NumStates)]; \
+  static ES_SMStats_t Name = { (NumStates), Name##_States, Name##_Transitions }
+
+void ES_SMStats_Init(ES_SMStats_t *pStats, const char *pName,
+    const char * const *pStateNames, uint8_t InitialState);
+void ES_SMStats_Update(ES_SMStats_t *pStats, uint8_t State);
+void ES_SMStats_Print(ES_SMStats_t *pStats);
+void ES_SMStats_PrintAll(void);
+
+#endif /* ES_SMStats_H */
@@ -0,0 +1,45 @@
+/****************************************************************************
+ Module
+     ES_Shell.h
+ Description
+     header file for the line oriented command shell service
+ Notes
+     A module registers its commands, normally from its init function:
+
+       static void BlinkCmd(uint8_t argc, char *argv[]);
+       static const ES_ShellCommand_t BlinkCommand =
+           { "blink", "blink <ms>, blink the LED", BlinkCmd };
+       ...
+       ES_Shell_AddCommand(&BlinkCommand);
+
+     The command is called with the words of the line, argv[0] being the
+     command name. The command structure is kept by pointer, so it must not
+     be on the stack.
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/18/26       karthi24     started coding
+*****************************************************************************/
+
+#ifndef ES_Shell_H
+#define ES_Shell_H
+
+#include "ES_Types.h"
+#include "ES_Events.h"
+
+typedef void (*ES_ShellFunc_t)(uint8_t argc, char *argv[]);
+
+typedef struct
+{
+  const char     *Name;   // the first word of the line
+  const char     *Help;   // one line, for the help command
+  ES_ShellFunc_t Func;
+}ES_ShellCommand_t;
+
+bool ES_Shell_AddCommand(const ES_ShellCommand_t *pCommand);
+
+bool InitShellService(uint8_t Priority);
+bool PostShellService(ES_Event_t ThisEvent);
+ES_Event_t RunShellService(ES_Event_t ThisEvent);
+
+#endif /* ES_Shell_H */
@@ -0,0 +1,35 @@
+/****************************************************************************
+ Module
+     ES_ShortTimer.h
+ Description
+     header file for the short (microsecond) timers
+ Notes
+     There are two channels, on Timer4 & Timer5. Each one is a one shot that
+     posts ES_SHORT_TIMEOUT, with the channel as the EventParam, to the
+     service given for it in ES_ShortTimerInit.
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/18/26       karthi24     started coding, for the PIC32 port
+*****************************************************************************/
+
+#ifndef ES_ShortTimer_H
+#define ES_ShortTimer_H
+
+#include "ES_Types.h"
+
+// give this as the service for a channel that isn't used
+#define SHORT_TIMER_UNUSED 0xFF
+
+#define SHORT_TIMER_A 0   // Timer4
+#define SHORT_TIMER_B 1   // Timer5
+#define SHORT_TIMER_NUM_CHANNELS 2
+
+// the channel names used by the TivaWare version
+#define TIMER_A SHORT_TIMER_A
+#define TIMER_B SHORT_TIMER_B
+
+void ES_ShortTimerInit(uint8_t TimeAPrio, uint8_t TimeBPrio);
+void ES_ShortTimerStart(uint32_t Which, uint16_t TimeoutValue);
+
+#endif /* ES_ShortTimer_H */
@@ -0,0 +1,94 @@
+/****************************************************************************
+ Module
+     ES_TimerWheel.h
+ Description
+     header file for the timing wheel timers
+ Notes
+     These timers are in addition to the 16 numbered timers in ES_Timers.c.
+     A service allocates a handle from a static pool, normally in its init
+     function, and starts & stops it like a numbered timer:
+
+       static ES_TimerHandle_t BlinkTimer;
+       ...
+       BlinkTimer = ES_TimerWheel_Alloc(PostBlinkService);
+       ES_TimerWheel_Start(BlinkTimer, 250);
+       ...
+       if ((ThisEvent.EventType == ES_TIMEOUT) &&
+           (ThisEvent.EventParam == BlinkTimer))
+
+     The handles start at ES_NUM_TIMERS, so the EventParam of an ES_TIMEOUT
+     tells a wheel timer apart from any of the numbered timers.
+
+     The wheel is only compiled in when ES_USE_TIMER_WHEEL is defined in
+     ES_Configure.h, TIMER_WHEEL_POOL_SIZE there sets how many handles exist.
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/18/26       karthi24     started coding
+*****************************************************************************/
+
+#ifndef ES_TimerWheel_H
+#define ES_TimerWheel_H
+
+#include "ES_Configure.h"
+#include "ES_Types.h"
+#include "ES_PostList.h"
+#include "ES_Timers.h"
+
+typedef uint8_t ES_TimerHandle_t;
+
+// returned by ES_TimerWheel_Alloc when the pool is empty
+#define ES_TIMER_NO_HANDLE 0xFF
+
+// the wheel has ES_WHEEL_LEVELS levels of ES_WHEEL_SLOTS slots. Each level's
+// slots are ES_WHEEL_SLOTS times as long as the level below's.
+#define ES_WHEEL_SLOT_BITS 6
+#define ES_WHEEL_SLOTS (1 << ES_WHEEL_SLOT_BITS)
+#define ES_WHEEL_LEVELS 4
+
+// the longest time that a wheel timer can be started for, 4.6 hours at 1ms
+#define ES_TIMER_WHEEL_MAX_TICKS \
+  ((1UL << (ES_WHEEL_SLOT_BITS * ES_WHEEL_LEVELS)) - 1)
+
+#ifdef ES_USE_TIMER_WHEEL
+
+// the handles follow the 16 numbered timers
+#if (TIMER_WHEEL_POOL_SIZE + 16) >= ES_TIMER_NO_HANDLE
+#error TIMER_WHEEL_POOL_SIZE is too big for an 8 bit handle
+#endif
+
+// one timer from the pool
+typedef struct
+{
+  uint32_t  Expiry;     // the wheel time at which it goes off
+  pPostFunc PostFunc;   // where the timeout goes, NULL while in the pool
+  uint8_t   Next;       // links within a slot, or within the free list
+  uint8_t   Prev;
+  uint8_t   Slot;       // the slot it is linked into, while running
+  bool      Running;
+}ES_WheelTimer_t;
+
+// the state of the wheel, one per framework context
+typedef struct
+{
+  ES_WheelTimer_t Pool[TIMER_WHEEL_POOL_SIZE];
+  // first timer in each slot, level 0's slots first
+  uint8_t         Slots[ES_WHEEL_LEVELS * ES_WHEEL_SLOTS];
+  uint8_t         FreeList;
+  uint8_t         NumFree;
+  // ticks since ES_TimerWheel_Init
+  uint32_t        Now;
+}ES_TimerWheelState_t;
+
+void ES_TimerWheel_Init(void);
+void ES_TimerWheel_Tick(void);
+ES_TimerHandle_t ES_TimerWheel_Alloc(pPostFunc PostFunc);
+ES_TimerReturn_t ES_TimerWheel_Free(ES_TimerHandle_t Handle);
+ES_TimerReturn_t ES_TimerWheel_Start(ES_TimerHandle_t Handle, uint32_t Ticks);
+ES_TimerReturn_t ES_TimerWheel_Stop(ES_TimerHandle_t Handle);
+ES_TimerReturn_t ES_TimerWheel_IsActive(ES_TimerHandle_t Handle);
+uint8_t ES_TimerWheel_GetNumFree(void);
+
+#endif /* ES_USE_TIMER_WHEEL */
+
+#endif /* ES_TimerWheel_H */
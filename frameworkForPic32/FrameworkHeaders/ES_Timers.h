@@ -14,6 +14,15 @@
  History
  When           Who	What/Why
  -------------- ---	--------
+ 10/18/26       karthi24 pending periodic timeouts tracked by service & count
+ 10/18/26       karthi24 added callback timers, ES_Timer_SetCallback
+ 10/18/26       karthi24 timers can post any event, added ES_Timer_SetEvent
+ 10/18/26       karthi24 added ES_Timer_GetRemaining & ES_Timer_StartAt
+ 10/18/26       karthi24 added timer slack, to coalesce timeouts
+ 10/18/26       karthi24 added periodic timers with overrun counts
+ 10/18/26       karthi24 32 bit timer durations, 64 bit tick & microsecond time
+ 10/18/26       karthi24 moved the timer state into ES_TimerState_t so that it
+                    can live in a framework context
  10/13/15 20:48 jec  removed prototype for IsTimerActive, I had removed the code
                      a couple of years ago
  08/13/13 12:03 jec  added prototype for ES_Timer_Tick_Resp as part of
@@ -33,6 +42,58 @@
 
 #include "ES_Port.h"
 #include "ES_Types.h"
+#include "ES_General.h"
+#include "ES_Events.h"
+
+/*
+   the size of Tflag sets the number of timers, uint8 = 8, uint16 = 16 ...)
+   to add more timers, you will need to change the data type and modify
+   the initialization of Timer2PostFunc
+*/
+typedef uint16_t Tflag_t;
+
+typedef uint32_t Timer_t; // sets size of timers to 32 bits
+
+// a function for a timer to call, instead of posting, when it goes off.
+// Num is the number of the timer.
+typedef void (*ES_TimerCallback_t)(uint8_t Num);
+
+#define ES_NUM_TIMERS (sizeof(Tflag_t) * BITS_PER_BYTE)
+
+// the state of the timer module, one per framework context
+typedef struct
+{
+  Timer_t TimerArray[ES_NUM_TIMERS];
+  Tflag_t ActiveFlags;
+  // reload value of each periodic timer, 0 for a one shot timer
+  Timer_t Periods[ES_NUM_TIMERS];
+  // periodic timers whose last timeout has been queued but not yet run,
+  // the service it was queued for, and how many events like it that
+  // service has to run before the timeout has been run, itself included
+  Tflag_t PendingFlags;
+  uint8_t PendingService[ES_NUM_TIMERS];
+  uint8_t PendingCount[ES_NUM_TIMERS];
+  // periods that went by with the last timeout still pending
+  uint16_t Overruns[ES_NUM_TIMERS];
+  // how late each timer may go off, to share a tick with other timeouts
+  Timer_t Slack[ES_NUM_TIMERS];
+  // timers that have reached their time and are waiting in their slack
+  Tflag_t DueFlags;
+  // and how many more ticks each of those may wait
+  Timer_t SlackLeft[ES_NUM_TIMERS];
+  // timeouts posted, and the number of ticks that posted any
+  uint32_t Expirations;
+  uint32_t Wakeups;
+  // what each timer posts, an ES_NO_EVENT type means the usual ES_TIMEOUT
+  ES_Event_t Events[ES_NUM_TIMERS];
+  // the callback for each timer, NULL for a timer that posts
+  ES_TimerCallback_t Callbacks[ES_NUM_TIMERS];
+  // the longest callback (core timer counts), which timer's it was, and
+  // how many callbacks took longer than TIMER_CALLBACK_MAX_US
+  uint32_t MaxCallbackTicks;
+  uint8_t  SlowestCallback;
+  uint32_t LongCallbacks;
+}ES_TimerState_t;
 
 typedef enum
 {
@@ -44,11 +105,25 @@ typedef enum
 
 void ES_Timer_Init(TimerRate_t Rate);
 void ES_Timer_Tick_Resp(void);
-ES_TimerReturn_t ES_Timer_InitTimer(uint8_t Num, uint16_t NewTime);
-ES_TimerReturn_t ES_Timer_SetTimer(uint8_t Num, uint16_t NewTime);
+ES_TimerReturn_t ES_Timer_InitTimer(uint8_t Num, uint32_t NewTime);
+ES_TimerReturn_t ES_Timer_SetTimer(uint8_t Num, uint32_t NewTime);
 ES_TimerReturn_t ES_Timer_StartTimer(uint8_t Num);
 ES_TimerReturn_t ES_Timer_StopTimer(uint8_t Num);
+ES_TimerReturn_t ES_Timer_InitPeriodic(uint8_t Num, uint32_t Period);
+ES_TimerReturn_t ES_Timer_StartAt(uint8_t Num, uint64_t Deadline);
+uint32_t ES_Timer_GetRemaining(uint8_t Num);
+uint16_t ES_Timer_GetOverruns(uint8_t Num);
+void ES_Timer_EventDelivered(uint8_t WhichService, ES_Event_t ThisEvent);
+ES_TimerReturn_t ES_Timer_SetEvent(uint8_t Num, ES_Event_t Event);
+ES_TimerReturn_t ES_Timer_SetCallback(uint8_t Num, ES_TimerCallback_t Callback);
+void ES_Timer_GetCallbackStats(uint32_t *pMaxTicks, uint8_t *pSlowest,
+    uint32_t *pLongCallbacks);
+ES_TimerReturn_t ES_Timer_SetSlack(uint8_t Num, uint32_t Slack);
+uint32_t ES_Timer_GetTicksToNextWake(void);
+void ES_Timer_GetWakeupStats(uint32_t *pExpirations, uint32_t *pWakeups);
 uint16_t ES_Timer_GetTime(void);
+uint64_t ES_Timer_GetTime64(void);
+uint64_t ES_Timer_GetMicros64(void);
 
 #endif   /* ES_Timers_H */
 /*------------------------------ End of file ------------------------------*/
@@ -67,6 +67,17 @@ size_t circular_buf_capacity(cbuf_handle_t cbuf);
 /// Returns the current number of elements in the buffer
 size_t circular_buf_size(cbuf_handle_t cbuf);
 
+/// Find the oldest data that sits in one piece, for a DMA transfer say.
+/// The data stays in the buffer until circular_buf_skip is called
+/// Requires: cbuf is valid and created by circular_buf_init
+/// Returns the number of bytes at *data, 0 if the buffer is empty
+size_t circular_buf_peek_contig(cbuf_handle_t cbuf, uint8_t ** data);
+
+/// Drop the len oldest bytes, once they have been used
+/// Requires: cbuf is valid and created by circular_buf_init, and holds at
+/// least len bytes
+void circular_buf_skip(cbuf_handle_t cbuf, size_t len);
+
 //TODO: int circular_buf_get_range(circular_buf_t cbuf, uint8_t *data, size_t len);
 //TODO: int circular_buf_put_range(circular_buf_t cbuf, uint8_t * data, size_t len);
 
@@ -20,19 +20,40 @@ extern "C" {
 #define clrLine() printf("\x1b[K")
     
 #define XMIT_BUFFER_SIZE 1024
+
+// with this defined, DMA channel 0 feeds UART1 from the transmit buffer,
+// restarted from its block complete interrupt, so output keeps going while
+// the services are busy. Without it, Terminal_MoveBuffer2UART copies bytes
+// into the UART when ES_Run is idle.
+#define TERMINAL_TX_DMA
+
+// with this defined, the UART1 receive interrupt moves every character into
+// a RECV_BUFFER_SIZE buffer, so a burst of typing or a pasted line isn't
+// lost to a FIFO overrun while ES_Run is busy
+#define TERMINAL_RX_INT
+#define RECV_BUFFER_SIZE 256
     
 // map the generic functions for testing the serial port to actual functions
 // for this platform.
+#ifdef TERMINAL_RX_INT
+#define IsNewKeyReady() Terminal_IsRxData()
+#define GetNewKey Terminal_ReadByte
+//#define putch Terminal_WriteByte
+#define kbhit() Terminal_IsRxData()
+#else
 #define IsNewKeyReady() (U1STAbits.URXDA)
 #define GetNewKey Terminal_ReadByte
 //#define putch Terminal_WriteByte
 #define kbhit() (U1STAbits.URXDA)
+#endif
     
 void Terminal_HWInit(void);
 uint8_t Terminal_ReadByte(void);
 void Terminal_WriteByte(uint8_t txByte);
 bool Terminal_IsRxData(void);
-void Terminal_MoveBuffer2UART( void );
+bool Terminal_MoveBuffer2UART( void );
+uint32_t Terminal_GetTxDropped(void);
+uint32_t Terminal_GetRxLost(void);
 
 #ifdef __XC16__  // DEPRICATED, USE FOR xc16 of xc32 v1.34 or lower
 int write(int handle, void *buffer, unsigned int len);
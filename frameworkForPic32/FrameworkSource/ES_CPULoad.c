@@ -0,0 +1,252 @@
+/****************************************************************************
+ Module
+     ES_CPULoad.c
+
+ Description
+     Accounts for where ES_Run spends its time, using the core timer as a
+     cycle counter, and turns that into rolling 1s and 10s CPU utilization
+     figures.
+
+ Notes
+     ES_Run calls ES_CPULoad_Charge() at the end of each piece of work that
+     it does. The time since the previous charge is added to the bucket
+     named in the call, so every core timer count lands in exactly one bucket.
+     Timer tick processing in _HW_Process_Pending_Ints is charged to
+     CPU_LOAD_RUN, even on passes where every queue is empty.
+     Utilization is the share of time that was not charged to CPU_LOAD_IDLE.
+     Event checker passes that find nothing, and UART passes with nothing to
+     send, are charged as idle, since that is the time that would be available
+     to the services if they needed it.
+
+     Once per second the buckets are turned into percentages and cleared.
+     The last 10 one-second figures are kept for the 10s figure.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/18/26       karthi24     the accounting state moved into the framework context
+ 10/18/26       karthi24     tick processing is charged as run time
+ 10/18/26       karthi24     started coding
+****************************************************************************/
+
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Port.h"
+#include "ES_General.h"
+#include "ES_CPULoad.h"
+#include "ES_Context.h"
+#include "dbprintf.h"
+
+#ifdef ES_USE_CPU_LOAD
+
+/*----------------------------- Module Defines ----------------------------*/
+#define NUM_LONG_WINDOWS CPU_LOAD_LONG_WINDOWS
+
+/*---------------------------- Module Functions ---------------------------*/
+static void CloseWindow(void);
+
+/*---------------------------- Module Variables ---------------------------*/
+// the accounting lives in the framework context (see ES_Context.h), so
+// that each context is charged for its own time
+#define LastMark (ES_CTX->CPULoad.LastMark)
+#define BucketCounts (ES_CTX->CPULoad.BucketCounts)
+#define WindowCounts (ES_CTX->CPULoad.WindowCounts)
+#define BucketPercent (ES_CTX->CPULoad.BucketPercent)
+#define Utilization1s (ES_CTX->CPULoad.Utilization1s)
+#define History (ES_CTX->CPULoad.History)
+#define HistoryIndex (ES_CTX->CPULoad.HistoryIndex)
+#define HistoryFilled (ES_CTX->CPULoad.HistoryFilled)
+#define SecondsToTelemetry (ES_CTX->CPULoad.SecondsToTelemetry)
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     ES_CPULoad_Init
+ Parameters
+     None
+ Returns
+     None
+ Description
+     clears the accounting and starts a new window
+ Notes
+     called from ES_Initialize
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+void ES_CPULoad_Init(void)
+{
+  uint8_t i;
+
+  for (i = 0; i < CPU_LOAD_NUM_BUCKETS; i++)
+  {
+    BucketCounts[i]   = 0;
+    BucketPercent[i]  = 0;
+  }
+  WindowCounts    = 0;
+  Utilization1s   = 0;
+  HistoryIndex    = 0;
+  HistoryFilled   = 0;
+#if CPU_LOAD_TELEMETRY_PERIOD > 0
+  SecondsToTelemetry = CPU_LOAD_TELEMETRY_PERIOD;
+#endif
+  LastMark = _HW_GetCoreCount();
+}
+
+/****************************************************************************
+ Function
+     ES_CPULoad_Charge
+ Parameters
+     ES_CPULoadBucket_t Bucket : where to charge the time since the last call
+ Returns
+     None
+ Description
+     adds the core timer counts since the last call to Bucket, and closes out
+     the 1s window when it is full
+ Notes
+     only called from ES_Run, never from an interrupt
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+void ES_CPULoad_Charge(ES_CPULoadBucket_t Bucket)
+{
+  uint32_t Now;
+  uint32_t Delta;
+
+  Now       = _HW_GetCoreCount();
+  Delta     = Now - LastMark;   // unsigned math takes care of the wrap
+  LastMark  = Now;
+
+  BucketCounts[Bucket]  += Delta;
+  WindowCounts          += Delta;
+
+  if (WindowCounts >= CORE_TICKS_PER_SEC)
+  {
+    CloseWindow();
+  }
+}
+
+/****************************************************************************
+ Function
+     ES_CPULoad_GetUtilization1s
+ Parameters
+     None
+ Returns
+     uint8_t percentage of the last complete 1s window that was not idle
+ Description
+     query function for the short term utilization
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+uint8_t ES_CPULoad_GetUtilization1s(void)
+{
+  return Utilization1s;
+}
+
+/****************************************************************************
+ Function
+     ES_CPULoad_GetUtilization10s
+ Parameters
+     None
+ Returns
+     uint8_t percentage of the last 10 complete 1s windows that was not idle
+ Description
+     query function for the long term utilization
+ Notes
+     until 10 windows have completed, this averages the ones that have
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+uint8_t ES_CPULoad_GetUtilization10s(void)
+{
+  uint16_t  Sum = 0;
+  uint8_t   i;
+
+  if (HistoryFilled == 0)
+  {
+    return 0;
+  }
+  for (i = 0; i < HistoryFilled; i++)
+  {
+    Sum += History[i];
+  }
+  return (uint8_t)(Sum / HistoryFilled);
+}
+
+/****************************************************************************
+ Function
+     ES_CPULoad_GetBucketPercent
+ Parameters
+     ES_CPULoadBucket_t Bucket : which bucket to report
+ Returns
+     uint8_t percentage of the last complete 1s window charged to Bucket
+ Description
+     query function for the breakdown of the short term utilization
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+uint8_t ES_CPULoad_GetBucketPercent(ES_CPULoadBucket_t Bucket)
+{
+  if (Bucket >= CPU_LOAD_NUM_BUCKETS)
+  {
+    return 0;
+  }
+  return BucketPercent[Bucket];
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/****************************************************************************
+ Function
+     CloseWindow
+ Parameters
+     None
+ Returns
+     None
+ Description
+     converts the bucket counts into percentages, updates the history and
+     starts a new window. Prints the telemetry line if it is due.
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+static void CloseWindow(void)
+{
+  uint32_t  CountsPerPercent;
+  uint8_t   i;
+
+  // dividing by counts/percent keeps the math inside 32 bits
+  CountsPerPercent = WindowCounts / 100;
+  for (i = 0; i < CPU_LOAD_NUM_BUCKETS; i++)
+  {
+    BucketPercent[i]  = (uint8_t)(BucketCounts[i] / CountsPerPercent);
+    BucketCounts[i]   = 0;
+  }
+  WindowCounts = 0;
+
+  Utilization1s = 100 - BucketPercent[CPU_LOAD_IDLE];
+
+  History[HistoryIndex] = Utilization1s;
+  if (++HistoryIndex >= NUM_LONG_WINDOWS)
+  {
+    HistoryIndex = 0;
+  }
+  if (HistoryFilled < NUM_LONG_WINDOWS)
+  {
+    HistoryFilled++;
+  }
+
+#if CPU_LOAD_TELEMETRY_PERIOD > 0
+  if (--SecondsToTelemetry == 0)
+  {
+    SecondsToTelemetry = CPU_LOAD_TELEMETRY_PERIOD;
+    DB_printf("CPU %d%% (10s %d%%) run %d chk %d uart %d idle %d\r\n",
+        Utilization1s, ES_CPULoad_GetUtilization10s(),
+        BucketPercent[CPU_LOAD_RUN], BucketPercent[CPU_LOAD_CHECK],
+        BucketPercent[CPU_LOAD_UART], BucketPercent[CPU_LOAD_IDLE]);
+  }
+#endif
+}
+
+#endif /* ES_USE_CPU_LOAD */
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
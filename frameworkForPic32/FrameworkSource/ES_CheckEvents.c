@@ -8,6 +8,7 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/18/26       karthi24 checkers can be gated by hardware change flags
                 jec     out all user modifications into ES_Configure
  10/16/11 12:32 jec      started coding
 *****************************************************************************/
@@ -16,6 +17,7 @@
 #include "ES_Events.h"
 #include "ES_General.h"
 #include "ES_CheckEvents.h"
+#include "ES_Port.h"
 
 // Include the header files for the module(s) with your event checkers.
 // This gets you the prototypes for the event checking functions.
@@ -28,6 +30,22 @@ static CheckFunc *const ES_EventList[] = {
   EVENT_CHECK_LIST
 };
 
+#ifdef EVENT_CHECK_SOURCES
+// the hardware source that gates each checker, in the same order
+static ES_CheckSource_t const ES_EventSources[] = {
+  EVENT_CHECK_SOURCES
+};
+
+// fails to compile if the two lists are not the same length
+typedef char CheckSourcesMatchList[
+  (ARRAY_SIZE(ES_EventSources) == ARRAY_SIZE(ES_EventList)) ? 1 : -1];
+
+// one bit per checker, set when its source has changed and it has not run
+// since. Every checker is due on the first pass so that it can take its
+// starting readings.
+static uint32_t CheckersDue = 0xFFFFFFFF;
+#endif
+
 // Implementation for public functions
 
 /****************************************************************************
@@ -40,6 +58,9 @@ static CheckFunc *const ES_EventList[] = {
  Description
    loop through the EF_EventList array executing the event checking functions
  Notes
+   with EVENT_CHECK_SOURCES defined, a gated checker is only called once its
+   source has signalled a change since the checker last ran. No more than 32
+   checkers in that case.
 
  Author
    J. Edward Carryer, 10/25/11, 08:55
@@ -47,9 +68,35 @@ static CheckFunc *const ES_EventList[] = {
 bool ES_CheckUserEvents(void)
 {
   uint8_t i;
+#ifdef EVENT_CHECK_SOURCES
+  uint8_t Dirty;
+
+  // mark every checker whose source has changed as due
+  Dirty = _HW_TakeDirtySources();
+  if (Dirty != 0)
+  {
+    for (i = 0; i < ARRAY_SIZE(ES_EventSources); i++)
+    {
+      if (Dirty & (1 << ES_EventSources[i]))
+      {
+        CheckersDue |= ((uint32_t)1 << i);
+      }
+    }
+  }
+#endif
   // loop through the array executing the event checking functions
   for (i = 0; i < ARRAY_SIZE(ES_EventList); i++)
   {
+#ifdef EVENT_CHECK_SOURCES
+    if (ES_EventSources[i] != CHECK_SRC_ALWAYS)
+    {
+      if ((CheckersDue & ((uint32_t)1 << i)) == 0)
+      {
+        continue;   // nothing has changed for this one
+      }
+      CheckersDue &= ~((uint32_t)1 << i);
+    }
+#endif
     if (ES_EventList[i]() == true)
     {
       break; // found a new event, so process it first
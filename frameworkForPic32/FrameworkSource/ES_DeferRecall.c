@@ -11,7 +11,8 @@
  History
  When           Who     What/Why
  -------------- ---     --------
-
+ 10/18/26       karthi24 recall now splices the whole deferral queue in front
+                        of the service's queue in one step
  10/11/14 14:58 jec     converted RecallEvent to RecallEvents to pull all
                         deferred events off the deferral queue
  11/02/13 16:38 jec      Began Coding
@@ -22,6 +23,7 @@
 #include "ES_Framework.h"
 #include "ES_General.h"
 #include "ES_Events.h"
+#include "ES_Queue.h"
 #include "ES_DeferRecall.h"
 
 /*--------------------------- External Variables --------------------------*/
@@ -43,31 +45,25 @@
       ES_Event * pBlock, pointer to the block of memory that implements the
         Defer/Recall queue
  Returns
-     bool true if an event was recalled, false if no event was left in queue
+     bool true if events were recalled, false if the deferral queue was
+     empty or the service's queue did not have room for all of them
  Description
-     pulls all events off the deferral queue if any are available. If there was
-     something in the queue, then it posts it LIFO fashion to the queue
-     indicated by WhichService
+     moves all of the events on the deferral queue to the front of the queue
+     indicated by WhichService, in the order that they were deferred
  Notes
-     None.
+     all or nothing: if they don't all fit, they all stay deferred.
+     The service's event mask is not applied to recalled events (see
+     ES_SpliceToService), so recall to the service that deferred them.
  Author
      J. Edward Carryer, 11/20/13 16:49
 ****************************************************************************/
 bool ES_RecallEvents(uint8_t WhichService, ES_Event_t *pBlock)
 {
-  ES_Event_t  RecalledEvent;
-  bool      WereEventsPulled = false;
-  // recall any events from the queue
-  do
+  if (ES_IsQueueEmpty(pBlock))
   {
-    ES_DeQueue(pBlock, &RecalledEvent);
-    if (RecalledEvent.EventType != ES_NO_EVENT)
-    {
-      ES_PostToServiceLIFO(WhichService, RecalledEvent);
-      WereEventsPulled = true;
-    }
-  } while (RecalledEvent.EventType != ES_NO_EVENT);
-  return WereEventsPulled;
+    return false;
+  }
+  return ES_SpliceToService(WhichService, pBlock);
 }
 
 /*------------------------------- Footnotes -------------------------------*/
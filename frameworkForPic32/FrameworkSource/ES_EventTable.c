@@ -0,0 +1,182 @@
+//#define TEST
+/****************************************************************************
+ Module
+     ES_EventTable.c
+
+ Description
+     The shared handler for the unused cells of event handler tables (see
+     ES_EventTable.h)
+
+ Notes
+     The TEST harness is a host benchmark of table dispatch against the
+     nested switch that it replaces.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/18/26       karthi24     -Wextra clean
+ 10/18/26       karthi24     started coding
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_EventTable.h"
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     ES_NoHandler
+ Parameters
+     ES_Event_t ThisEvent : the event that the state has no use for
+ Returns
+     ES_Event_t : ES_NO_EVENT
+ Description
+     ignores the event
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+ES_Event_t ES_NoHandler(ES_Event_t ThisEvent)
+{
+  (void)ThisEvent;
+  return ES_EVENT_HANDLED;
+}
+
+#ifdef TEST
+/****************************************************************************
+ Host benchmark. A machine with the shape of GameSM (8 states, every event
+ type, a handful of handled pairs per state) is run over the same random
+ stream of events, once through a nested switch and once through a handler
+ table, and the time per event is printed. Both count what they handled so
+ that the results can be checked against each other.
+ ****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define NUM_STATES  8
+#define NUM_EVENTS  (1UL << 20)
+#define NUM_PASSES  20
+
+static uint32_t Handled[NUM_STATES];
+static uint8_t  State;
+static ES_Event_t Stream[NUM_EVENTS];
+
+// handlers that move the machine around its states like GameSM does
+static ES_Event_t Next(ES_Event_t e)  { (void)e; Handled[State]++; State = (State + 1) % NUM_STATES; return ES_EVENT_HANDLED; }
+static ES_Event_t Stay(ES_Event_t e)  { (void)e; Handled[State]++; return ES_EVENT_HANDLED; }
+static ES_Event_t Param(ES_Event_t e) { if (e.EventParam & 1) { Handled[State]++; } return ES_EVENT_HANDLED; }
+
+ES_TABLE_BEGIN
+static ES_EventHandler_t const Table[NUM_STATES][ES_NUM_EVENT_TYPES] =
+{
+  ES_TABLE_DEFAULTS(NUM_STATES),
+  [0] = { ES_ROW_DEFAULTS, [ES_INIT] = Next, [ES_LED_PUSH_STEP] = Stay },
+  [1] = { ES_ROW_DEFAULTS, [ES_HAND_WAVE_DETECTED] = Next,
+          [ES_DIFFICULTY_CHANGED] = Stay, [ES_LED_PUSH_STEP] = Stay },
+  [2] = { ES_ROW_DEFAULTS, [DIRECT_HIT_B1] = Stay, [DIRECT_HIT_B2] = Stay,
+          [DIRECT_HIT_B3] = Stay, [NO_HIT_B1] = Stay, [NO_HIT_B2] = Stay,
+          [NO_HIT_B3] = Stay, [ES_TIMEOUT] = Param,
+          [ES_OBJECT_CRASHED] = Next, [ES_LED_PUSH_STEP] = Stay },
+  [3] = { ES_ROW_DEFAULTS, [ES_TIMEOUT] = Next, [ES_LED_PUSH_STEP] = Stay },
+  [4] = { ES_ROW_DEFAULTS, [ES_TIMEOUT] = Next, [ES_LED_PUSH_STEP] = Stay },
+  [5] = { ES_ROW_DEFAULTS, [ES_TIMEOUT] = Next, [ES_LED_PUSH_STEP] = Stay },
+  [6] = { ES_ROW_DEFAULTS, [ES_NEW_KEY] = Next, [ES_LED_PUSH_STEP] = Stay },
+  [7] = { ES_ROW_DEFAULTS, [ES_NEW_KEY] = Next, [ES_LED_PUSH_STEP] = Stay },
+};
+ES_TABLE_END
+
+static ES_Event_t RunTable(ES_Event_t ThisEvent)
+{
+  return ES_DISPATCH_TABLE(Table, State, ThisEvent);
+}
+
+// the same machine written the way RunGameSM was
+static ES_Event_t RunSwitch(ES_Event_t ThisEvent)
+{
+  if (ThisEvent.EventType == ES_LED_PUSH_STEP)
+  {
+    return Stay(ThisEvent);
+  }
+  switch (State)
+  {
+    case 0:
+      if (ThisEvent.EventType == ES_INIT) { return Next(ThisEvent); }
+      break;
+    case 1:
+      switch (ThisEvent.EventType)
+      {
+        case ES_HAND_WAVE_DETECTED: return Next(ThisEvent);
+        case ES_DIFFICULTY_CHANGED: return Stay(ThisEvent);
+        default: break;
+      }
+      break;
+    case 2:
+      switch (ThisEvent.EventType)
+      {
+        case DIRECT_HIT_B1: case DIRECT_HIT_B2: case DIRECT_HIT_B3:
+        case NO_HIT_B1: case NO_HIT_B2: case NO_HIT_B3:
+          return Stay(ThisEvent);
+        case ES_TIMEOUT: return Param(ThisEvent);
+        case ES_OBJECT_CRASHED: return Next(ThisEvent);
+        default: break;
+      }
+      break;
+    case 3: case 4: case 5:
+      if (ThisEvent.EventType == ES_TIMEOUT) { return Next(ThisEvent); }
+      break;
+    case 6: case 7:
+      if (ThisEvent.EventType == ES_NEW_KEY) { return Next(ThisEvent); }
+      break;
+  }
+  return ES_EVENT_HANDLED;
+}
+
+static double Time(ES_Event_t (*Run)(ES_Event_t), uint32_t *pTotal)
+{
+  clock_t   Start;
+  unsigned long i;
+  int       Pass;
+  uint8_t   s;
+
+  for (s = 0; s < NUM_STATES; s++)
+  {
+    Handled[s] = 0;
+  }
+  State = 0;
+  Start = clock();
+  for (Pass = 0; Pass < NUM_PASSES; Pass++)
+  {
+    for (i = 0; i < NUM_EVENTS; i++)
+    {
+      Run(Stream[i]);
+    }
+  }
+  *pTotal = 0;
+  for (s = 0; s < NUM_STATES; s++)
+  {
+    *pTotal += Handled[s] * (s + 1);
+  }
+  return (double)(clock() - Start) * 1e9 / CLOCKS_PER_SEC /
+         ((double)NUM_EVENTS * NUM_PASSES);
+}
+
+int main(void)
+{
+  uint32_t  SwitchTotal, TableTotal;
+  double    SwitchNs, TableNs;
+  unsigned long i;
+
+  srand(218);
+  for (i = 0; i < NUM_EVENTS; i++)
+  {
+    Stream[i].EventType   = (ES_EventType_t)(rand() % ES_NUM_EVENT_TYPES);
+    Stream[i].EventParam  = (uint16_t)rand();
+  }
+  SwitchNs  = Time(RunSwitch, &SwitchTotal);
+  TableNs   = Time(RunTable, &TableTotal);
+  printf("results %s\n", (SwitchTotal == TableTotal) ? "match" : "DIFFER");
+  printf("switch %.2f ns/event, table %.2f ns/event\n", SwitchNs, TableNs);
+  return (SwitchTotal == TableTotal) ? 0 : 1;
+}
+#endif /* TEST */
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
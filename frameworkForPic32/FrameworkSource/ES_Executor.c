@@ -0,0 +1,966 @@
+/****************************************************************************
+ Module
+     ES_Executor.c
+
+ Description
+     Threaded executor for the framework. Runs the services on NUM_WORKERS
+     worker threads, while the thread that called ES_Run keeps doing the
+     tick processing, the event checkers and the UART, as it always has.
+
+ Notes
+     Each worker owns the services assigned to it by SERV_n_WORKER, their
+     queues and a Ready word of its own. A post from the worker that owns the
+     service goes straight into the service's queue. Any other post goes into
+     the ring for that (posting thread, service) pair, and the owning worker
+     moves it into the service's queue before it picks the next event to
+     run. Since each ring has one writer and one reader, handing the indices
+     over with _HW_StoreRelease & _HW_LoadAcquire is all the locking it needs.
+
+     LIFO posts from other threads go to the back of the service's queue.
+     The only LIFO posts in the framework are recalls from a service to
+     itself, and those are always made on the owning worker.
+
+     The posting thread is the ring's producer index: workers are
+     0..NUM_WORKERS-1 and the ES_Run thread is MAIN_THREAD. Any other thread
+     would share MAIN_THREAD's rings, so it must not post.
+
+     The ES_Run thread runs the timers, so it is the only one that sets
+     LastQueued in the context. The timers, the filter drop counts and the
+     tick counts are shared by every thread, and are locked with
+     EnterCritical.
+
+     ES_USE_CPU_LOAD only charges the time of the ES_Run thread: CPU_LOAD_RUN
+     is then the time spent on the timers, not in the services.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/18/26       karthi24     back in, with a host port & a test on real threads.
+                             Ring indices passed with acquire/release, ES_Run
+                             waits for the workers to stop, CPU load charged
+                             for the ES_Run thread
+ 10/18/26       karthi24     added ES_Executor_Splice for bulk recall
+ 10/18/26       karthi24     started coding
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "ES_Queue.h"
+#include "ES_LookupTables.h"
+#include "ES_CheckEvents.h"
+#include "ES_Context.h"
+#include "ES_Executor.h"
+#include "ES_Port.h"
+#include "terminal.h"
+
+#ifdef ES_THREADED_EXECUTOR
+
+#ifndef ES_HOST_PORT
+#error "the threaded executor needs a host port, the PIC32 has no threads"
+#endif
+
+#if (EXEC_RING_SIZE & (EXEC_RING_SIZE - 1)) != 0
+#error "EXEC_RING_SIZE must be a power of 2"
+#endif
+
+/*----------------------------- Module Defines ----------------------------*/
+// the thread that called ES_Run is the producer after the workers
+#define MAIN_THREAD NUM_WORKERS
+#define NUM_THREADS (NUM_WORKERS + 1)
+
+#define RING_MASK (EXEC_RING_SIZE - 1)
+
+// services without a SERV_n_WORKER run on worker 0
+#ifndef SERV_0_WORKER
+#define SERV_0_WORKER 0
+#endif
+#ifndef SERV_1_WORKER
+#define SERV_1_WORKER 0
+#endif
+#ifndef SERV_2_WORKER
+#define SERV_2_WORKER 0
+#endif
+#ifndef SERV_3_WORKER
+#define SERV_3_WORKER 0
+#endif
+#ifndef SERV_4_WORKER
+#define SERV_4_WORKER 0
+#endif
+#ifndef SERV_5_WORKER
+#define SERV_5_WORKER 0
+#endif
+#ifndef SERV_6_WORKER
+#define SERV_6_WORKER 0
+#endif
+#ifndef SERV_7_WORKER
+#define SERV_7_WORKER 0
+#endif
+#ifndef SERV_8_WORKER
+#define SERV_8_WORKER 0
+#endif
+#ifndef SERV_9_WORKER
+#define SERV_9_WORKER 0
+#endif
+#ifndef SERV_10_WORKER
+#define SERV_10_WORKER 0
+#endif
+#ifndef SERV_11_WORKER
+#define SERV_11_WORKER 0
+#endif
+#ifndef SERV_12_WORKER
+#define SERV_12_WORKER 0
+#endif
+#ifndef SERV_13_WORKER
+#define SERV_13_WORKER 0
+#endif
+#ifndef SERV_14_WORKER
+#define SERV_14_WORKER 0
+#endif
+#ifndef SERV_15_WORKER
+#define SERV_15_WORKER 0
+#endif
+
+/*------------------------------ Module Types -----------------------------*/
+typedef struct
+{
+  ES_Event_t  Entries[EXEC_RING_SIZE];
+  uint32_t    Head;     // only written by the posting thread
+  uint32_t    Tail;     // only written by the owning worker
+}ExecRing_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static void WorkerRun(uint8_t WhichWorker);
+static void PullRings(uint8_t WhichWorker);
+
+/*---------------------------- Module Variables ---------------------------*/
+static uint8_t const ServiceWorker[NUM_SERVICES] =
+{
+  SERV_0_WORKER
+#if NUM_SERVICES > 1
+  , SERV_1_WORKER
+#endif
+#if NUM_SERVICES > 2
+  , SERV_2_WORKER
+#endif
+#if NUM_SERVICES > 3
+  , SERV_3_WORKER
+#endif
+#if NUM_SERVICES > 4
+  , SERV_4_WORKER
+#endif
+#if NUM_SERVICES > 5
+  , SERV_5_WORKER
+#endif
+#if NUM_SERVICES > 6
+  , SERV_6_WORKER
+#endif
+#if NUM_SERVICES > 7
+  , SERV_7_WORKER
+#endif
+#if NUM_SERVICES > 8
+  , SERV_8_WORKER
+#endif
+#if NUM_SERVICES > 9
+  , SERV_9_WORKER
+#endif
+#if NUM_SERVICES > 10
+  , SERV_10_WORKER
+#endif
+#if NUM_SERVICES > 11
+  , SERV_11_WORKER
+#endif
+#if NUM_SERVICES > 12
+  , SERV_12_WORKER
+#endif
+#if NUM_SERVICES > 13
+  , SERV_13_WORKER
+#endif
+#if NUM_SERVICES > 14
+  , SERV_14_WORKER
+#endif
+#if NUM_SERVICES > 15
+  , SERV_15_WORKER
+#endif
+};
+
+// one ring per posting thread per service
+static ExecRing_t Rings[NUM_THREADS][NUM_SERVICES];
+
+// which of its services' queues have events, one word per worker, only
+// touched by that worker
+static uint16_t WorkerReady[NUM_WORKERS];
+
+// post statistics, each entry only written by its posting thread
+static ES_ExecutorStats_t PostStats[NUM_THREADS];
+
+// which thread is this?
+static ES_THREAD_LOCAL uint8_t MyThread = MAIN_THREAD;
+
+// set when a run function fails, stops every thread
+static bool RunFailed;
+
+// set by each worker as it stops, so that ES_Run can wait for them
+static bool WorkerStopped[NUM_WORKERS];
+
+#ifdef ES_MULTI_CONTEXT
+// the context that ES_Run was called with, the workers run it too
+static ES_Context_t *pRunContext;
+#endif
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+   ES_Executor_Run
+ Parameters
+   None
+ Returns
+   ES_Return_t : FailedRun if any of the run functions failed,
+                 FailedOther if a worker thread could not be started
+ Description
+   starts the worker threads, then processes ticks, runs the event checkers
+   and moves bytes to the UART until a run function fails
+ Notes
+   called by ES_Run in place of its own loop. Only returns once all of the
+   workers have stopped, so their statistics can then be read.
+ Author
+   karthi24, 10/18/26
+****************************************************************************/
+ES_Return_t ES_Executor_Run(void)
+{
+  ES_Return_t ReturnVal = FailedRun;
+  uint8_t     NumStarted;
+
+#ifdef ES_MULTI_CONTEXT
+  pRunContext = ES_CTX;
+#endif
+  _HW_StoreRelease(&RunFailed, false);
+  for (NumStarted = 0; NumStarted < NUM_WORKERS; NumStarted++)
+  {
+    WorkerStopped[NumStarted] = false;
+    if (_HW_StartWorker(WorkerRun, NumStarted) != true)
+    {
+      _HW_StoreRelease(&RunFailed, true);  // stop the ones that did start
+      ReturnVal = FailedOther;
+      break;
+    }
+  }
+  while (_HW_LoadAcquire(&RunFailed) == false)
+  {
+    _HW_Process_Pending_Ints();
+#ifdef ES_USE_CPU_LOAD
+    ES_CPULoad_Charge(CPU_LOAD_RUN);  // the timers
+#endif
+    if (!ES_CheckUserEvents())  // no new user events
+    {
+#ifdef ES_USE_CPU_LOAD
+      // a checker pass that found nothing counts as idle polling
+      ES_CPULoad_Charge(CPU_LOAD_IDLE);
+#endif
+      // try moving bytes, if available, to UART
+      if (Terminal_MoveBuffer2UART() == false)
+      {
+        _HW_WorkerIdle();   // nothing to do at all
+#ifdef ES_USE_CPU_LOAD
+        ES_CPULoad_Charge(CPU_LOAD_IDLE);
+      }
+      else
+      {
+        ES_CPULoad_Charge(CPU_LOAD_UART);
+#endif
+      }
+    }
+#ifdef ES_USE_CPU_LOAD
+    else
+    {
+      ES_CPULoad_Charge(CPU_LOAD_CHECK);
+    }
+#endif
+  }
+  // let the workers finish the events that they are running
+  while (NumStarted > 0)
+  {
+    if (_HW_LoadAcquire(&WorkerStopped[NumStarted - 1]) == true)
+    {
+      NumStarted--;
+    }
+    else
+    {
+      _HW_WorkerIdle();
+    }
+  }
+  return ReturnVal;
+}
+
+/****************************************************************************
+ Function
+   ES_Executor_Post
+ Parameters
+   uint8_t : Which service to post to
+   ES_Event_t : The Event to be posted
+   bool : true to put the event at the front of the service's queue
+ Returns
+   bool : false if the service's queue or the ring to it was full
+ Description
+   posts from whichever thread is calling to a service on any worker
+ Notes
+   called by the ES_PostToService functions. A post from another thread
+   gives the ring entry back to the owning worker with a release store, so
+   the worker sees the event before it sees the new Head.
+ Author
+   karthi24, 10/18/26
+****************************************************************************/
+bool ES_Executor_Post(uint8_t WhichService, ES_Event_t TheEvent, bool ToFront)
+{
+  ExecRing_t  *pRing;
+  uint32_t    Head;
+  uint32_t    Start;
+  bool        ReturnVal;
+
+  if (WhichService >= NUM_SERVICES)
+  {
+    return false;
+  }
+  if (ServiceWorker[WhichService] == MyThread)
+  {
+    // we own this service, so its queue is ours to write
+    if (ToFront)
+    {
+      ReturnVal = ES_EnQueueLIFO(ES_GetQueueMem(WhichService), TheEvent);
+    }
+    else
+    {
+      ReturnVal = ES_EnQueueFIFO(ES_GetQueueMem(WhichService), TheEvent);
+    }
+    if (ReturnVal == true)
+    {
+      WorkerReady[MyThread] |= BitNum2SetMask[WhichService];
+    }
+    return ReturnVal;
+  }
+
+  Start = _HW_GetCoreCount();
+  pRing = &Rings[MyThread][WhichService];
+  Head  = pRing->Head;
+  // the worker must be done with a slot before it is written again
+  if ((Head - _HW_LoadAcquire(&pRing->Tail)) >= EXEC_RING_SIZE)
+  {
+    PostStats[MyThread].Rejects++;
+    return false;
+  }
+  pRing->Entries[Head & RING_MASK] = TheEvent;
+  // the entry must be visible before the new Head is
+  _HW_StoreRelease(&pRing->Head, Head + 1);
+  if (MyThread == MAIN_THREAD)
+  {
+    ES_CTX->LastQueued = WhichService;  // for the periodic timers
+  }
+  PostStats[MyThread].Posts++;
+  PostStats[MyThread].PostTicks += _HW_GetCoreCount() - Start;
+  return true;
+}
+
+/****************************************************************************
+ Function
+   ES_Executor_Splice
+ Parameters
+   uint8_t : Which service to move the events to
+   ES_Event_t * : the queue whose events are to be moved
+ Returns
+   bool : false if the service's queue did not have room for them all, or
+          the caller is not the worker that owns the service
+ Description
+   moves all of the events in a queue to the front of a service's queue
+ Notes
+   recall only makes sense from a service to itself, so only the owning
+   worker may splice
+ Author
+   karthi24, 10/18/26
+****************************************************************************/
+bool ES_Executor_Splice(uint8_t WhichService, ES_Event_t *pBlock)
+{
+  if ((WhichService >= NUM_SERVICES) ||
+      (ServiceWorker[WhichService] != MyThread))
+  {
+    return false;
+  }
+  if (ES_SpliceQueueFront(ES_GetQueueMem(WhichService), pBlock) != true)
+  {
+    return false;
+  }
+  if (!ES_IsQueueEmpty(ES_GetQueueMem(WhichService)))
+  {
+    WorkerReady[MyThread] |= BitNum2SetMask[WhichService];
+  }
+  return true;
+}
+
+/****************************************************************************
+ Function
+   ES_Executor_GetPostStats
+ Parameters
+   uint8_t : which thread, 0..NUM_WORKERS-1 for the workers, NUM_WORKERS
+             for the thread that called ES_Run
+   ES_ExecutorStats_t * : where to put a copy of the statistics
+ Returns
+   bool : false if there is no such thread
+ Description
+   reports how many posts the thread made to other threads' services, how
+   many failed because the ring was full, and how long the posts took
+ Notes
+   the copy is not atomic, read it once things have stopped for exact
+   numbers
+ Author
+   karthi24, 10/18/26
+****************************************************************************/
+bool ES_Executor_GetPostStats(uint8_t WhichThread, ES_ExecutorStats_t *pStats)
+{
+  if (WhichThread >= NUM_THREADS)
+  {
+    return false;
+  }
+  *pStats = PostStats[WhichThread];
+  return true;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/****************************************************************************
+ Function
+   WorkerRun
+ Parameters
+   uint8_t : which worker this thread is
+ Returns
+   nothing, only returns once a run function has failed
+ Description
+   the body of each worker thread. Works like the loop in ES_Run, but only
+   over the services that belong to this worker.
+ Author
+   karthi24, 10/18/26
+****************************************************************************/
+static void WorkerRun(uint8_t WhichWorker)
+{
+  uint8_t     HighestPrior;
+  ES_Event_t  ThisEvent;
+
+  MyThread = WhichWorker;
+#ifdef ES_MULTI_CONTEXT
+  ES_SetContext(pRunContext);
+#endif
+  while (_HW_LoadAcquire(&RunFailed) == false)
+  {
+    PullRings(WhichWorker);
+    if (WorkerReady[WhichWorker] != 0)
+    {
+      HighestPrior = ES_GetMSBitSet(WorkerReady[WhichWorker]);
+      if (ES_DeQueue(ES_GetQueueMem(HighestPrior), &ThisEvent) == 0)
+      {
+        // mark queue as now empty
+        WorkerReady[WhichWorker] &= BitNum2ClrMask[HighestPrior];
+      }
+      if (ES_DispatchEvent(HighestPrior, ThisEvent).EventType != ES_NO_EVENT)
+      {
+        _HW_StoreRelease(&RunFailed, true);
+      }
+    }
+    else
+    {
+      _HW_WorkerIdle();
+    }
+  }
+  _HW_StoreRelease(&WorkerStopped[WhichWorker], true);
+}
+
+/****************************************************************************
+ Function
+   PullRings
+ Parameters
+   uint8_t : which worker is pulling
+ Returns
+   nothing
+ Description
+   moves the events waiting in the rings to this worker's services into
+   the services' queues
+ Notes
+   stops pulling from a ring when the service's queue is full, the rest
+   wait in the ring until there is room
+ Author
+   karthi24, 10/18/26
+****************************************************************************/
+static void PullRings(uint8_t WhichWorker)
+{
+  ExecRing_t  *pRing;
+  ES_Event_t  *pQueue;
+  uint32_t    Head;
+  uint32_t    Tail;
+  uint8_t     Service;
+  uint8_t     Thread;
+
+  for (Service = 0; Service < NUM_SERVICES; Service++)
+  {
+    if (ServiceWorker[Service] != WhichWorker)
+    {
+      continue;
+    }
+    pQueue = ES_GetQueueMem(Service);
+    for (Thread = 0; Thread < NUM_THREADS; Thread++)
+    {
+      pRing = &Rings[Thread][Service];
+      Tail  = pRing->Tail;
+      // Head is read before the entries that it covers
+      Head  = _HW_LoadAcquire(&pRing->Head);
+      while (Tail != Head)
+      {
+        if (ES_EnQueueFIFO(pQueue, pRing->Entries[Tail & RING_MASK]) != true)
+        {
+          break;
+        }
+        WorkerReady[WhichWorker] |= BitNum2SetMask[Service];
+        Tail++;
+      }
+      // done with the entries before handing their slots back
+      _HW_StoreRelease(&pRing->Tail, Tail);
+    }
+  }
+}
+
+#ifdef TEST
+/****************************************************************************
+ Host test. Runs stand-ins for the configured services on the worker
+ threads, with real threads and the host port's clock. Streams of numbered
+ events are posted, as fast as the rings take them, by:
+   the ES_Run thread, from its event checker, to services 3 & 4
+   service 2, to service 4 on the other worker & to 3 on its own
+   service 4, back to service 2
+ and a 1 tick periodic timer posts to service 3 as well. Every event must
+ arrive once, in the order that its thread posted it, every service must
+ only ever run on its own worker and one event at a time, and the timer's
+ timeouts must all be run or counted as overruns.
+ The cross-thread posting cost and the event rate are printed at the end.
+ Build the framework without TEST, since its modules have tests of their own:
+   F="-std=gnu99 -Wall -DES_HOST_PORT -DES_THREADED_EXECUTOR -pthread
+      -IFrameworkHeaders -IProjectHeaders -Iworking_hals_libraries_and_fontstuff"
+   mkdir -p /tmp/exec; for m in Framework Queue LookupTables Timers HostPort; do
+     gcc $F -c FrameworkSource/ES_$m.c -o /tmp/exec/ES_$m.o; done
+   gcc $F -DTEST FrameworkSource/ES_Executor.c /tmp/exec/ES_*.o -o /tmp/exec/test
+ Add -fsanitize=thread to every line to check for data races too.
+ ****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ES_ServiceHeaders.h"
+
+#if NUM_SERVICES != 5
+#error the executor test stands in for exactly 5 services
+#endif
+#if (SERV_2_WORKER == SERV_4_WORKER) || (SERV_2_WORKER != SERV_3_WORKER)
+#error the executor test needs services 2 & 3 on one worker, 4 on another
+#endif
+
+#define NUM_EVENTS 100000
+#define NUM_STREAMS 5
+#define SEQ_MASK 0x0FFF
+#define PRODUCER_SHIFT 12
+// the periodic timer's events are from this producer
+#define TIMER_PRODUCER 0xF
+#define TIMER_SERVICE 3
+#define STOP_PARAM 0xFFFF
+// give up if the streams take longer than this, in seconds
+#define TEST_TIME_LIMIT 120
+
+typedef struct
+{
+  uint8_t   From;       // the service that posts it, ES_NO_SERVICE for ES_Run
+  uint8_t   To;
+  uint32_t  NumSent;    // only touched by the posting thread
+  uint32_t  NumRun;     // only written by the receiving worker
+}TestStream_t;
+
+static TestStream_t Streams[NUM_STREAMS] =
+{
+  { ES_NO_SERVICE, 3, 0, 0 },
+  { ES_NO_SERVICE, 4, 0, 0 },
+  { 2, 4, 0, 0 },
+  { 2, 3, 0, 0 },
+  { 4, 2, 0, 0 }
+};
+
+// the event type each service is sent, one that its event mask accepts
+static const ES_EventType_t StreamEvents[NUM_SERVICES] =
+{
+  ES_SHELL_RX, ES_NEW_KEY, ES_COUNTDOWN_TICK, ES_BALLOON_FRAME,
+  ES_LED_SHOW_SCORE
+};
+
+// per receiving service & posting thread, the sequence number expected next.
+// Only touched by the receiving service's worker.
+static uint32_t NextSeq[NUM_SERVICES][NUM_THREADS];
+// set while a service's run function is running
+static bool     InRun[NUM_SERVICES];
+// only touched by the service's worker
+static bool     ContinuePending[NUM_SERVICES];
+static uint32_t TimerFrames;
+static uint32_t NumInitsRun;
+static uint32_t NumErrors;
+static bool     StopPosted;
+static uint64_t TestStart;
+
+// the instances named in SERV_n_CONTEXT
+GameSM_t      GameSMInstance;
+MotorCtrl_t   MotorCtrlInstance;
+LEDService_t  LEDServiceInstance;
+
+#ifdef ES_MULTI_CONTEXT
+// the workers must run the context that ES_Run was called in
+static ES_Context_t TestContext;
+#endif
+
+static void TestError(void)
+{
+  __atomic_add_fetch(&NumErrors, 1, __ATOMIC_RELAXED);
+}
+
+#ifdef ES_USE_CPU_LOAD
+// the accounting is only for the ES_Run thread
+void ES_CPULoad_Init(void)
+{
+}
+
+void ES_CPULoad_Charge(ES_CPULoadBucket_t Bucket)
+{
+  (void)Bucket;
+  if (MyThread != MAIN_THREAD)
+  {
+    printf("CPU load charged by worker %u\n", MyThread);
+    TestError();
+  }
+}
+
+#endif
+// posts what each of the From service's streams will take, returns true
+// once they have all been sent. *pSentAny is set if anything was posted.
+static bool SendStreams(uint8_t From, bool *pSentAny)
+{
+  ES_Event_t  ThisEvent;
+  bool        AllSent = true;
+  uint8_t     i;
+
+  *pSentAny = false;
+
+  for (i = 0; i < NUM_STREAMS; i++)
+  {
+    if (Streams[i].From != From)
+    {
+      continue;
+    }
+    ThisEvent.EventType = StreamEvents[Streams[i].To];
+    while (Streams[i].NumSent < NUM_EVENTS)
+    {
+      ThisEvent.EventParam = (uint16_t)((MyThread << PRODUCER_SHIFT) |
+          (Streams[i].NumSent & SEQ_MASK));
+      if (ES_PostToService(Streams[i].To, ThisEvent) != true)
+      {
+        break;  // full, try again later
+      }
+      Streams[i].NumSent++;
+      *pSentAny = true;
+    }
+    if (Streams[i].NumSent < NUM_EVENTS)
+    {
+      AllSent = false;
+    }
+  }
+  return AllSent;
+}
+
+// a stream event arrived, it must be the next one from its thread
+static void CheckStreamEvent(uint8_t Service, uint16_t Param)
+{
+  uint8_t Producer = Param >> PRODUCER_SHIFT;
+  uint8_t i;
+
+  if ((Service == TIMER_SERVICE) && (Producer == TIMER_PRODUCER))
+  {
+    __atomic_add_fetch(&TimerFrames, 1, __ATOMIC_RELAXED);
+    return;
+  }
+  if (Producer >= NUM_THREADS)
+  {
+    printf("service %u got %X from no thread\n", Service, Param);
+    TestError();
+    return;
+  }
+  if ((Param & SEQ_MASK) != (NextSeq[Service][Producer] & SEQ_MASK))
+  {
+    printf("service %u got %u from thread %u, not %u\n", Service,
+        Param & SEQ_MASK, Producer, NextSeq[Service][Producer] & SEQ_MASK);
+    TestError();
+  }
+  NextSeq[Service][Producer]++;
+  for (i = 0; i < NUM_STREAMS; i++)
+  {
+    if ((Streams[i].To == Service) &&
+        (((Streams[i].From == ES_NO_SERVICE) && (Producer == MAIN_THREAD)) ||
+        ((Streams[i].From != ES_NO_SERVICE) &&
+        (ServiceWorker[Streams[i].From] == Producer))))
+    {
+      __atomic_store_n(&Streams[i].NumRun, Streams[i].NumRun + 1,
+          __ATOMIC_RELEASE);
+    }
+  }
+}
+
+static ES_Event_t TestRun(uint8_t Service, ES_Event_t ThisEvent)
+{
+  ES_Event_t ReturnEvent = { ES_NO_EVENT, 0 };
+  ES_Event_t Continue = { ES_LED_PUSH_STEP, 0 };
+  bool       SentAny;
+
+  if (__atomic_exchange_n(&InRun[Service], true, __ATOMIC_ACQ_REL))
+  {
+    printf("service %u run on two threads at once\n", Service);
+    TestError();
+  }
+  if (MyThread != ServiceWorker[Service])
+  {
+    printf("service %u run on thread %u\n", Service, MyThread);
+    TestError();
+  }
+  if (ThisEvent.EventType == ES_INIT)
+  {
+    __atomic_add_fetch(&NumInitsRun, 1, __ATOMIC_RELAXED);
+  }
+  else if (ThisEvent.EventParam == STOP_PARAM)
+  {
+    ReturnEvent.EventType = ES_ERROR;
+  }
+  else if (ThisEvent.EventType == Continue.EventType)
+  {
+    ContinuePending[Service] = false;
+  }
+  else if (ThisEvent.EventType == StreamEvents[Service])
+  {
+    CheckStreamEvent(Service, ThisEvent.EventParam);
+  }
+  // a service with streams to send keeps itself going with Continue events.
+  // If the rings were all full, the core goes to the threads that empty
+  // them before the next try, or a single core host spins here.
+  if (((Service == 2) || (Service == 4)) && !SendStreams(Service, &SentAny))
+  {
+    if (!SentAny && (ThisEvent.EventType == Continue.EventType))
+    {
+      _HW_WorkerIdle();
+    }
+    if (!ContinuePending[Service])
+    {
+      ContinuePending[Service] = ES_PostToService(Service, Continue);
+    }
+  }
+  __atomic_store_n(&InRun[Service], false, __ATOMIC_RELEASE);
+  return ReturnEvent;
+}
+
+static ES_Event_t TestInstanceRun(void *pContext, uint8_t Service,
+    ES_Event_t ThisEvent)
+{
+  if (ES_GetServiceContext(Service) != pContext)
+  {
+    printf("service %u ran an instance that isn't its own\n", Service);
+    TestError();
+  }
+  return TestRun(Service, ThisEvent);
+}
+
+// the ES_Run thread's stream, then the stop once everything has been run
+bool ES_CheckUserEvents(void)
+{
+  ES_Event_t  StopEvent = { ES_NEW_KEY, STOP_PARAM };
+  bool        AllRun = true;
+  bool        SentAny;
+  uint8_t     i;
+
+  if (_HW_GetCoreCount64() - TestStart >
+      (uint64_t)TEST_TIME_LIMIT * CORE_TICKS_PER_SEC)
+  {
+    printf("the streams stalled\n");
+    for (i = 0; i < NUM_STREAMS; i++)
+    {
+      printf("stream %u: %u sent, %u run\n", i, Streams[i].NumSent,
+          __atomic_load_n(&Streams[i].NumRun, __ATOMIC_ACQUIRE));
+    }
+    exit(1);
+  }
+  SendStreams(ES_NO_SERVICE, &SentAny);
+  for (i = 0; i < NUM_STREAMS; i++)
+  {
+    if (__atomic_load_n(&Streams[i].NumRun, __ATOMIC_ACQUIRE) < NUM_EVENTS)
+    {
+      AllRun = false;
+    }
+  }
+  if (AllRun && !StopPosted)
+  {
+    StopPosted = ES_PostToService(1, StopEvent);
+  }
+  return false;
+}
+
+// the timers' response functions
+bool PostGameSM(ES_Event_t ThisEvent)
+{
+  return ES_PostToService(2, ThisEvent);
+}
+
+bool PostMotorCtrl(ES_Event_t ThisEvent)
+{
+  return ES_PostToService(TIMER_SERVICE, ThisEvent);
+}
+
+bool PostTestHarnessService0(ES_Event_t ThisEvent)
+{
+  return ES_PostToService(1, ThisEvent);
+}
+
+// stand-ins for the configured services, under their configured names
+#define TEST_SERVICE(Init, Run, Service)                  \
+  bool Init(uint8_t Priority)                             \
+  {                                                       \
+    ES_Event_t InitEvent = { ES_INIT, 0 };                \
+    return ES_PostToService(Priority, InitEvent);         \
+  }                                                       \
+  ES_Event_t Run(ES_Event_t ThisEvent)                    \
+  {                                                       \
+    return TestRun(Service, ThisEvent);                   \
+  }
+
+#define TEST_INSTANCE_SERVICE(Init, Run, Service)         \
+  bool Init(void *pContext, uint8_t Priority)             \
+  {                                                       \
+    ES_Event_t InitEvent = { ES_INIT, 0 };                \
+    return ES_PostToInstance(pContext, InitEvent) &&      \
+           (Priority == Service);                         \
+  }                                                       \
+  ES_Event_t Run(void *pContext, ES_Event_t ThisEvent)    \
+  {                                                       \
+    return TestInstanceRun(pContext, Service, ThisEvent); \
+  }
+
+#ifdef SERV_0_CONTEXT
+TEST_INSTANCE_SERVICE(SERV_0_INIT, SERV_0_RUN, 0)
+#else
+TEST_SERVICE(SERV_0_INIT, SERV_0_RUN, 0)
+#endif
+#ifdef SERV_1_CONTEXT
+TEST_INSTANCE_SERVICE(SERV_1_INIT, SERV_1_RUN, 1)
+#else
+TEST_SERVICE(SERV_1_INIT, SERV_1_RUN, 1)
+#endif
+#ifdef SERV_2_CONTEXT
+TEST_INSTANCE_SERVICE(SERV_2_INIT, SERV_2_RUN, 2)
+#else
+TEST_SERVICE(SERV_2_INIT, SERV_2_RUN, 2)
+#endif
+#ifdef SERV_3_CONTEXT
+TEST_INSTANCE_SERVICE(SERV_3_INIT, SERV_3_RUN, 3)
+#else
+TEST_SERVICE(SERV_3_INIT, SERV_3_RUN, 3)
+#endif
+#ifdef SERV_4_CONTEXT
+TEST_INSTANCE_SERVICE(SERV_4_INIT, SERV_4_RUN, 4)
+#else
+TEST_SERVICE(SERV_4_INIT, SERV_4_RUN, 4)
+#endif
+
+// every timeout must have been run or counted as an overrun, bar one that
+// may still have been waiting when the workers stopped
+static void CheckTimer(void)
+{
+  uint32_t Expirations;
+  uint32_t Wakeups;
+  uint32_t Accounted;
+
+  ES_Timer_GetWakeupStats(&Expirations, &Wakeups);
+  Accounted = TimerFrames + ES_Timer_GetOverruns(TID_BALLOON_UPDATE);
+  printf("timer: %u timeouts, %u run, %u overruns\n", Expirations,
+      TimerFrames, Accounted - TimerFrames);
+  if ((TimerFrames == 0) || (Accounted > Expirations) ||
+      (Expirations - Accounted > 1))
+  {
+    printf("%u of the timer's %u timeouts accounted for\n", Accounted,
+        Expirations);
+    NumErrors++;
+  }
+}
+
+static void PrintPostStats(uint64_t RunTicks)
+{
+  ES_ExecutorStats_t  Stats;
+  uint64_t            NumRun = 0;
+  uint8_t             i;
+
+  for (i = 0; i < NUM_THREADS; i++)
+  {
+    ES_Executor_GetPostStats(i, &Stats);
+    printf("%s %u: %u posts to other threads, %u ring full, %u ns/post\n",
+        (i == MAIN_THREAD) ? "ES_Run thread" : "worker", i, Stats.Posts,
+        Stats.Rejects, (Stats.Posts == 0) ? 0 : (unsigned)((uint64_t)
+        Stats.PostTicks * (1000 / CORE_TICKS_PER_US) / Stats.Posts));
+  }
+  for (i = 0; i < NUM_STREAMS; i++)
+  {
+    NumRun += Streams[i].NumRun;
+  }
+  printf("%u events run in %u ms, %u events/s\n", (unsigned)NumRun,
+      (unsigned)(RunTicks / (CORE_TICKS_PER_SEC / 1000)),
+      (unsigned)(NumRun * CORE_TICKS_PER_SEC / RunTicks));
+}
+
+int main(void)
+{
+  ES_Event_t  TimerEvent = { ES_BALLOON_FRAME, TIMER_PRODUCER << PRODUCER_SHIFT };
+  uint8_t     i;
+
+#ifdef ES_MULTI_CONTEXT
+  ES_SetContext(&TestContext);
+#endif
+  if (ES_Initialize(ES_Timer_RATE_1mS) != Success)
+  {
+    printf("ES_Initialize failed\n");
+    return 1;
+  }
+  ES_Timer_SetEvent(TID_BALLOON_UPDATE, TimerEvent);
+  ES_Timer_InitPeriodic(TID_BALLOON_UPDATE, 1);
+  TestStart = _HW_GetCoreCount64();
+  if (ES_Run() != FailedRun)
+  {
+    printf("ES_Run didn't stop on the stop event\n");
+    NumErrors++;
+  }
+  // the workers have stopped, so everything can be read directly now
+  if (NumInitsRun != NUM_SERVICES)
+  {
+    printf("%u of %u ES_INITs run\n", NumInitsRun, NUM_SERVICES);
+    NumErrors++;
+  }
+  for (i = 0; i < NUM_STREAMS; i++)
+  {
+    if ((Streams[i].NumSent != NUM_EVENTS) ||
+        (Streams[i].NumRun != NUM_EVENTS))
+    {
+      printf("stream %u: %u sent, %u run\n", i, Streams[i].NumSent,
+          Streams[i].NumRun);
+      NumErrors++;
+    }
+  }
+  CheckTimer();
+  PrintPostStats(_HW_GetCoreCount64() - TestStart);
+
+  printf("%u errors\n", NumErrors);
+  return NumErrors != 0;
+}
+
+#endif /* TEST */
+
+#endif /* ES_THREADED_EXECUTOR */
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -8,6 +8,25 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/18/26       karthi24 the threaded executor is back as an alternative to the
+                         ES_Run loop, filter drop counts locked under it
+ 10/18/26       karthi24 added ES_GetServiceContext, host test runs the two
+                         contexts on their own threads, with their own instances
+ 10/18/26       karthi24 queued posts noted in LastQueued, added ES_CountQueued,
+                         so periodic timers can find their timeouts
+ 10/18/26       karthi24 recalled events recorded in ES_QueueStats
+ 10/18/26       karthi24 timer tick processing charged to CPU_LOAD_RUN
+ 10/18/26       karthi24 host test running two contexts side by side
+ 10/18/26       karthi24 every event run is offered to the timers, as a timer may
+                         post any event
+ 10/18/26       karthi24 timeouts reported to the timers as they are run
+ 10/18/26       karthi24 posts recorded in ES_QueueStats for the queue size
+                         advisor
+ 10/18/26       karthi24 posts filtered by per-service accepted event masks
+ 10/18/26       karthi24 added ES_SpliceToService for bulk recall
+ 10/18/26       karthi24 moved the framework state into ES_Context_t
+ 10/18/26       karthi24 added multi-instance services with per-instance context
+ 10/18/26       karthi24 added CPU load accounting to ES_Run
  08/21/17 13:18 jec     added conditional call to initialize the port lines
                         for the hardware debugging of the framework/apps
  12/19/16 20:18 jec      changed includes to accomodate the change to a fixed
@@ -34,6 +53,10 @@
 #include "../FrameworkHeaders/ES_Timers.h"
 #include "../FrameworkHeaders/ES_General.h"
 #include "../FrameworkHeaders/ES_CheckEvents.h"
+#include "../FrameworkHeaders/ES_CPULoad.h"
+#include "../FrameworkHeaders/ES_Context.h"
+#include "../FrameworkHeaders/ES_Executor.h"
+#include "../FrameworkHeaders/ES_QueueStats.h"
 // Include the header files for the Service modules.
 // This gets you the prototypes for the public service functions.
 
@@ -44,6 +67,7 @@
 #include "ES_Port.h"          // needed for definition of REENTRANT
 
 #include <stdio.h>
+#include <stddef.h>
 
 #ifndef ES_CONFIGURE_H
 #error "ES_Configure.h was not included"
@@ -58,184 +82,346 @@ typedef RunFunc_t   *pRunFunc;
 
 #define NULL_INIT_FUNC ((pInitFunc)0)
 
+// a service is either a plain service, with InitFunc & RunFunc, or one
+// instance of a multi-instance service, with InstInitFunc, InstRunFunc and
+// the context for that instance.
 typedef struct
 {
-  InitFunc_t *InitFunc;       // Service Initialization function
-  RunFunc_t *RunFunc;         // Service Run function
+  InitFunc_t *InitFunc;         // Service Initialization function
+  RunFunc_t *RunFunc;           // Service Run function
+  InstInitFunc_t *InstInitFunc; // Instance Initialization function
+  InstRunFunc_t *InstRunFunc;   // Instance Run function
+  void *pContext;               // Instance context, NULL for plain services
 }ES_ServDesc_t;
 
+#define SERVICE_DESC(Init, Run) \
+  { Init, Run, (InstInitFunc_t *)0, (InstRunFunc_t *)0, (void *)0 }
+#define INSTANCE_DESC(Init, Run, Context) \
+  { NULL_INIT_FUNC, (pRunFunc)0, Init, Run, Context }
+
 typedef struct
 {
-  ES_Event_t *pMem;       // pointer to the memory
+  uint16_t Offset;      // where the memory is in the context
   uint8_t Size;         // how big is it
 }ES_QueueDesc_t;
 
+// with the threaded executor, every thread may post, so the counts that the
+// posts share are updated in a critical region
+#ifdef ES_THREADED_EXECUTOR
+#define COUNT_LOCK() EnterCritical()
+#define COUNT_UNLOCK() ExitCritical()
+#else
+#define COUNT_LOCK()
+#define COUNT_UNLOCK()
+#endif
+
 /*---------------------------- Module Functions ---------------------------*/
 //static bool CheckSystemEvents( void );
+static void CountFilterDrop(uint8_t WhichService);
+#ifndef ES_THREADED_EXECUTOR
+static bool ProcessPendingInts(void);
+#endif
 
 /*---------------------------- Module Variables ---------------------------*/
 /****************************************************************************/
 // You fill in this array with the names of the service init & run functions
 // for each service that you use.
 // The order is: InitFunction, RunFunction
+// If SERV_n_CONTEXT is defined, service n is an instance of a multi-instance
+// service and gets that context pointer passed to its init & run functions
 // The first entry, at index 0, is the lowest priority, with increasing
 // priority with higher indices
 
 static ES_ServDesc_t const ServDescList[] =
-{ { SERV_0_INIT, SERV_0_RUN } /* lowest priority  always present */
+{
+#ifdef SERV_0_CONTEXT
+  INSTANCE_DESC(SERV_0_INIT, SERV_0_RUN, SERV_0_CONTEXT) /* lowest priority  always present */
+#else
+  SERVICE_DESC(SERV_0_INIT, SERV_0_RUN) /* lowest priority  always present */
+#endif
 #if NUM_SERVICES > 1
-  , { SERV_1_INIT, SERV_1_RUN }
+#ifdef SERV_1_CONTEXT
+  , INSTANCE_DESC(SERV_1_INIT, SERV_1_RUN, SERV_1_CONTEXT)
+#else
+  , SERVICE_DESC(SERV_1_INIT, SERV_1_RUN)
+#endif
 #endif
 #if NUM_SERVICES > 2
-  , { SERV_2_INIT, SERV_2_RUN }
+#ifdef SERV_2_CONTEXT
+  , INSTANCE_DESC(SERV_2_INIT, SERV_2_RUN, SERV_2_CONTEXT)
+#else
+  , SERVICE_DESC(SERV_2_INIT, SERV_2_RUN)
+#endif
 #endif
 #if NUM_SERVICES > 3
-  , { SERV_3_INIT, SERV_3_RUN }
+#ifdef SERV_3_CONTEXT
+  , INSTANCE_DESC(SERV_3_INIT, SERV_3_RUN, SERV_3_CONTEXT)
+#else
+  , SERVICE_DESC(SERV_3_INIT, SERV_3_RUN)
+#endif
 #endif
 #if NUM_SERVICES > 4
-  , { SERV_4_INIT, SERV_4_RUN }
+#ifdef SERV_4_CONTEXT
+  , INSTANCE_DESC(SERV_4_INIT, SERV_4_RUN, SERV_4_CONTEXT)
+#else
+  , SERVICE_DESC(SERV_4_INIT, SERV_4_RUN)
+#endif
 #endif
 #if NUM_SERVICES > 5
-  , { SERV_5_INIT, SERV_5_RUN }
+#ifdef SERV_5_CONTEXT
+  , INSTANCE_DESC(SERV_5_INIT, SERV_5_RUN, SERV_5_CONTEXT)
+#else
+  , SERVICE_DESC(SERV_5_INIT, SERV_5_RUN)
+#endif
 #endif
 #if NUM_SERVICES > 6
-  , { SERV_6_INIT, SERV_6_RUN }
+#ifdef SERV_6_CONTEXT
+  , INSTANCE_DESC(SERV_6_INIT, SERV_6_RUN, SERV_6_CONTEXT)
+#else
+  , SERVICE_DESC(SERV_6_INIT, SERV_6_RUN)
+#endif
 #endif
 #if NUM_SERVICES > 7
-  , { SERV_7_INIT, SERV_7_RUN }
+#ifdef SERV_7_CONTEXT
+  , INSTANCE_DESC(SERV_7_INIT, SERV_7_RUN, SERV_7_CONTEXT)
+#else
+  , SERVICE_DESC(SERV_7_INIT, SERV_7_RUN)
+#endif
 #endif
 #if NUM_SERVICES > 8
-  , { SERV_8_INIT, SERV_8_RUN }
+#ifdef SERV_8_CONTEXT
+  , INSTANCE_DESC(SERV_8_INIT, SERV_8_RUN, SERV_8_CONTEXT)
+#else
+  , SERVICE_DESC(SERV_8_INIT, SERV_8_RUN)
+#endif
 #endif
 #if NUM_SERVICES > 9
-  , { SERV_9_INIT, SERV_9_RUN }
+#ifdef SERV_9_CONTEXT
+  , INSTANCE_DESC(SERV_9_INIT, SERV_9_RUN, SERV_9_CONTEXT)
+#else
+  , SERVICE_DESC(SERV_9_INIT, SERV_9_RUN)
+#endif
 #endif
 #if NUM_SERVICES > 10
-  , { SERV_10_INIT, SERV_10_RUN }
+#ifdef SERV_10_CONTEXT
+  , INSTANCE_DESC(SERV_10_INIT, SERV_10_RUN, SERV_10_CONTEXT)
+#else
+  , SERVICE_DESC(SERV_10_INIT, SERV_10_RUN)
+#endif
 #endif
 #if NUM_SERVICES > 11
-  , { SERV_11_INIT, SERV_11_RUN }
+#ifdef SERV_11_CONTEXT
+  , INSTANCE_DESC(SERV_11_INIT, SERV_11_RUN, SERV_11_CONTEXT)
+#else
+  , SERVICE_DESC(SERV_11_INIT, SERV_11_RUN)
+#endif
 #endif
 #if NUM_SERVICES > 12
-  , { SERV_12_INIT, SERV_12_RUN }
+#ifdef SERV_12_CONTEXT
+  , INSTANCE_DESC(SERV_12_INIT, SERV_12_RUN, SERV_12_CONTEXT)
+#else
+  , SERVICE_DESC(SERV_12_INIT, SERV_12_RUN)
+#endif
 #endif
 #if NUM_SERVICES > 13
-  , { SERV_13_INIT, SERV_13_RUN }
+#ifdef SERV_13_CONTEXT
+  , INSTANCE_DESC(SERV_13_INIT, SERV_13_RUN, SERV_13_CONTEXT)
+#else
+  , SERVICE_DESC(SERV_13_INIT, SERV_13_RUN)
+#endif
 #endif
 #if NUM_SERVICES > 14
-  , { SERV_14_INIT, SERV_14_RUN }
+#ifdef SERV_14_CONTEXT
+  , INSTANCE_DESC(SERV_14_INIT, SERV_14_RUN, SERV_14_CONTEXT)
+#else
+  , SERVICE_DESC(SERV_14_INIT, SERV_14_RUN)
+#endif
 #endif
 #if NUM_SERVICES > 15
-  , { SERV_15_INIT, SERV_15_RUN }
+#ifdef SERV_15_CONTEXT
+  , INSTANCE_DESC(SERV_15_INIT, SERV_15_RUN, SERV_15_CONTEXT)
+#else
+  , SERVICE_DESC(SERV_15_INIT, SERV_15_RUN)
+#endif
 #endif
 };
 
 /****************************************************************************/
-// The queues for the services
+// array of queue descriptors for posting by priority level. The queues
+// themselves live in the framework context, so these hold their offsets.
 
-static ES_Event_t Queue0[SERV_0_QUEUE_SIZE + 1];
+#define QUEUE_DESC(n) \
+  { offsetof(ES_Context_t, Queue##n), \
+    ARRAY_SIZE(((ES_Context_t *)0)->Queue##n) }
+
+static ES_QueueDesc_t const EventQueues[NUM_SERVICES] = {
+  QUEUE_DESC(0)
 #if NUM_SERVICES > 1
-static ES_Event_t Queue1[SERV_1_QUEUE_SIZE + 1];
+  , QUEUE_DESC(1)
 #endif
 #if NUM_SERVICES > 2
-static ES_Event_t Queue2[SERV_2_QUEUE_SIZE + 1];
+  , QUEUE_DESC(2)
 #endif
 #if NUM_SERVICES > 3
-static ES_Event_t Queue3[SERV_3_QUEUE_SIZE + 1];
+  , QUEUE_DESC(3)
 #endif
 #if NUM_SERVICES > 4
-static ES_Event_t Queue4[SERV_4_QUEUE_SIZE + 1];
+  , QUEUE_DESC(4)
 #endif
 #if NUM_SERVICES > 5
-static ES_Event_t Queue5[SERV_5_QUEUE_SIZE + 1];
+  , QUEUE_DESC(5)
 #endif
 #if NUM_SERVICES > 6
-static ES_Event_t Queue6[SERV_6_QUEUE_SIZE + 1];
+  , QUEUE_DESC(6)
 #endif
 #if NUM_SERVICES > 7
-static ES_Event_t Queue7[SERV_7_QUEUE_SIZE + 1];
+  , QUEUE_DESC(7)
 #endif
 #if NUM_SERVICES > 8
-static ES_Event_t Queue8[SERV_8_QUEUE_SIZE + 1];
+  , QUEUE_DESC(8)
 #endif
 #if NUM_SERVICES > 9
-static ES_Event_t Queue9[SERV_9_QUEUE_SIZE + 1];
+  , QUEUE_DESC(9)
 #endif
 #if NUM_SERVICES > 10
-static ES_Event_t Queue10[SERV_10_QUEUE_SIZE + 1];
+  , QUEUE_DESC(10)
 #endif
 #if NUM_SERVICES > 11
-static ES_Event_t Queue11[SERV_11_QUEUE_SIZE + 1];
+  , QUEUE_DESC(11)
 #endif
 #if NUM_SERVICES > 12
-static ES_Event_t Queue12[SERV_12_QUEUE_SIZE + 1];
+  , QUEUE_DESC(12)
 #endif
 #if NUM_SERVICES > 13
-static ES_Event_t Queue13[SERV_13_QUEUE_SIZE + 1];
+  , QUEUE_DESC(13)
 #endif
 #if NUM_SERVICES > 14
-static ES_Event_t Queue14[SERV_14_QUEUE_SIZE + 1];
+  , QUEUE_DESC(14)
 #endif
 #if NUM_SERVICES > 15
-static ES_Event_t Queue15[SERV_15_QUEUE_SIZE + 1];
+  , QUEUE_DESC(15)
 #endif
+};
+
+// the address of a service's queue within a context
+#define QUEUE_MEM(pCtx, Which) \
+  ((ES_Event_t *)((uint8_t *)(pCtx) + EventQueues[Which].Offset))
 
 /****************************************************************************/
-// array of queue descriptors for posting by priority level
+// the event types that each service accepts, every type unless the service
+// has a SERV_n_EVENT_MASK
+#ifndef SERV_0_EVENT_MASK
+#define SERV_0_EVENT_MASK ES_ALL_EVENTS
+#endif
+#ifndef SERV_1_EVENT_MASK
+#define SERV_1_EVENT_MASK ES_ALL_EVENTS
+#endif
+#ifndef SERV_2_EVENT_MASK
+#define SERV_2_EVENT_MASK ES_ALL_EVENTS
+#endif
+#ifndef SERV_3_EVENT_MASK
+#define SERV_3_EVENT_MASK ES_ALL_EVENTS
+#endif
+#ifndef SERV_4_EVENT_MASK
+#define SERV_4_EVENT_MASK ES_ALL_EVENTS
+#endif
+#ifndef SERV_5_EVENT_MASK
+#define SERV_5_EVENT_MASK ES_ALL_EVENTS
+#endif
+#ifndef SERV_6_EVENT_MASK
+#define SERV_6_EVENT_MASK ES_ALL_EVENTS
+#endif
+#ifndef SERV_7_EVENT_MASK
+#define SERV_7_EVENT_MASK ES_ALL_EVENTS
+#endif
+#ifndef SERV_8_EVENT_MASK
+#define SERV_8_EVENT_MASK ES_ALL_EVENTS
+#endif
+#ifndef SERV_9_EVENT_MASK
+#define SERV_9_EVENT_MASK ES_ALL_EVENTS
+#endif
+#ifndef SERV_10_EVENT_MASK
+#define SERV_10_EVENT_MASK ES_ALL_EVENTS
+#endif
+#ifndef SERV_11_EVENT_MASK
+#define SERV_11_EVENT_MASK ES_ALL_EVENTS
+#endif
+#ifndef SERV_12_EVENT_MASK
+#define SERV_12_EVENT_MASK ES_ALL_EVENTS
+#endif
+#ifndef SERV_13_EVENT_MASK
+#define SERV_13_EVENT_MASK ES_ALL_EVENTS
+#endif
+#ifndef SERV_14_EVENT_MASK
+#define SERV_14_EVENT_MASK ES_ALL_EVENTS
+#endif
+#ifndef SERV_15_EVENT_MASK
+#define SERV_15_EVENT_MASK ES_ALL_EVENTS
+#endif
 
-static ES_QueueDesc_t const EventQueues[NUM_SERVICES] = {
-  { Queue0, ARRAY_SIZE(Queue0) }
+static uint32_t const AcceptMasks[NUM_SERVICES] =
+{
+  SERV_0_EVENT_MASK
 #if NUM_SERVICES > 1
-  , { Queue1, ARRAY_SIZE(Queue1) }
+  , SERV_1_EVENT_MASK
 #endif
 #if NUM_SERVICES > 2
-  , { Queue2, ARRAY_SIZE(Queue2) }
+  , SERV_2_EVENT_MASK
 #endif
 #if NUM_SERVICES > 3
-  , { Queue3, ARRAY_SIZE(Queue3) }
+  , SERV_3_EVENT_MASK
 #endif
 #if NUM_SERVICES > 4
-  , { Queue4, ARRAY_SIZE(Queue4) }
+  , SERV_4_EVENT_MASK
 #endif
 #if NUM_SERVICES > 5
-  , { Queue5, ARRAY_SIZE(Queue5) }
+  , SERV_5_EVENT_MASK
 #endif
 #if NUM_SERVICES > 6
-  , { Queue6, ARRAY_SIZE(Queue6) }
+  , SERV_6_EVENT_MASK
 #endif
 #if NUM_SERVICES > 7
-  , { Queue7, ARRAY_SIZE(Queue7) }
+  , SERV_7_EVENT_MASK
 #endif
 #if NUM_SERVICES > 8
-  , { Queue8, ARRAY_SIZE(Queue8) }
+  , SERV_8_EVENT_MASK
 #endif
 #if NUM_SERVICES > 9
-  , { Queue9, ARRAY_SIZE(Queue9) }
+  , SERV_9_EVENT_MASK
 #endif
 #if NUM_SERVICES > 10
-  , { Queue10, ARRAY_SIZE(Queue10) }
+  , SERV_10_EVENT_MASK
 #endif
 #if NUM_SERVICES > 11
-  , { Queue11, ARRAY_SIZE(Queue11) }
+  , SERV_11_EVENT_MASK
 #endif
 #if NUM_SERVICES > 12
-  , { Queue12, ARRAY_SIZE(Queue12) }
+  , SERV_12_EVENT_MASK
 #endif
 #if NUM_SERVICES > 13
-  , { Queue13, ARRAY_SIZE(Queue13) }
+  , SERV_13_EVENT_MASK
 #endif
 #if NUM_SERVICES > 14
-  , { Queue14, ARRAY_SIZE(Queue14) }
+  , SERV_14_EVENT_MASK
 #endif
 #if NUM_SERVICES > 15
-  , { Queue15, ARRAY_SIZE(Queue15) }
+  , SERV_15_EVENT_MASK
 #endif
 };
 
+// event types beyond the mask are always accepted
+#define ACCEPTS(Service, Type) \
+  (((Type) >= 32) || ((AcceptMasks[Service] & ES_EVENT_BIT(Type)) != 0))
+
 /****************************************************************************/
-// Variable used to keep track of which queues have events in them
+// The framework state. Unless ES_MULTI_CONTEXT is defined this is the only
+// context.
 
-uint16_t Ready;
+ES_Context_t ES_DefaultContext;
+
+#ifdef ES_MULTI_CONTEXT
+ES_THREAD_LOCAL ES_Context_t *ES_pCurrentContext = &ES_DefaultContext;
+#endif
 
 /*------------------------------ Module Code ------------------------------*/
 /****************************************************************************
@@ -249,32 +435,63 @@ uint16_t Ready;
  Description
    Initialize all the services and tests for NULL pointers in the array
  Notes
+   initializes the current framework context
 
  Author
    J. Edward Carryer, 10/23/11,
 ****************************************************************************/
 ES_Return_t ES_Initialize(TimerRate_t NewRate)
 {
-  uint8_t i;
+  ES_Context_t  *pCtx = ES_CTX;
+  uint8_t       i;
   ES_Timer_Init(NewRate);  // start up the timer subsystem
   // loop through the list testing for NULL pointers and
   for (i = 0; i < ARRAY_SIZE(ServDescList); i++)
   {
-    if ((ServDescList[i].InitFunc == (pInitFunc)0) ||
-        (ServDescList[i].RunFunc == (pRunFunc)0))
+    if (ServDescList[i].pContext == (void *)0)
+    {
+      if ((ServDescList[i].InitFunc == (pInitFunc)0) ||
+          (ServDescList[i].RunFunc == (pRunFunc)0))
+      {
+        return FailedPointer; // protect against NULL pointers
+      }
+    }
+    else if ((ServDescList[i].InstInitFunc == (InstInitFunc_t *)0) ||
+        (ServDescList[i].InstRunFunc == (InstRunFunc_t *)0))
     {
       return FailedPointer; // protect against NULL pointers
     }
     // and initializing the event queues (must happen before running inits)
-    ES_InitQueue(EventQueues[i].pMem, EventQueues[i].Size);
+    ES_InitQueue(QUEUE_MEM(pCtx, i), EventQueues[i].Size);
     // executing the init functions
-    if (ServDescList[i].InitFunc(i) != true)
+    if (ServDescList[i].pContext == (void *)0)
     {
-      return FailedInit; // this is a failed initialization
+      if (ServDescList[i].InitFunc(i) != true)
+      {
+        return FailedInit; // this is a failed initialization
+      }
+    }
+    else
+    {
+      // a context may already have been given its own instance
+      if (pCtx->pServiceContext[i] == (void *)0)
+      {
+        pCtx->pServiceContext[i] = ServDescList[i].pContext;
+      }
+      // instances learn their priority through their context, so that
+      // ES_PostToInstance can find their queue
+      ((ES_Instance_t *)pCtx->pServiceContext[i])->Priority = i;
+      if (ServDescList[i].InstInitFunc(pCtx->pServiceContext[i], i) != true)
+      {
+        return FailedInit; // this is a failed initialization
+      }
     }
   }
 #ifdef _INCLUDE_BASIC_FRAMEWORK_DEBUG_
   _HW_DebugLines_Init();
+#endif
+#ifdef ES_USE_CPU_LOAD
+  ES_CPULoad_Init();
 #endif
   return Success;
 }
@@ -294,37 +511,42 @@ ES_Return_t ES_Initialize(TimerRate_t NewRate)
    user generated events or moves bytes from buffer to UART.
  Notes
    this function only returns in case of an error
+   with ES_THREADED_EXECUTOR defined, the work is handed to ES_Executor_Run
  Author
    J. Edward Carryer, 10/23/11,
 ****************************************************************************/
 ES_Return_t ES_Run(void)
 {
-  // make these static to improve speed
+#ifdef ES_THREADED_EXECUTOR
+  return ES_Executor_Run();
+#else
+  // these are automatic so that each thread running a context has its own
+  ES_Context_t    *pCtx = ES_CTX;
   uint8_t         HighestPrior;
-  static ES_Event_t ThisEvent;
+  ES_Event_t      ThisEvent;
 
   while (1)  // stay here unless we detect an error condition
   { // loop through the list executing the run functions for services
     // with a non-empty queue. Process any pending ints before testing
     // Ready
-    while ((_HW_Process_Pending_Ints()) && (Ready != 0))
+    while ((ProcessPendingInts()) && (pCtx->Ready != 0))
     {
-      HighestPrior = ES_GetMSBitSet(Ready);
-      if (ES_DeQueue(EventQueues[HighestPrior].pMem, &ThisEvent) == 0)
+      HighestPrior = ES_GetMSBitSet(pCtx->Ready);
+      if (ES_DeQueue(QUEUE_MEM(pCtx, HighestPrior), &ThisEvent) == 0)
       {
-        Ready &= BitNum2ClrMask[HighestPrior]; // mark queue as now empty
+        pCtx->Ready &= BitNum2ClrMask[HighestPrior]; // mark queue as now empty
       }
 #ifdef _INCLUDE_BASIC_FRAMEWORK_DEBUG_
       _HW_DebugSetLine1();
 #endif
-      if (ServDescList[HighestPrior].RunFunc(ThisEvent).EventType !=
-          ES_NO_EVENT)
+      if (ES_DispatchEvent(HighestPrior, ThisEvent).EventType != ES_NO_EVENT)
       {
         return FailedRun;
       }
 #ifdef _INCLUDE_BASIC_FRAMEWORK_DEBUG_
       _HW_DebugClearLine1();
 #endif
+      // the run time is charged by the ProcessPendingInts that follows
     }
 
 #ifdef _INCLUDE_BASIC_FRAMEWORK_DEBUG_
@@ -333,14 +555,51 @@ ES_Return_t ES_Run(void)
     // all the queues are empty, so look for new user detected events
     if (!ES_CheckUserEvents()) // no new user events
     {
+#ifdef ES_USE_CPU_LOAD
+      // a checker pass that found nothing counts as idle polling
+      ES_CPULoad_Charge(CPU_LOAD_IDLE);
+      // try moving bytes, if available, to UART
+      ES_CPULoad_Charge(Terminal_MoveBuffer2UART() ? CPU_LOAD_UART :
+          CPU_LOAD_IDLE);
+#else
       Terminal_MoveBuffer2UART(); // try moving bytes, if available, to UART
+#endif
     }
+#ifdef ES_USE_CPU_LOAD
+    else
+    {
+      ES_CPULoad_Charge(CPU_LOAD_CHECK);
+    }
+#endif
 #ifdef _INCLUDE_BASIC_FRAMEWORK_DEBUG_
     _HW_DebugClearLine2();
 #endif
   }
+#endif
 }
 
+#ifdef ES_MULTI_CONTEXT
+/****************************************************************************
+ Function
+   ES_SetContext
+ Parameters
+   ES_Context_t * : the context that this thread will run
+ Returns
+   nothing
+ Description
+   selects the framework context used from now on, by the calling thread.
+   Call it before ES_Initialize & ES_Run for each context.
+ Notes
+   threads that never call it use ES_DefaultContext
+ Author
+   karthi24, 10/18/26
+****************************************************************************/
+void ES_SetContext(ES_Context_t *pNewContext)
+{
+  ES_pCurrentContext = pNewContext;
+}
+
+#endif
 /****************************************************************************
  Function
    ES_PostAll
@@ -361,14 +620,10 @@ bool ES_PostAll(ES_Event_t ThisEvent)
   // loop through the list executing the post functions
   for (i = 0; i < ARRAY_SIZE(EventQueues); i++)
   {
-    if (ES_EnQueueFIFO(EventQueues[i].pMem, ThisEvent) != true)
+    if (ES_PostToService(i, ThisEvent) != true)
     {
       break; // this is a failed post
     }
-    else
-    {
-      Ready |= BitNum2SetMask[i]; // show queue as non-empty
-    }
   }
   if (i == ARRAY_SIZE(EventQueues))    // if no failures
   {
@@ -391,23 +646,91 @@ bool ES_PostAll(ES_Event_t ThisEvent)
  Description
    posts to one of the services' queues
  Notes
-   used by the timer library to associate a timer with a state machine
+   used by the timer library to associate a timer with a state machine.
+   Returns true without queueing anything if the service's event mask
+   filters the event out. Only a queued event sets LastQueued in the
+   context, which is how the periodic timers tell the two apart.
  Author
    J. Edward Carryer, 01/16/12,
 ****************************************************************************/
 bool ES_PostToService(uint8_t WhichService, ES_Event_t TheEvent)
 {
   if ((WhichService < ARRAY_SIZE(EventQueues)) &&
-      (ES_EnQueueFIFO(EventQueues[WhichService].pMem, TheEvent) ==
+      !ACCEPTS(WhichService, TheEvent.EventType))
+  {
+    CountFilterDrop(WhichService);
+    return true;  // not an error, the service just has no use for it
+  }
+#ifdef ES_THREADED_EXECUTOR
+  return ES_Executor_Post(WhichService, TheEvent, false);
+#else
+  ES_Context_t *pCtx = ES_CTX;
+
+  if ((WhichService < ARRAY_SIZE(EventQueues)) &&
+      (ES_EnQueueFIFO(QUEUE_MEM(pCtx, WhichService), TheEvent) ==
         true))
   {
-    Ready |= BitNum2SetMask[WhichService]; // show queue as non-empty
+    pCtx->Ready |= BitNum2SetMask[WhichService]; // show queue as non-empty
+    pCtx->LastQueued = WhichService;  // for the periodic timers
+#ifdef ES_QUEUE_STATS
+    ES_QueueStats_RecordPost(WhichService,
+        ES_GetNumEntries(QUEUE_MEM(pCtx, WhichService)));
+#endif
     return true;
   }
   else
   {
+#ifdef ES_QUEUE_STATS
+    ES_QueueStats_RecordPost(WhichService, 0);  // the queue was full
+#endif
     return false;
   }
+#endif
+}
+
+/****************************************************************************
+ Function
+   ES_PostToInstance
+ Parameters
+   void * : the context of the service instance to post to
+   ES_Event : The Event to be posted
+ Returns
+   boolean : False if the post function failed during execution
+ Description
+   posts to the queue of one instance of a multi-instance service
+ Notes
+   the context must start with an ES_Instance_t, which ES_Initialize fills
+   in with the priority of that instance
+ Author
+   karthi24, 10/18/26
+****************************************************************************/
+bool ES_PostToInstance(void *pContext, ES_Event_t TheEvent)
+{
+  return ES_PostToService(((ES_Instance_t *)pContext)->Priority, TheEvent);
+}
+
+/****************************************************************************
+ Function
+   ES_GetServiceContext
+ Parameters
+   uint8_t : Which service (index into ServDescList)
+ Returns
+   void * : the instance of that service in the current framework context,
+            NULL for a plain service or before ES_Initialize
+ Description
+   lets a multi-instance service find its instance from code that isn't
+   handed one, such as its post function and the functions that other
+   services call
+ Author
+   karthi24, 10/18/26
+****************************************************************************/
+void *ES_GetServiceContext(uint8_t WhichService)
+{
+  if (WhichService >= ARRAY_SIZE(EventQueues))
+  {
+    return (void *)0;
+  }
+  return ES_CTX->pServiceContext[WhichService];
 }
 
 /****************************************************************************
@@ -428,21 +751,269 @@ bool ES_PostToService(uint8_t WhichService, ES_Event_t TheEvent)
 bool ES_PostToServiceLIFO(uint8_t WhichService, ES_Event_t TheEvent)
 {
   if ((WhichService < ARRAY_SIZE(EventQueues)) &&
-      (ES_EnQueueLIFO(EventQueues[WhichService].pMem, TheEvent) ==
+      !ACCEPTS(WhichService, TheEvent.EventType))
+  {
+    CountFilterDrop(WhichService);
+    return true;  // not an error, the service just has no use for it
+  }
+#ifdef ES_THREADED_EXECUTOR
+  return ES_Executor_Post(WhichService, TheEvent, true);
+#else
+  ES_Context_t *pCtx = ES_CTX;
+
+  if ((WhichService < ARRAY_SIZE(EventQueues)) &&
+      (ES_EnQueueLIFO(QUEUE_MEM(pCtx, WhichService), TheEvent) ==
         true))
   {
-    Ready |= BitNum2SetMask[WhichService]; // show queue as non-empty
+    pCtx->Ready |= BitNum2SetMask[WhichService]; // show queue as non-empty
+#ifdef ES_QUEUE_STATS
+    ES_QueueStats_RecordPost(WhichService,
+        ES_GetNumEntries(QUEUE_MEM(pCtx, WhichService)));
+#endif
+    return true;
+  }
+  else
+  {
+#ifdef ES_QUEUE_STATS
+    ES_QueueStats_RecordPost(WhichService, 0);  // the queue was full
+#endif
+    return false;
+  }
+#endif
+}
+
+/****************************************************************************
+ Function
+   ES_GetFilterDrops
+ Parameters
+   uint8_t : Which service (index into ServDescList)
+ Returns
+   uint16_t : how many posts to the service were dropped by its event mask
+ Description
+   lets a service or test harness see how much its SERV_n_EVENT_MASK saves
+ Notes
+   the count sticks at 0xFFFF
+ Author
+   karthi24, 10/18/26
+****************************************************************************/
+uint16_t ES_GetFilterDrops(uint8_t WhichService)
+{
+  uint16_t Drops;
+
+  if (WhichService >= ARRAY_SIZE(EventQueues))
+  {
+    return 0;
+  }
+  COUNT_LOCK();
+  Drops = ES_CTX->FilterDrops[WhichService];
+  COUNT_UNLOCK();
+  return Drops;
+}
+
+/****************************************************************************
+ Function
+   ES_CountQueued
+ Parameters
+   uint8_t : Which service's queue to look in (index into ServDescList)
+   ES_Event : The Event to look for
+ Returns
+   uint8_t : how many events with the same type & param are in the queue
+ Description
+   used by the periodic timers, right after their timeout has been queued,
+   to find how many events like it the service will run up to and
+   including the timeout
+ Notes
+   With the threaded executor, the queue belongs to the service's worker
+   and the timeout has only got as far as a ring, so just the timeout is
+   counted. An event like it that is already in the queue then lets the
+   timer post again before its timeout has been run, and that overrun is
+   missed.
+ Author
+   karthi24, 10/18/26
+****************************************************************************/
+uint8_t ES_CountQueued(uint8_t WhichService, ES_Event_t ThisEvent)
+{
+  if (WhichService >= ARRAY_SIZE(EventQueues))
+  {
+    return 0;
+  }
+#ifdef ES_THREADED_EXECUTOR
+  (void)ThisEvent;
+  return 1;
+#else
+  return ES_CountMatches(QUEUE_MEM(ES_CTX, WhichService), ThisEvent);
+#endif
+}
+
+/****************************************************************************
+ Function
+   ES_SpliceToService
+ Parameters
+   uint8_t : Which service to post to (index into ServDescList)
+   ES_Event * pBlock : the queue whose events are to be moved
+ Returns
+   boolean : False if the service's queue did not have room for them all
+ Description
+   moves all of the events in pBlock to the front of a service's queue, in
+   one step and in the order that they would have come out of pBlock
+ Notes
+   used by the Defer/Recall event capability. Nothing is moved on failure.
+   The events are not checked against the service's SERV_n_EVENT_MASK: they
+   were accepted when they were first posted to the service that deferred
+   them, so recall them to that same service. Each event moved is recorded
+   in ES_QueueStats as a post, at the depth it would have had if the events
+   had been posted one at a time, so the queue size advice covers recalls.
+ Author
+   karthi24, 10/18/26
+****************************************************************************/
+bool ES_SpliceToService(uint8_t WhichService, ES_Event_t *pBlock)
+{
+#ifdef ES_THREADED_EXECUTOR
+  return ES_Executor_Splice(WhichService, pBlock);
+#else
+  ES_Context_t  *pCtx = ES_CTX;
+#ifdef ES_QUEUE_STATS
+  uint8_t       NumToMove = ES_GetNumEntries(pBlock);
+  uint8_t       Depth;
+#endif
+
+  if (WhichService >= ARRAY_SIZE(EventQueues))
+  {
+    return false;
+  }
+#ifdef ES_QUEUE_STATS
+  Depth = ES_GetNumEntries(QUEUE_MEM(pCtx, WhichService));
+#endif
+  if (ES_SpliceQueueFront(QUEUE_MEM(pCtx, WhichService), pBlock) == true)
+  {
+    if (!ES_IsQueueEmpty(QUEUE_MEM(pCtx, WhichService)))
+    {
+      pCtx->Ready |= BitNum2SetMask[WhichService]; // show queue as non-empty
+    }
+#ifdef ES_QUEUE_STATS
+    while (NumToMove-- > 0)
+    {
+      ES_QueueStats_RecordPost(WhichService, ++Depth);
+    }
+#endif
     return true;
   }
   else
   {
+#ifdef ES_QUEUE_STATS
+    while (NumToMove-- > 0)
+    {
+      ES_QueueStats_RecordPost(WhichService, 0);  // the queue was full
+    }
+#endif
     return false;
   }
+#endif
+}
+
+/****************************************************************************
+ Function
+   ES_DispatchEvent
+ Parameters
+   uint8_t : Which service to run
+   ES_Event_t : The Event for it to process
+ Returns
+   ES_Event_t : whatever the run function returned
+ Description
+   calls the run function of a service, passing the instance context to
+   the instances of multi-instance services
+ Notes
+   used by ES_Run and the threaded executor. Every event is offered to the
+   timer module on the way through, so periodic timers can spot overruns.
+ Author
+   karthi24, 10/18/26
+****************************************************************************/
+ES_Event_t ES_DispatchEvent(uint8_t WhichService, ES_Event_t ThisEvent)
+{
+  ES_Timer_EventDelivered(WhichService, ThisEvent);
+  if (ServDescList[WhichService].pContext == (void *)0)
+  {
+    return ServDescList[WhichService].RunFunc(ThisEvent);
+  }
+  return ServDescList[WhichService].InstRunFunc(
+      ES_CTX->pServiceContext[WhichService], ThisEvent);
 }
 
+#ifdef ES_THREADED_EXECUTOR
+/****************************************************************************
+ Function
+   ES_GetQueueMem
+ Parameters
+   uint8_t : Which service
+ Returns
+   ES_Event_t * : the service's queue in the current context
+ Description
+   lets the threaded executor work on the service queues directly
+ Author
+   karthi24, 10/18/26
+****************************************************************************/
+ES_Event_t *ES_GetQueueMem(uint8_t WhichService)
+{
+  return QUEUE_MEM(ES_CTX, WhichService);
+}
+
+#endif
 //*********************************
 // private functions
 //*********************************
+/****************************************************************************
+ Function
+   CountFilterDrop
+ Parameters
+   uint8_t : Which service dropped a post
+ Returns
+   nothing
+ Description
+   bumps the service's filter drop count, stopping at the top
+ Author
+   karthi24, 10/18/26
+****************************************************************************/
+static void CountFilterDrop(uint8_t WhichService)
+{
+  COUNT_LOCK();
+  if (ES_CTX->FilterDrops[WhichService] != 0xFFFF)
+  {
+    ES_CTX->FilterDrops[WhichService]++;
+  }
+  COUNT_UNLOCK();
+}
+
+/****************************************************************************
+ Function
+   ProcessPendingInts
+ Parameters
+   None
+ Returns
+   bool : always true, from _HW_Process_Pending_Ints
+ Description
+   processes the pending timer ticks, then charges the time since the last
+   CPU load charge to CPU_LOAD_RUN
+ Notes
+   The timer responses and callbacks run here. Without the charge here, the
+   time they took on a pass with empty queues would be charged to IDLE or
+   CHECK. The charge also covers the run function that ES_Run dispatched
+   just before.
+ Author
+   karthi24, 10/18/26
+****************************************************************************/
+#ifndef ES_THREADED_EXECUTOR
+static bool ProcessPendingInts(void)
+{
+  bool ReturnVal = _HW_Process_Pending_Ints();
+
+#ifdef ES_USE_CPU_LOAD
+  ES_CPULoad_Charge(CPU_LOAD_RUN);
+#endif
+  return ReturnVal;
+}
+
+#endif
+
 #if 0
 /****************************************************************************
  Function
@@ -473,5 +1044,528 @@ static bool CheckSystemEvents(void)
 }
 
 #endif
+#ifdef TEST
+/****************************************************************************
+ Host test. Runs two contexts at the same time, each on its own thread,
+ with stand-ins for the configured services that log which context ran
+ each key event. The game services' stand-ins are instances, and each
+ context is given its own set. Each context's keys must be run in that
+ context only, by its own instances, in priority & FIFO order, round after
+ round while the other thread does the same. ES_Run is stopped, with a stop
+ event, once the context's queues have emptied.
+ Then a periodic timer posts to MotorCtrl's stand-in, first an event its
+ mask filters out, then one that another source has already queued.
+ Link with ES_Queue.c, ES_LookupTables.c & ES_Timers.c, all built with
+ -DES_MULTI_CONTEXT -DES_THREAD_LOCAL=__thread, and with -pthread.
+ ****************************************************************************/
+#ifndef ES_MULTI_CONTEXT
+#error the context test needs ES_MULTI_CONTEXT
+#endif
+
+#include <stdlib.h>
+#include <pthread.h>
+
+#define STOP_PARAM 0xFFFF
+#define LOG_SIZE 16
+#define NUM_ROUNDS 100000
+// MotorCtrl's slot, it takes ES_BALLOON_FRAME but not ES_TIMEOUT
+#define TIMER_SERVICE 3
+#define TIMER_PERIOD 2
+
+typedef struct
+{
+  ES_Context_t  *pCtx;
+  uint8_t       Service;
+  uint16_t      Param;
+}LogEntry_t;
+
+// the context for a stand-in instance
+typedef struct
+{
+  ES_Instance_t Base;
+  ES_Context_t  *pOwner;    // the context that it was given to
+  uint32_t      NumKeys;    // keys that it has run
+}TestInstance_t;
+
+// what one thread runs, and what it found
+typedef struct
+{
+  ES_Context_t    *pCtx;
+  TestInstance_t  *pInstances;
+  const uint16_t  *pPosted;     // keys in the order that they are posted
+  const uint16_t  *pExpected;   // the same keys, in the order to be run
+  uint8_t         NumExpected;
+  uint16_t        NumErrors;
+}TestThread_t;
+
+static ES_Context_t   ContextA;
+static ES_Context_t   ContextB;
+static TestInstance_t InstancesA[NUM_SERVICES];
+static TestInstance_t InstancesB[NUM_SERVICES];
+static pthread_barrier_t StartLine;
+
+// each thread runs one context, so what it logs is kept per thread
+static ES_THREAD_LOCAL LogEntry_t Log[LOG_SIZE];
+static ES_THREAD_LOCAL uint8_t    NumLogged;
+static ES_THREAD_LOCAL uint8_t    NumInits;
+static ES_THREAD_LOCAL uint8_t    NumInitsRun;
+static ES_THREAD_LOCAL uint8_t    NumIdlePasses;
+static ES_THREAD_LOCAL uint16_t   NumErrors;
+
+// the instances named in SERV_n_CONTEXT. Every context here is given its own
+// stand-in instances, so these are only there to be named.
+GameSM_t      GameSMInstance;
+MotorCtrl_t   MotorCtrlInstance;
+LEDService_t  LEDServiceInstance;
+
+// the rest of the framework and the port, as far as ES_Initialize, ES_Run
+// & the timers go. The tests tick the timers themselves.
+void _HW_Timer_Init(const TimerRate_t Rate)
+{
+  (void)Rate;
+}
+
+uint16_t _HW_GetTickCount(void)
+{
+  return 0;
+}
+
+uint64_t _HW_GetTickCount64(void)
+{
+  return 0;
+}
+
+#ifndef _CP0_GET_COUNT
+// the core timer count, a function here rather than a macro
+uint32_t _CP0_GET_COUNT(void)
+{
+  return 0;
+}
+
+#endif
+
+uint64_t _HW_GetCoreCount64(void)
+{
+  return 0;
+}
+
+bool _HW_Process_Pending_Ints(void)
+{
+  return true;
+}
+
+// each context is only touched by its own thread, so there is nothing here
+// for a critical region to keep out
+void _HW_EnterCritical(void)
+{
+}
+
+void _HW_ExitCritical(void)
+{
+}
+
+bool Terminal_MoveBuffer2UART(void)
+{
+  return false;
+}
+
+#ifdef ES_USE_CPU_LOAD
+void ES_CPULoad_Init(void)
+{
+}
+
+void ES_CPULoad_Charge(ES_CPULoadBucket_t Bucket)
+{
+  (void)Bucket;
+}
+
+#endif
+
+// called once all of the queues are empty, so stop the run. A stop event
+// that never reaches the running context would leave ES_Run spinning here.
+bool ES_CheckUserEvents(void)
+{
+  ES_Event_t StopEvent = { ES_NEW_KEY, STOP_PARAM };
+
+  if (++NumIdlePasses > 10)
+  {
+    printf("ES_Run never saw its stop event\n");
+    exit(1);
+  }
+  return ES_PostToService(1, StopEvent);
+}
+
+static ES_Event_t TestRun(uint8_t Service, ES_Event_t ThisEvent)
+{
+  ES_Event_t ReturnEvent = { ES_NO_EVENT, 0 };
+
+  if (ThisEvent.EventType == ES_INIT)
+  {
+    NumInitsRun++;
+  }
+  else if (ThisEvent.EventParam == STOP_PARAM)
+  {
+    ReturnEvent.EventType = ES_ERROR;
+  }
+  else if (NumLogged < LOG_SIZE)
+  {
+    Log[NumLogged].pCtx = ES_CTX;
+    Log[NumLogged].Service = Service;
+    Log[NumLogged].Param = ThisEvent.EventParam;
+    NumLogged++;
+  }
+  return ReturnEvent;
+}
+
+// an instance must only ever be run for the context that it was given to
+static ES_Event_t TestInstanceRun(void *pContext, uint8_t Service,
+    ES_Event_t ThisEvent)
+{
+  TestInstance_t *pThis = (TestInstance_t *)pContext;
+
+  if ((pThis->pOwner != ES_CTX) || (pThis->Base.Priority != Service) ||
+      (ES_GetServiceContext(Service) != pContext))
+  {
+    printf("service %u ran an instance that isn't its own\n", Service);
+    NumErrors++;
+  }
+  else if ((ThisEvent.EventType == ES_NEW_KEY) &&
+      (ThisEvent.EventParam != STOP_PARAM))
+  {
+    pThis->NumKeys++;
+  }
+  return TestRun(Service, ThisEvent);
+}
+
+// the timers' response functions, posting to the stand-ins below
+bool PostGameSM(ES_Event_t ThisEvent)
+{
+  return ES_PostToService(2, ThisEvent);
+}
+
+bool PostMotorCtrl(ES_Event_t ThisEvent)
+{
+  return ES_PostToService(TIMER_SERVICE, ThisEvent);
+}
+
+bool PostTestHarnessService0(ES_Event_t ThisEvent)
+{
+  return ES_PostToService(1, ThisEvent);
+}
+
+// stand-ins for the configured services, under their configured names
+#define TEST_SERVICE(Init, Run, Service)                  \
+  bool Init(uint8_t Priority)                             \
+  {                                                       \
+    ES_Event_t InitEvent = { ES_INIT, 0 };                \
+    NumInits++;                                           \
+    return ES_PostToService(Priority, InitEvent);         \
+  }                                                       \
+  ES_Event_t Run(ES_Event_t ThisEvent)                    \
+  {                                                       \
+    return TestRun(Service, ThisEvent);                   \
+  }
+
+// and for the ones registered as instances with SERV_n_CONTEXT
+#define TEST_INSTANCE_SERVICE(Init, Run, Service)         \
+  bool Init(void *pContext, uint8_t Priority)             \
+  {                                                       \
+    ES_Event_t InitEvent = { ES_INIT, 0 };                \
+    NumInits++;                                           \
+    return ES_PostToInstance(pContext, InitEvent) &&      \
+           (Priority == Service);                         \
+  }                                                       \
+  ES_Event_t Run(void *pContext, ES_Event_t ThisEvent)    \
+  {                                                       \
+    return TestInstanceRun(pContext, Service, ThisEvent); \
+  }
+
+#ifdef SERV_0_CONTEXT
+TEST_INSTANCE_SERVICE(SERV_0_INIT, SERV_0_RUN, 0)
+#else
+TEST_SERVICE(SERV_0_INIT, SERV_0_RUN, 0)
+#endif
+#if NUM_SERVICES > 1
+#ifdef SERV_1_CONTEXT
+TEST_INSTANCE_SERVICE(SERV_1_INIT, SERV_1_RUN, 1)
+#else
+TEST_SERVICE(SERV_1_INIT, SERV_1_RUN, 1)
+#endif
+#endif
+#if NUM_SERVICES > 2
+#ifdef SERV_2_CONTEXT
+TEST_INSTANCE_SERVICE(SERV_2_INIT, SERV_2_RUN, 2)
+#else
+TEST_SERVICE(SERV_2_INIT, SERV_2_RUN, 2)
+#endif
+#endif
+#if NUM_SERVICES > 3
+#ifdef SERV_3_CONTEXT
+TEST_INSTANCE_SERVICE(SERV_3_INIT, SERV_3_RUN, 3)
+#else
+TEST_SERVICE(SERV_3_INIT, SERV_3_RUN, 3)
+#endif
+#endif
+#if NUM_SERVICES > 4
+#ifdef SERV_4_CONTEXT
+TEST_INSTANCE_SERVICE(SERV_4_INIT, SERV_4_RUN, 4)
+#else
+TEST_SERVICE(SERV_4_INIT, SERV_4_RUN, 4)
+#endif
+#endif
+#if NUM_SERVICES > 5
+#error the context test only stands in for 5 services
+#endif
+
+// keys are 0xCSN, for context C, service S & the Nth key to S. Posted in
+// the order given, to the service in the key.
+static void PostKeys(const uint16_t *pKeys, uint8_t NumKeys)
+{
+  ES_Event_t  KeyEvent = { ES_NEW_KEY, 0 };
+  uint8_t     i;
+
+  for (i = 0; i < NumKeys; i++)
+  {
+    KeyEvent.EventParam = pKeys[i];
+    if (ES_PostToService((pKeys[i] >> 4) & 0x0F, KeyEvent) != true)
+    {
+      printf("post of %X failed\n", pKeys[i]);
+      NumErrors++;
+    }
+  }
+}
+
+// runs the current context, then checks that it ran just its own keys, in
+// order
+static void RunContext(const uint16_t *pExpected, uint8_t NumExpected,
+    uint8_t NumExpectedInits)
+{
+  ES_Context_t  *pCtx = ES_CTX;
+  uint8_t       i;
+
+  NumLogged = 0;
+  NumInitsRun = 0;
+  NumIdlePasses = 0;
+  if (ES_Run() != FailedRun)
+  {
+    printf("ES_Run didn't stop\n");
+    NumErrors++;
+  }
+  if (NumInitsRun != NumExpectedInits)
+  {
+    printf("%u of %u ES_INITs run\n", NumInitsRun, NumExpectedInits);
+    NumErrors++;
+  }
+  if (NumLogged != NumExpected)
+  {
+    printf("%u keys run, not %u\n", NumLogged, NumExpected);
+    NumErrors++;
+    return;
+  }
+  for (i = 0; i < NumLogged; i++)
+  {
+    if ((Log[i].pCtx != pCtx) || (Log[i].Param != pExpected[i]) ||
+        (Log[i].Service != ((pExpected[i] >> 4) & 0x0F)))
+    {
+      printf("key %u was %X on service %u%s, not %X\n", i, Log[i].Param,
+          Log[i].Service, (Log[i].pCtx != pCtx) ? " in the wrong context" :
+          "", pExpected[i]);
+      NumErrors++;
+    }
+  }
+}
+
+// one thread: sets up its context with its own instances, then runs round
+// after round of keys in it, alongside the other thread
+static void *RunThread(void *pArg)
+{
+  TestThread_t  *pThread = (TestThread_t *)pArg;
+  uint16_t      AllReady = (uint16_t)((1U << NUM_SERVICES) - 1);
+  uint32_t      Round;
+  uint8_t       i;
+
+  ES_SetContext(pThread->pCtx);
+  for (i = 0; i < NUM_SERVICES; i++)
+  {
+    pThread->pInstances[i].pOwner = pThread->pCtx;
+    if (ServDescList[i].pContext != (void *)0)
+    {
+      pThread->pCtx->pServiceContext[i] = &pThread->pInstances[i];
+    }
+  }
+  pthread_barrier_wait(&StartLine);
+  if (ES_Initialize(ES_Timer_RATE_1mS) != Success)
+  {
+    printf("context %p didn't initialize\n", (void *)pThread->pCtx);
+    NumErrors++;
+  }
+  if ((NumInits != NUM_SERVICES) || (ES_CTX->Ready != AllReady))
+  {
+    printf("%u init calls, Ready %X\n", NumInits, ES_CTX->Ready);
+    NumErrors++;
+  }
+  for (Round = 0; (Round < NUM_ROUNDS) && (NumErrors == 0); Round++)
+  {
+    PostKeys(pThread->pPosted, pThread->NumExpected);
+    RunContext(pThread->pExpected, pThread->NumExpected,
+        (Round == 0) ? NUM_SERVICES : 0);
+  }
+  pThread->NumErrors = NumErrors;
+  return NULL;
+}
+
+// the keys that each instance of a thread's context ran, for all the rounds
+static void CheckInstanceKeys(TestThread_t *pThread)
+{
+  uint32_t  Expected;
+  uint8_t   i;
+  uint8_t   j;
+
+  for (i = 0; i < NUM_SERVICES; i++)
+  {
+    if (ServDescList[i].pContext == (void *)0)
+    {
+      continue;
+    }
+    Expected = 0;
+    for (j = 0; j < pThread->NumExpected; j++)
+    {
+      if (((pThread->pExpected[j] >> 4) & 0x0F) == i)
+      {
+        Expected += NUM_ROUNDS;
+      }
+    }
+    if (pThread->pInstances[i].NumKeys != Expected)
+    {
+      printf("instance %u of context %p ran %u keys, not %u\n", i,
+          (void *)pThread->pCtx, (unsigned)pThread->pInstances[i].NumKeys,
+          (unsigned)Expected);
+      NumErrors++;
+    }
+  }
+}
+
+static void TickPeriod(void)
+{
+  uint8_t i;
+
+  for (i = 0; i < TIMER_PERIOD; i++)
+  {
+    ES_Timer_Tick_Resp();
+  }
+}
+
+static void CheckOverruns(uint16_t Expected, const char *pWhen)
+{
+  uint16_t Overruns = ES_Timer_GetOverruns(TID_BALLOON_UPDATE);
+
+  if (Overruns != Expected)
+  {
+    printf("%u overruns, not %u, %s\n", Overruns, Expected, pWhen);
+    NumErrors++;
+  }
+}
+
+// runs the current context until its queues are empty
+static void RunAll(void)
+{
+  NumIdlePasses = 0;
+  ES_Run();
+  NumLogged = 0;
+}
+
+// a periodic timer must only wait for a timeout that was queued, and only
+// the run of that timeout may let it post the next one
+static void CheckPeriodicTimer(void)
+{
+  ES_Event_t  Masked  = { ES_TIMEOUT, TID_BALLOON_UPDATE };
+  ES_Event_t  Frame   = { ES_BALLOON_FRAME, 0x77 };
+  ES_Event_t  ThisEvent;
+  uint16_t    Drops;
+  uint8_t     i;
+
+  ES_SetContext(&ContextA);
+  Drops = ES_GetFilterDrops(TIMER_SERVICE);
+  ES_Timer_SetEvent(TID_BALLOON_UPDATE, Masked);
+  ES_Timer_InitPeriodic(TID_BALLOON_UPDATE, TIMER_PERIOD);
+  for (i = 0; i < 5; i++)
+  {
+    TickPeriod();
+  }
+  CheckOverruns(0, "with every timeout filtered out");
+  if (ES_GetFilterDrops(TIMER_SERVICE) - Drops != 5)
+  {
+    printf("%u of 5 timeouts filtered out\n",
+        ES_GetFilterDrops(TIMER_SERVICE) - Drops);
+    NumErrors++;
+  }
+
+  // the same event as the timeout, queued ahead of it by someone else
+  ES_Timer_SetEvent(TID_BALLOON_UPDATE, Frame);
+  ES_Timer_InitPeriodic(TID_BALLOON_UPDATE, TIMER_PERIOD);
+  ES_PostToService(TIMER_SERVICE, Frame);
+  TickPeriod();
+  // run just the first one, the timeout is still waiting behind it
+  ES_DeQueue(QUEUE_MEM(ES_CTX, TIMER_SERVICE), &ThisEvent);
+  ES_DispatchEvent(TIMER_SERVICE, ThisEvent);
+  TickPeriod();
+  CheckOverruns(1, "with the timeout still queued");
+  RunAll();
+  TickPeriod();
+  CheckOverruns(1, "after the timeout was run");
+  if (ES_GetNumEntries(QUEUE_MEM(ES_CTX, TIMER_SERVICE)) != 1)
+  {
+    printf("the timeout after the run wasn't posted\n");
+    NumErrors++;
+  }
+  ES_Timer_StopTimer(TID_BALLOON_UPDATE);
+  RunAll();
+}
+
+int main(void)
+{
+  // to services 1 & 2, which take ES_NEW_KEY. Service 2 runs first.
+  static const uint16_t PostA[] = { 0xA20, 0xA10, 0xA21 };
+  static const uint16_t ExpectA[] = { 0xA20, 0xA21, 0xA10 };
+  static const uint16_t PostB[] = { 0xB10, 0xB20 };
+  static const uint16_t ExpectB[] = { 0xB20, 0xB10 };
+  TestThread_t  Threads[2] =
+  {
+    { &ContextA, InstancesA, PostA, ExpectA, ARRAY_SIZE(ExpectA), 0 },
+    { &ContextB, InstancesB, PostB, ExpectB, ARRAY_SIZE(ExpectB), 0 }
+  };
+  pthread_t     Ids[2];
+  uint8_t       i;
+
+  pthread_barrier_init(&StartLine, NULL, 2);
+  for (i = 0; i < 2; i++)
+  {
+    if (pthread_create(&Ids[i], NULL, RunThread, &Threads[i]) != 0)
+    {
+      printf("couldn't start a thread\n");
+      return 1;
+    }
+  }
+  for (i = 0; i < 2; i++)
+  {
+    pthread_join(Ids[i], NULL);
+    NumErrors += Threads[i].NumErrors;
+    CheckInstanceKeys(&Threads[i]);
+  }
+  // the threads' contexts must not have become this thread's
+  if ((ES_CTX != &ES_DefaultContext) || (ES_DefaultContext.Ready != 0) ||
+      (ContextA.Ready != 0) || (ContextB.Ready != 0))
+  {
+    printf("Ready A %X B %X default %X after the runs\n", ContextA.Ready,
+        ContextB.Ready, ES_DefaultContext.Ready);
+    NumErrors++;
+  }
+  CheckPeriodicTimer();
+
+  printf("%u errors\n", NumErrors);
+  return NumErrors != 0;
+}
+
+#endif /* TEST */
 /*------------------------------- Footnotes -------------------------------*/
 /*------------------------------ End of file ------------------------------*/
@@ -0,0 +1,398 @@
+/****************************************************************************
+ Module
+     ES_HostPort.c
+
+ Description
+     The hardware specific functions of the framework for a host (PC) build,
+     in place of ES_Port.c. Selected by defining ES_HOST_PORT on the command
+     line, which also tells ES_Port.h to leave out the PIC32 headers.
+
+ Notes
+     The core count comes from the host's monotonic clock, scaled to the
+     20MHz of the PIC32 core timer, so CORE_TICKS_PER_SEC and everything
+     measured in core counts mean the same on both.
+
+     There are no interrupts. _HW_Process_Pending_Ints works out how many
+     ticks of the rate given to _HW_Timer_Init have gone by since it last ran
+     and runs the timers for each of them. The tick state is kept per thread,
+     so threads running contexts of their own (ES_MULTI_CONTEXT) each tick
+     their own context.
+
+     Critical regions are a recursive mutex. They keep the threads of the
+     threaded executor (see ES_Executor.c) away from each other, where the
+     PIC32 keeps the interrupts away from the main loop.
+
+     Output goes straight to stdout, so there is no UART buffer to move.
+     ES_PostFromISR is not provided, as there are no interrupts to call it.
+
+     Build with -pthread, e.g. for the executor's test:
+       F="-std=gnu99 -DES_HOST_PORT -DES_THREADED_EXECUTOR -pthread
+          -IFrameworkHeaders -IProjectHeaders
+          -Iworking_hals_libraries_and_fontstuff"
+     (see ES_Executor.c)
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/18/26       karthi24     started coding
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Port.h"
+#include "ES_Types.h"
+#include "ES_Framework.h"
+#include "ES_Timers.h"
+#include "ES_Context.h"
+#include "ES_Executor.h"
+#include "terminal.h"
+
+#ifdef ES_HOST_PORT
+
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+/*----------------------------- Module Defines ----------------------------*/
+#define NS_PER_SEC 1000000000UL
+#define NS_PER_CORE_TICK (NS_PER_SEC / CORE_TICKS_PER_SEC)
+
+// the tick counts live in the framework context, as they do in ES_Port.c
+#define SysTickCounter (ES_CTX->SysTickCounter)
+#define SysTickHigh (ES_CTX->SysTickHigh)
+
+/*------------------------------ Module Types -----------------------------*/
+#ifdef ES_THREADED_EXECUTOR
+// what a new worker thread is to run
+typedef struct
+{
+  WorkerFunc_t  *pWorker;
+  uint8_t       WhichWorker;
+}WorkerStart_t;
+#endif
+
+/*---------------------------- Module Functions ---------------------------*/
+static void InitCriticalLock(void);
+#ifdef ES_THREADED_EXECUTOR
+static void *WorkerThread(void *pArg);
+#endif
+
+/*---------------------------- Module Variables ---------------------------*/
+// the critical region lock, made on first use
+static pthread_mutex_t  CriticalLock;
+static pthread_once_t   CriticalLockOnce = PTHREAD_ONCE_INIT;
+
+// the tick rate in core counts, 0 when the timers are off, and the core
+// count at which the next tick is due, for the context this thread runs
+static ES_THREAD_LOCAL uint32_t TickPeriod;
+static ES_THREAD_LOCAL uint64_t NextTick;
+
+#ifdef ES_THREADED_EXECUTOR
+static WorkerStart_t WorkerStarts[NUM_WORKERS];
+#endif
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     _HW_EnterCritical
+ Parameters
+     none
+ Returns
+     none
+ Description
+     enters a critical region, waiting until no other thread is in one
+ Notes
+     critical regions nest, as they do on the PIC32
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+void _HW_EnterCritical(void)
+{
+  pthread_once(&CriticalLockOnce, InitCriticalLock);
+  pthread_mutex_lock(&CriticalLock);
+}
+
+/****************************************************************************
+ Function
+     _HW_ExitCritical
+ Parameters
+     none
+ Returns
+     none
+ Description
+     leaves the critical region entered by the matching _HW_EnterCritical
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+void _HW_ExitCritical(void)
+{
+  pthread_mutex_unlock(&CriticalLock);
+}
+
+/****************************************************************************
+ Function
+     _HW_Timer_Init
+ Parameters
+     const TimerRate_t Rate : the tick period, in core counts
+ Returns
+     none
+ Description
+     starts the ticks for the calling thread's context, the first one a
+     whole period from now
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+void _HW_Timer_Init(const TimerRate_t Rate)
+{
+  TickPeriod  = Rate;
+  NextTick    = _HW_GetCoreCount64() + Rate;
+}
+
+/****************************************************************************
+ Function
+     _HW_Process_Pending_Ints
+ Parameters
+     none
+ Returns
+     always true, for the loop test in ES_Run
+ Description
+     runs the timers once for each tick that has gone by since the last call
+ Notes
+     The ticks are counted and run in one critical region, as they would be
+     by the tick interrupt, so ES_Timer_StartAt always sees them together.
+     A thread that falls behind catches up with every tick that it missed.
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+bool _HW_Process_Pending_Ints(void)
+{
+  uint64_t Now;
+
+  if (TickPeriod == 0)
+  {
+    return true;    // the timers are off
+  }
+  Now = _HW_GetCoreCount64();
+  EnterCritical();
+  while (Now >= NextTick)
+  {
+    NextTick += TickPeriod;
+    if (++SysTickCounter == 0)
+    {
+      SysTickHigh++;
+    }
+    ES_Timer_Tick_Resp();
+  }
+  ExitCritical();
+  return true;
+}
+
+/****************************************************************************
+ Function
+     _HW_GetTickCount
+ Parameters
+     none
+ Returns
+     uint16_t the number of ticks that have been run
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+uint16_t _HW_GetTickCount(void)
+{
+  return (uint16_t)_HW_GetTickCount64();
+}
+
+/****************************************************************************
+ Function
+     _HW_GetTickCount64
+ Parameters
+     none
+ Returns
+     uint64_t the number of ticks that have been run, never wraps
+ Notes
+     read in a critical region, as the ES_Run thread may be ticking
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+uint64_t _HW_GetTickCount64(void)
+{
+  uint64_t Count;
+
+  EnterCritical();
+  Count = ((uint64_t)SysTickHigh << 32) | SysTickCounter;
+  ExitCritical();
+  return Count;
+}
+
+/****************************************************************************
+ Function
+     _HW_GetCoreCount64
+ Parameters
+     none
+ Returns
+     uint64_t the host's monotonic clock, in 20MHz core counts
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+uint64_t _HW_GetCoreCount64(void)
+{
+  struct timespec Now;
+
+  clock_gettime(CLOCK_MONOTONIC, &Now);
+  return ((uint64_t)Now.tv_sec * CORE_TICKS_PER_SEC) +
+         ((uint64_t)Now.tv_nsec / NS_PER_CORE_TICK);
+}
+
+/****************************************************************************
+ Function
+     _HW_TakeDirtySources
+ Parameters
+     none
+ Returns
+     uint8_t every source marked as changed
+ Description
+     there are no hardware flags to gate the event checkers with, so every
+     checker runs on every pass
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+uint8_t _HW_TakeDirtySources(void)
+{
+  return 0xFF;
+}
+
+/****************************************************************************
+ Function
+     _HW_ConsoleInit
+ Parameters
+     none
+ Returns
+     none
+ Description
+     nothing to do, the console is stdout
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+void _HW_ConsoleInit(void)
+{
+}
+
+/****************************************************************************
+ Function
+     Terminal_MoveBuffer2UART
+ Parameters
+     none
+ Returns
+     bool always false, there is never anything waiting to go out
+ Description
+     printf writes straight to stdout on the host
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+bool Terminal_MoveBuffer2UART(void)
+{
+  return false;
+}
+
+#ifdef ES_THREADED_EXECUTOR
+/****************************************************************************
+ Function
+     _HW_StartWorker
+ Parameters
+     WorkerFunc_t *pWorker : the function for the thread to run
+     uint8_t WhichWorker : the worker number to pass to it
+ Returns
+     bool false if there is no such worker or the thread couldn't be made
+ Description
+     starts a detached thread running pWorker(WhichWorker)
+ Notes
+     the executor waits for its workers to stop before ES_Run returns, so
+     nothing needs to join them
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+bool _HW_StartWorker(WorkerFunc_t *pWorker, uint8_t WhichWorker)
+{
+  pthread_t       Thread;
+  pthread_attr_t  Attributes;
+  int             Result;
+
+  if (WhichWorker >= NUM_WORKERS)
+  {
+    return false;
+  }
+  WorkerStarts[WhichWorker].pWorker     = pWorker;
+  WorkerStarts[WhichWorker].WhichWorker = WhichWorker;
+  pthread_attr_init(&Attributes);
+  pthread_attr_setdetachstate(&Attributes, PTHREAD_CREATE_DETACHED);
+  Result = pthread_create(&Thread, &Attributes, WorkerThread,
+      &WorkerStarts[WhichWorker]);
+  pthread_attr_destroy(&Attributes);
+  return Result == 0;
+}
+
+/****************************************************************************
+ Function
+     _HW_WorkerIdle
+ Parameters
+     none
+ Returns
+     none
+ Description
+     gives the core to another thread, called by a thread with nothing to do
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+void _HW_WorkerIdle(void)
+{
+  sched_yield();
+}
+
+#endif /* ES_THREADED_EXECUTOR */
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/****************************************************************************
+ Function
+     InitCriticalLock
+ Parameters
+     none
+ Returns
+     none
+ Description
+     makes the critical region lock, recursive so that regions can nest
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+static void InitCriticalLock(void)
+{
+  pthread_mutexattr_t Attributes;
+
+  pthread_mutexattr_init(&Attributes);
+  pthread_mutexattr_settype(&Attributes, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(&CriticalLock, &Attributes);
+  pthread_mutexattr_destroy(&Attributes);
+}
+
+#ifdef ES_THREADED_EXECUTOR
+/****************************************************************************
+ Function
+     WorkerThread
+ Parameters
+     void *pArg : the WorkerStart_t for this thread
+ Returns
+     NULL, once the worker function has returned
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+static void *WorkerThread(void *pArg)
+{
+  WorkerStart_t *pStart = (WorkerStart_t *)pArg;
+
+  pStart->pWorker(pStart->WhichWorker);
+  return NULL;
+}
+
+#endif
+#endif /* ES_HOST_PORT */
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
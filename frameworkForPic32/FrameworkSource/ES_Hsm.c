@@ -0,0 +1,747 @@
+//#define TEST
+/****************************************************************************
+ Module
+     ES_Hsm.c
+
+ Description
+     A table driven engine for hierarchical state machines. The machine is
+     described by const tables (see ES_Hsm.h) rather than by nested Run and
+     During functions, as in HSMTemplate.c.
+
+ Notes
+     An event is offered first to the rows of the active leaf state, then to
+     the rows of its parent and so on up to the top, in a loop. The first row
+     with the right event type whose guard passes is taken.
+
+     Taking a row exits states from the active leaf up to, but not including,
+     the least common ancestor (LCA) of the row's owner and its target, runs
+     the action, then enters states from below the LCA down to the target,
+     and on down through initial (or history) children to a leaf. The LCA of
+     every row is worked out once by ES_Hsm_Init, so a transition only walks
+     the states that it actually exits and enters, whatever the depth of the
+     machine, and without recursion.
+
+     The LCA is the deepest state that is a proper ancestor of the target and
+     is the owner or one of its ancestors. So a transition to the owner
+     itself, or to one of its ancestors, exits and re-enters that state,
+     while a transition to one of the owner's descendants does not exit the
+     owner.
+
+     History is shallow: a state with History set re-enters the child that
+     was active when it was last exited, and that child then enters its own
+     initial (or history) child.
+
+     With ES_SM_STATS defined, a machine given statistics by ES_Hsm_SetStats
+     counts entries, dwell times and transitions of its leaf states.
+
+     Entry, exit, guard and action functions must not call ES_Hsm_Dispatch
+     on the same machine. To act on an event of its own, a machine posts it
+     to its service's queue.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/18/26       karthi24     added optional state statistics
+ 10/18/26       karthi24     started coding
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_General.h"
+#include "ES_Hsm.h"
+
+#include <stddef.h>
+
+/*----------------------------- Module Defines ----------------------------*/
+
+/*---------------------------- Module Functions ---------------------------*/
+static bool IsAncestorOrSelf(const ES_HsmDef_t *pDef, ES_HsmState_t Ancestor,
+    ES_HsmState_t State);
+static void EnterFrom(ES_Hsm_t *pHsm, ES_HsmState_t Lca, ES_HsmState_t Target);
+static bool DispatchToStates(ES_Hsm_t *pHsm, ES_Event_t Event);
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     ES_Hsm_Init
+ Parameters
+     ES_Hsm_t * pHsm : the machine to set up
+     const ES_HsmDef_t * pDef : its state and transition tables
+     void * pContext : passed to every entry, exit, guard & action function
+     ES_HsmState_t * pHistory : NumStates entries of RAM for the history
+     ES_HsmState_t * pLca : NumTransitions entries of RAM for the LCAs
+ Returns
+     bool : false if the tables are not consistent, or are nested deeper
+            than ES_HSM_MAX_DEPTH
+ Description
+     checks the tables and works out the LCA of every transition. The
+     machine does not enter any state until ES_Hsm_Start.
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+bool ES_Hsm_Init(ES_Hsm_t *pHsm, const ES_HsmDef_t *pDef, void *pContext,
+    ES_HsmState_t *pHistory, ES_HsmState_t *pLca)
+{
+  const ES_HsmStateDesc_t   *pState;
+  const ES_HsmTransition_t  *pRow;
+  ES_HsmState_t             Owner;
+  ES_HsmState_t             Ancestor;
+  uint8_t                   Row;
+  uint8_t                   Depth;
+
+  pHsm->pDef      = pDef;
+  pHsm->pContext  = pContext;
+  pHsm->Current   = ES_HSM_NO_STATE;
+  pHsm->pHistory  = pHistory;
+  pHsm->pLca      = pLca;
+#ifdef ES_SM_STATS
+  pHsm->pStats    = NULL;
+#endif
+
+  if (pDef->Initial >= pDef->NumStates)
+  {
+    return false;
+  }
+  for (Owner = 0; Owner < pDef->NumStates; Owner++)
+  {
+    pState = &pDef->pStates[Owner];
+    pHistory[Owner] = ES_HSM_NO_STATE;
+
+    // parents must exist and the nesting must end within ES_HSM_MAX_DEPTH
+    Ancestor = Owner;
+    for (Depth = 0; Ancestor != ES_HSM_NO_STATE; Depth++)
+    {
+      if ((Depth >= ES_HSM_MAX_DEPTH) || (Ancestor >= pDef->NumStates))
+      {
+        return false;
+      }
+      Ancestor = pDef->pStates[Ancestor].Parent;
+    }
+    if ((pState->Initial != ES_HSM_NO_STATE) &&
+        ((pState->Initial >= pDef->NumStates) ||
+        (pDef->pStates[pState->Initial].Parent != Owner)))
+    {
+      return false;
+    }
+    if (((uint16_t)pState->FirstTrans + pState->NumTrans) >
+        pDef->NumTransitions)
+    {
+      return false;
+    }
+
+    for (Row = pState->FirstTrans;
+        Row < pState->FirstTrans + pState->NumTrans; Row++)
+    {
+      pRow = &pDef->pTransitions[Row];
+      if (pRow->Target == ES_HSM_INTERNAL)
+      {
+        pLca[Row] = ES_HSM_INTERNAL;
+        continue;
+      }
+      if (pRow->Target >= pDef->NumStates)
+      {
+        return false;
+      }
+      // deepest proper ancestor of the target that contains the owner
+      Ancestor = pDef->pStates[pRow->Target].Parent;
+      while ((Ancestor != ES_HSM_NO_STATE) &&
+          !IsAncestorOrSelf(pDef, Ancestor, Owner))
+      {
+        Ancestor = pDef->pStates[Ancestor].Parent;
+      }
+      pLca[Row] = Ancestor;
+    }
+  }
+  return true;
+}
+
+/****************************************************************************
+ Function
+     ES_Hsm_Start
+ Parameters
+     ES_Hsm_t * pHsm : the machine to start
+ Returns
+     None
+ Description
+     enters the initial top level state and drills down to a leaf, running
+     the entry functions on the way
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+void ES_Hsm_Start(ES_Hsm_t *pHsm)
+{
+  EnterFrom(pHsm, ES_HSM_NO_STATE, pHsm->pDef->Initial);
+#ifdef ES_SM_STATS
+  if (pHsm->pStats != NULL)
+  {
+    ES_SMStats_Update(pHsm->pStats, pHsm->Current);
+  }
+#endif
+}
+
+/****************************************************************************
+ Function
+     ES_Hsm_Dispatch
+ Parameters
+     ES_Hsm_t * pHsm : the machine
+     ES_Event_t Event : the event to process
+ Returns
+     bool : true if a row was taken, false if no state had a use for it
+ Description
+     offers the event to the active leaf and then to each of its ancestors,
+     and takes the first row that matches
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+bool ES_Hsm_Dispatch(ES_Hsm_t *pHsm, ES_Event_t Event)
+{
+  bool Taken;
+
+  Taken = DispatchToStates(pHsm, Event);
+#ifdef ES_SM_STATS
+  if (pHsm->pStats != NULL)
+  {
+    ES_SMStats_Update(pHsm->pStats, pHsm->Current);
+  }
+#endif
+  return Taken;
+}
+
+/****************************************************************************
+ Function
+     ES_Hsm_GetState
+ Parameters
+     ES_Hsm_t * pHsm : the machine
+ Returns
+     ES_HsmState_t : the active leaf state, ES_HSM_NO_STATE before Start
+ Description
+     query function for the state
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+ES_HsmState_t ES_Hsm_GetState(ES_Hsm_t *pHsm)
+{
+  return pHsm->Current;
+}
+
+/****************************************************************************
+ Function
+     ES_Hsm_IsIn
+ Parameters
+     ES_Hsm_t * pHsm : the machine
+     ES_HsmState_t State : the state to test
+ Returns
+     bool : true if State is the active leaf or one of its ancestors
+ Description
+     query function for composite states
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+bool ES_Hsm_IsIn(ES_Hsm_t *pHsm, ES_HsmState_t State)
+{
+  if (pHsm->Current == ES_HSM_NO_STATE)
+  {
+    return false;
+  }
+  return IsAncestorOrSelf(pHsm->pDef, State, pHsm->Current);
+}
+
+#ifdef ES_SM_STATS
+/****************************************************************************
+ Function
+     ES_Hsm_SetStats
+ Parameters
+     ES_Hsm_t * pHsm : the machine
+     ES_SMStats_t * pStats : statistics with one state per table entry
+     const char * pName : the machine's name, for the report
+     const char * const * pStateNames : the state names, or NULL
+ Returns
+     None
+ Description
+     starts collecting statistics on the machine's leaf states
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+void ES_Hsm_SetStats(ES_Hsm_t *pHsm, ES_SMStats_t *pStats,
+    const char *pName, const char * const *pStateNames)
+{
+  ES_SMStats_Init(pStats, pName, pStateNames, pHsm->Current);
+  pHsm->pStats = pStats;
+}
+#endif
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/****************************************************************************
+ Function
+     DispatchToStates
+ Parameters
+     ES_Hsm_t * pHsm : the machine
+     ES_Event_t Event : the event to process
+ Returns
+     bool : true if a row was taken
+ Description
+     the work of ES_Hsm_Dispatch: offers the event to the active leaf and
+     then to each of its ancestors, and takes the first row that matches
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+static bool DispatchToStates(ES_Hsm_t *pHsm, ES_Event_t Event)
+{
+  const ES_HsmDef_t         *pDef = pHsm->pDef;
+  const ES_HsmTransition_t  *pRow;
+  const ES_HsmTransition_t  *pEnd;
+  ES_HsmState_t             Owner;
+  ES_HsmState_t             Exiting;
+  ES_HsmState_t             Lca;
+
+  for (Owner = pHsm->Current; Owner != ES_HSM_NO_STATE;
+      Owner = pDef->pStates[Owner].Parent)
+  {
+    pRow  = &pDef->pTransitions[pDef->pStates[Owner].FirstTrans];
+    pEnd  = pRow + pDef->pStates[Owner].NumTrans;
+    for ( ; pRow < pEnd; pRow++)
+    {
+      if ((pRow->EventType != Event.EventType) ||
+          ((pRow->Guard != NULL) && !pRow->Guard(pHsm->pContext, Event)))
+      {
+        continue;
+      }
+      Lca = pHsm->pLca[pRow - pDef->pTransitions];
+      if (Lca == ES_HSM_INTERNAL)
+      {
+        if (pRow->Action != NULL)
+        {
+          pRow->Action(pHsm->pContext, Event);
+        }
+        return true;
+      }
+
+      // exit up to the LCA, remembering each state's active child
+      for (Exiting = pHsm->Current; Exiting != Lca;
+          Exiting = pDef->pStates[Exiting].Parent)
+      {
+        if (pDef->pStates[Exiting].Exit != NULL)
+        {
+          pDef->pStates[Exiting].Exit(pHsm->pContext);
+        }
+        if (pDef->pStates[Exiting].Parent != ES_HSM_NO_STATE)
+        {
+          pHsm->pHistory[pDef->pStates[Exiting].Parent] = Exiting;
+        }
+      }
+      if (pRow->Action != NULL)
+      {
+        pRow->Action(pHsm->pContext, Event);
+      }
+      EnterFrom(pHsm, Lca, pRow->Target);
+      return true;
+    }
+  }
+  return false;
+}
+
+/****************************************************************************
+ Function
+     IsAncestorOrSelf
+ Parameters
+     const ES_HsmDef_t * pDef : the machine's tables
+     ES_HsmState_t Ancestor : the possible ancestor
+     ES_HsmState_t State : the state to start from
+ Returns
+     bool : true if Ancestor is State or one of its ancestors
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+static bool IsAncestorOrSelf(const ES_HsmDef_t *pDef, ES_HsmState_t Ancestor,
+    ES_HsmState_t State)
+{
+  for ( ; State != ES_HSM_NO_STATE; State = pDef->pStates[State].Parent)
+  {
+    if (State == Ancestor)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+/****************************************************************************
+ Function
+     EnterFrom
+ Parameters
+     ES_Hsm_t * pHsm : the machine
+     ES_HsmState_t Lca : the state that is already active, or ES_HSM_NO_STATE
+     ES_HsmState_t Target : the state to enter
+ Returns
+     None
+ Description
+     runs the entry functions from just below Lca down to Target, then on
+     down through initial or history children, and makes the leaf current
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+static void EnterFrom(ES_Hsm_t *pHsm, ES_HsmState_t Lca, ES_HsmState_t Target)
+{
+  const ES_HsmStateDesc_t *pStates = pHsm->pDef->pStates;
+  ES_HsmState_t           Path[ES_HSM_MAX_DEPTH];
+  ES_HsmState_t           Child;
+  uint8_t                 Depth = 0;
+
+  // the path is collected leaf first, so the entries run from the far end
+  for (Child = Target; Child != Lca; Child = pStates[Child].Parent)
+  {
+    Path[Depth++] = Child;
+  }
+  while (Depth > 0)
+  {
+    Child = Path[--Depth];
+    if (pStates[Child].Entry != NULL)
+    {
+      pStates[Child].Entry(pHsm->pContext);
+    }
+  }
+
+  for ( ; ; )
+  {
+    Child = pStates[Target].Initial;
+    if (pStates[Target].History &&
+        (pHsm->pHistory[Target] != ES_HSM_NO_STATE))
+    {
+      Child = pHsm->pHistory[Target];
+    }
+    if (Child == ES_HSM_NO_STATE)
+    {
+      break;
+    }
+    if (pStates[Child].Entry != NULL)
+    {
+      pStates[Child].Entry(pHsm->pContext);
+    }
+    Target = Child;
+  }
+  pHsm->Current = Target;
+}
+
+#ifdef TEST
+/****************************************************************************
+ Host benchmark. The same 4 level machine is run through ES_Hsm and through
+ nested Run/During functions written the way HSMTemplate.c does it, and the
+ time per event is printed. Both keep a trace of entries and exits so that
+ they can be checked against each other.
+
+   A (top)
+   +- B
+      +- C  (initial)
+      |  +- D1 (initial) <-> D2 on EV_FLIP
+      +- C2, with history
+         +- E1 (initial) <-> E2 on EV_FLIP
+   C -> C2 and C2 -> C on EV_SWAP
+   EV_COUNT is handled internally by A, from 4 levels down
+ ****************************************************************************/
+#include <stdio.h>
+#include <time.h>
+
+#define EV_FLIP   ((ES_EventType_t)100)
+#define EV_SWAP   ((ES_EventType_t)101)
+#define EV_COUNT  ((ES_EventType_t)102)
+#define EV_ENTRY  ((ES_EventType_t)110)
+#define EV_EXIT   ((ES_EventType_t)111)
+
+#define NUM_EVENTS 1000000UL
+
+enum { S_A, S_B, S_C, S_D1, S_D2, S_C2, S_E1, S_E2, NUM_TEST_STATES };
+
+static uint32_t Trace;    // a running hash of the entries & exits
+static uint32_t Counted;
+
+static void Note(uint32_t What)
+{
+  Trace = (Trace * 31) + What;
+}
+
+// ---- the table driven version ----
+static void InA(void *p)  { Note(1);  }
+static void InB(void *p)  { Note(2);  }
+static void InC(void *p)  { Note(3);  }
+static void InD1(void *p) { Note(4);  }
+static void InD2(void *p) { Note(5);  }
+static void InC2(void *p) { Note(6);  }
+static void InE1(void *p) { Note(7);  }
+static void InE2(void *p) { Note(8);  }
+static void OutC(void *p) { Note(13); }
+static void OutD1(void *p) { Note(14); }
+static void OutD2(void *p) { Note(15); }
+static void OutC2(void *p) { Note(16); }
+static void OutE1(void *p) { Note(17); }
+static void OutE2(void *p) { Note(18); }
+static void Count(void *p, ES_Event_t e) { Counted++; }
+
+static const ES_HsmStateDesc_t TestStates[NUM_TEST_STATES] = {
+  //  Parent           Initial          History Entry Exit   First Num
+  { ES_HSM_NO_STATE, S_B,             false, InA,  NULL,   0, 1 }, // A
+  { S_A,             S_C,             false, InB,  NULL,   1, 0 }, // B
+  { S_B,             S_D1,            false, InC,  OutC,   1, 1 }, // C
+  { S_C,             ES_HSM_NO_STATE, false, InD1, OutD1,  2, 1 }, // D1
+  { S_C,             ES_HSM_NO_STATE, false, InD2, OutD2,  3, 1 }, // D2
+  { S_B,             S_E1,            true,  InC2, OutC2,  4, 1 }, // C2
+  { S_C2,            ES_HSM_NO_STATE, false, InE1, OutE1,  5, 1 }, // E1
+  { S_C2,            ES_HSM_NO_STATE, false, InE2, OutE2,  6, 1 }, // E2
+};
+
+static const ES_HsmTransition_t TestTransitions[] = {
+  { EV_COUNT, NULL, Count, ES_HSM_INTERNAL }, // A
+  { EV_SWAP,  NULL, NULL,  S_C2 },            // C
+  { EV_FLIP,  NULL, NULL,  S_D2 },            // D1
+  { EV_FLIP,  NULL, NULL,  S_D1 },            // D2
+  { EV_SWAP,  NULL, NULL,  S_C },             // C2
+  { EV_FLIP,  NULL, NULL,  S_E2 },            // E1
+  { EV_FLIP,  NULL, NULL,  S_E1 },            // E2
+};
+
+static const ES_HsmDef_t TestDef = {
+  TestStates, NUM_TEST_STATES,
+  TestTransitions, ARRAY_SIZE(TestTransitions), S_A
+};
+
+static ES_Hsm_t       TestHsm;
+static ES_HsmState_t  TestHistory[NUM_TEST_STATES];
+static ES_HsmState_t  TestLca[ARRAY_SIZE(TestTransitions)];
+
+// ---- the same machine as nested Run & During functions ----
+static uint8_t StateA, StateB, StateC, StateC2;
+
+static ES_Event_t RunC(ES_Event_t Event);
+static ES_Event_t RunC2(ES_Event_t Event);
+
+static ES_Event_t RunC(ES_Event_t Event)    // D1 / D2
+{
+  ES_Event_t  Entry = { EV_ENTRY, 0 };
+  bool        MakeTransition = false;
+  uint8_t     NextState = StateC;
+
+  switch (StateC)
+  {
+    case S_D1:
+      if (Event.EventType == EV_ENTRY) { Note(4); }
+      else if (Event.EventType == EV_EXIT) { Note(14); }
+      else if (Event.EventType == EV_FLIP)
+      {
+        NextState = S_D2; MakeTransition = true;
+        Event.EventType = ES_NO_EVENT;
+      }
+      break;
+    case S_D2:
+      if (Event.EventType == EV_ENTRY) { Note(5); }
+      else if (Event.EventType == EV_EXIT) { Note(15); }
+      else if (Event.EventType == EV_FLIP)
+      {
+        NextState = S_D1; MakeTransition = true;
+        Event.EventType = ES_NO_EVENT;
+      }
+      break;
+  }
+  if (MakeTransition)
+  {
+    ES_Event_t Exit = { EV_EXIT, 0 };
+    RunC(Exit);
+    StateC = NextState;
+    RunC(Entry);
+  }
+  return Event;
+}
+
+static ES_Event_t RunC2(ES_Event_t Event)   // E1 / E2
+{
+  ES_Event_t  Entry = { EV_ENTRY, 0 };
+  bool        MakeTransition = false;
+  uint8_t     NextState = StateC2;
+
+  switch (StateC2)
+  {
+    case S_E1:
+      if (Event.EventType == EV_ENTRY) { Note(7); }
+      else if (Event.EventType == EV_EXIT) { Note(17); }
+      else if (Event.EventType == EV_FLIP)
+      {
+        NextState = S_E2; MakeTransition = true;
+        Event.EventType = ES_NO_EVENT;
+      }
+      break;
+    case S_E2:
+      if (Event.EventType == EV_ENTRY) { Note(8); }
+      else if (Event.EventType == EV_EXIT) { Note(18); }
+      else if (Event.EventType == EV_FLIP)
+      {
+        NextState = S_E1; MakeTransition = true;
+        Event.EventType = ES_NO_EVENT;
+      }
+      break;
+  }
+  if (MakeTransition)
+  {
+    ES_Event_t Exit = { EV_EXIT, 0 };
+    RunC2(Exit);
+    StateC2 = NextState;
+    RunC2(Entry);
+  }
+  return Event;
+}
+
+static ES_Event_t DuringC(ES_Event_t Event)
+{
+  if (Event.EventType == EV_ENTRY)
+  {
+    Note(3); StateC = S_D1; RunC(Event);
+  }
+  else if (Event.EventType == EV_EXIT)
+  {
+    RunC(Event); Note(13);
+  }
+  else
+  {
+    Event = RunC(Event);
+  }
+  return Event;
+}
+
+static ES_Event_t DuringC2(ES_Event_t Event)
+{
+  if (Event.EventType == EV_ENTRY)
+  {
+    Note(6); RunC2(Event);    // history: StateC2 is left as it was
+  }
+  else if (Event.EventType == EV_EXIT)
+  {
+    RunC2(Event); Note(16);
+  }
+  else
+  {
+    Event = RunC2(Event);
+  }
+  return Event;
+}
+
+static ES_Event_t RunB(ES_Event_t Event)    // C / C2
+{
+  ES_Event_t  Entry = { EV_ENTRY, 0 };
+  bool        MakeTransition = false;
+  uint8_t     NextState = StateB;
+
+  switch (StateB)
+  {
+    case S_C:
+      Event = DuringC(Event);
+      if (Event.EventType == EV_SWAP)
+      {
+        NextState = S_C2; MakeTransition = true;
+        Event.EventType = ES_NO_EVENT;
+      }
+      break;
+    case S_C2:
+      Event = DuringC2(Event);
+      if (Event.EventType == EV_SWAP)
+      {
+        NextState = S_C; MakeTransition = true;
+        Event.EventType = ES_NO_EVENT;
+      }
+      break;
+  }
+  if (MakeTransition)
+  {
+    ES_Event_t Exit = { EV_EXIT, 0 };
+    RunB(Exit);
+    StateB = NextState;
+    RunB(Entry);
+  }
+  return Event;
+}
+
+static ES_Event_t DuringB(ES_Event_t Event)
+{
+  if (Event.EventType == EV_ENTRY)
+  {
+    Note(2); StateB = S_C; RunB(Event);
+  }
+  else if (Event.EventType == EV_EXIT)
+  {
+    RunB(Event);
+  }
+  else
+  {
+    Event = RunB(Event);
+  }
+  return Event;
+}
+
+static ES_Event_t RunA(ES_Event_t Event)    // the top level, only B
+{
+  switch (StateA)
+  {
+    case S_B:
+      if (Event.EventType == EV_ENTRY)
+      {
+        Note(1);
+      }
+      Event = DuringB(Event);
+      if (Event.EventType == EV_COUNT)
+      {
+        Counted++;
+        Event.EventType = ES_NO_EVENT;
+      }
+      break;
+  }
+  return Event;
+}
+
+static const ES_EventType_t Script[] = {
+  EV_FLIP, EV_COUNT, EV_FLIP, EV_SWAP, EV_FLIP, EV_COUNT, EV_SWAP, EV_SWAP
+};
+
+int main(void)
+{
+  ES_Event_t  Event = { ES_NO_EVENT, 0 };
+  uint32_t    TableTrace, TableCount;
+  clock_t     Start;
+  double      TableNs, NestedNs;
+  unsigned long i;
+
+  if (!ES_Hsm_Init(&TestHsm, &TestDef, &TestHsm, TestHistory, TestLca))
+  {
+    puts("ES_Hsm_Init rejected the tables");
+    return 1;
+  }
+  Trace = 0; Counted = 0;
+  Start = clock();
+  ES_Hsm_Start(&TestHsm);
+  for (i = 0; i < NUM_EVENTS; i++)
+  {
+    Event.EventType = Script[i % ARRAY_SIZE(Script)];
+    ES_Hsm_Dispatch(&TestHsm, Event);
+  }
+  TableNs = (double)(clock() - Start) * 1e9 / CLOCKS_PER_SEC / NUM_EVENTS;
+  TableTrace = Trace; TableCount = Counted;
+
+  Trace = 0; Counted = 0;
+  StateC2 = S_E1;
+  StateA  = S_B;
+  Start = clock();
+  Event.EventType = EV_ENTRY;
+  RunA(Event);
+  for (i = 0; i < NUM_EVENTS; i++)
+  {
+    Event.EventType = Script[i % ARRAY_SIZE(Script)];
+    RunA(Event);
+  }
+  NestedNs = (double)(clock() - Start) * 1e9 / CLOCKS_PER_SEC / NUM_EVENTS;
+
+  printf("traces %s, counts %lu/%lu\n",
+      (TableTrace == Trace) ? "match" : "DIFFER",
+      (unsigned long)TableCount, (unsigned long)Counted);
+  printf("ES_Hsm %.1f ns/event, nested Run/During %.1f ns/event\n",
+      TableNs, NestedNs);
+  return (TableTrace == Trace) ? 0 : 1;
+}
+#endif /* TEST */
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
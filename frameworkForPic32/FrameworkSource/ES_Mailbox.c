@@ -0,0 +1,202 @@
+/****************************************************************************
+ Module
+     ES_Mailbox.c
+
+ Description
+     Latest-value mailboxes, for signals like a slider position or a light
+     level that are continuous state rather than a stream of happenings.
+
+ Notes
+     A write overwrites the value, so a fast producer can never fill a queue
+     or leave a reader working through stale values. A write of the value
+     already in the mailbox changes nothing.
+
+     Any code can call ES_Mailbox_Read at any time for the latest value. A
+     reader that only wants to act on changes keeps the version it last saw
+     and compares it with the one returned.
+
+     A service can also subscribe to be told of changes. When the value
+     changes, each subscriber is posted NotifyEvent, with the new value as the
+     parameter, unless it already has one that it has not taken. Taking the
+     value with ES_Mailbox_Take re-arms the notification, so a subscriber has
+     at most one notification in its queue however fast the value changes,
+     and the value it takes is always the latest one. A subscriber must take
+     the value every time it gets NotifyEvent, even in states that ignore it.
+
+     Writes are made from event checkers or service code, not from interrupt
+     responses, since they may post events.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/18/26       karthi24     started coding
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "ES_General.h"
+#include "ES_LookupTables.h"
+#include "ES_Port.h"
+#include "ES_Mailbox.h"
+
+#include <stddef.h>
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     ES_Mailbox_Init
+ Parameters
+     ES_Mailbox_t * pBox : the mailbox
+     uint16_t InitialValue : value to read before the first write
+     ES_EventType_t NotifyEvent : event posted to subscribers on a change,
+       ES_NO_EVENT if there will be none
+ Returns
+     None
+ Description
+     sets up a mailbox with no subscribers
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+void ES_Mailbox_Init(ES_Mailbox_t *pBox, uint16_t InitialValue,
+    ES_EventType_t NotifyEvent)
+{
+  pBox->Value       = InitialValue;
+  pBox->Version     = 0;
+  pBox->NotifyEvent = NotifyEvent;
+  pBox->Subscribers = 0;
+  pBox->Pending     = 0;
+}
+
+/****************************************************************************
+ Function
+     ES_Mailbox_Subscribe
+ Parameters
+     ES_Mailbox_t * pBox : the mailbox
+     uint8_t WhichService : the priority of the service to notify
+ Returns
+     None
+ Description
+     adds a service to the ones posted NotifyEvent when the value changes
+ Notes
+     normally called from the service's init function
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+void ES_Mailbox_Subscribe(ES_Mailbox_t *pBox, uint8_t WhichService)
+{
+  if (WhichService < 16)
+  {
+    pBox->Subscribers |= BitNum2SetMask[WhichService];
+  }
+}
+
+/****************************************************************************
+ Function
+     ES_Mailbox_Write
+ Parameters
+     ES_Mailbox_t * pBox : the mailbox
+     uint16_t NewValue : the value to store
+ Returns
+     bool : true if the value changed
+ Description
+     replaces the value, bumps the version and notifies the subscribers that
+     do not already have a notification waiting
+ Notes
+     a subscriber whose notification could not be posted is not left marked
+     as having one waiting, so the next write tries it again
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+bool ES_Mailbox_Write(ES_Mailbox_t *pBox, uint16_t NewValue)
+{
+  uint16_t    ToNotify;
+  uint8_t     Service;
+  ES_Event_t  NotifyEvent;
+
+  EnterCritical();
+  if (pBox->Value == NewValue)
+  {
+    ExitCritical();
+    return false;
+  }
+  pBox->Value = NewValue;
+  pBox->Version++;
+  ToNotify = pBox->Subscribers & ~pBox->Pending;
+  pBox->Pending |= ToNotify;
+  ExitCritical();
+
+  if ((ToNotify != 0) && (pBox->NotifyEvent != ES_NO_EVENT))
+  {
+    NotifyEvent.EventType   = pBox->NotifyEvent;
+    NotifyEvent.EventParam  = NewValue;
+    for (Service = 0; ToNotify != 0; Service++, ToNotify >>= 1)
+    {
+      if ((ToNotify & 1) && !ES_PostToService(Service, NotifyEvent))
+      {
+        EnterCritical();
+        pBox->Pending &= ~(1U << Service);
+        ExitCritical();
+      }
+    }
+  }
+  return true;
+}
+
+/****************************************************************************
+ Function
+     ES_Mailbox_Read
+ Parameters
+     ES_Mailbox_t * pBox : the mailbox
+     uint16_t * pVersion : where to put the version that goes with the value,
+       may be NULL
+ Returns
+     uint16_t : the latest value
+ Description
+     reads the value, and its version, without changing anything
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+uint16_t ES_Mailbox_Read(ES_Mailbox_t *pBox, uint16_t *pVersion)
+{
+  uint16_t Value;
+
+  EnterCritical();
+  Value = pBox->Value;
+  if (pVersion != NULL)
+  {
+    *pVersion = pBox->Version;
+  }
+  ExitCritical();
+  return Value;
+}
+
+/****************************************************************************
+ Function
+     ES_Mailbox_Take
+ Parameters
+     ES_Mailbox_t * pBox : the mailbox
+     uint8_t WhichService : the priority of the subscriber taking the value
+ Returns
+     uint16_t : the latest value
+ Description
+     reads the value for a subscriber and re-arms its notification, so that
+     the next change posts NotifyEvent to it again
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+uint16_t ES_Mailbox_Take(ES_Mailbox_t *pBox, uint8_t WhichService)
+{
+  uint16_t Value;
+
+  EnterCritical();
+  Value = pBox->Value;
+  if (WhichService < 16)
+  {
+    pBox->Pending &= BitNum2ClrMask[WhichService];
+  }
+  ExitCritical();
+  return Value;
+}
+
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -13,6 +13,21 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/18/26       karthi24 refuse to build with the threaded executor or for the
+                         host, both want ES_HostPort.c in place of this file
+ 10/18/26       karthi24 interrupt post rings moved into the framework context
+ 10/18/26       karthi24 with TERMINAL_RX_INT, UART_RX is dirty while the
+                         terminal's receive buffer holds characters
+ 10/18/26       karthi24 the tick interrupt keeps missed tick, latency & backlog
+                         statistics, read with _HW_GetTickStats
+ 10/18/26       karthi24 added 64 bit core & tick counts, SysTickCounter now
+                         32 bits
+ 10/18/26       karthi24 added _HW_TakeDirtySources for gated event checkers
+ 10/18/26       karthi24 TickCount & SysTickCounter moved into the framework
+                         context
+ 10/18/26       karthi24 nestable, IPL based critical regions with statistics
+ 10/18/26       karthi24 added the interrupt post rings, emptied in
+                        _HW_Process_Pending_Ints
  08/06/21 15:43 jec     no changes just a test of using GIT from within MPLABX
  08/06/21 13:04 jec     cleaned things up in preparation for the 2021 AY
  10/05/20 18:52 ram     started work on port to PIC32MX170F256B
@@ -72,7 +87,10 @@
 
 #include "ES_Port.h"        // the header file for this module
 #include "ES_Types.h"       // framework type definitions
+#include "ES_Configure.h"   // for the interrupt post ring sizes
+#include "ES_Framework.h"   // for ES_PostToService
 #include "ES_Timers.h"      // framework timer prototypes
+#include "ES_Context.h"     // the tick counts live in the framework context
 
 #include "terminal.h"       // terminal prototypes for init function
 
@@ -83,20 +101,38 @@
 // need to post events from the interrupt response routine. This is necessary
 // for compilers like HTC for the midrange PICs which do not produce re-entrant
 // code so cannot post directly to the queues from within the interrupt resp.
-static volatile uint8_t TickCount;
+// SysTickCounter is the tick count to monitor number of SysTick Interrupts.
+// SysTickHigh extends it to 64 bits, see ExtendCount below.
+// All three live in the framework context (ES_Context.h), so that a port
+// running several contexts can tick each one separately.
+#define TickCount (ES_CTX->TickCount)
+#define SysTickCounter (ES_CTX->SysTickCounter)
+#define SysTickHigh (ES_CTX->SysTickHigh)
 
-// Global tick count to monitor number of SysTick Interrupts
-// make uint16_t to maintain backwards compatibility and not overly burden
-// 8 and 16 bit processors
-static volatile uint16_t SysTickCounter = 0;
+// bits 31 and up of the 64 bit core count, kept up by the tick interrupt
+static volatile uint32_t CoreCountHigh;
+
+// written by the tick interrupt, and for MaxBacklog _HW_Process_Pending_Ints
+static volatile ES_TickStats_t TickStats;
 
 // Rate value that needs to be continually added to the compare register to 
 // ensure the interrupts occur periodically
 static volatile TimerRate_t tickPeriod; 
 
-// This variable is used to store the state of the interrupt mask when
-// doing EnterCritical/ExitCritical pairs
-// uint8_t _INTCON_temp;
+// These are used to store the CPU status when entering the outermost of a
+// set of nested EnterCritical/ExitCritical pairs. No interrupt that uses them
+// can run while CriticalNesting is non-zero, so they need no protection.
+static uint8_t  CriticalNesting;
+static uint32_t CriticalSavedStatus;
+
+#ifdef CRITICAL_REGION_STATS
+// core count at the start of the current outermost region
+static uint32_t CriticalStart;
+// longest region seen so far (core timer counts) & where it was entered
+static uint32_t MaxCriticalTicks;
+static uint32_t MaxCriticalCaller;
+static uint32_t CurrentCriticalCaller;
+#endif
 
 
 /****************************************************************************
@@ -104,6 +140,33 @@ static volatile TimerRate_t tickPeriod;
  ***************************************************************************/
 
 //#define LED_DEBUG
+
+#ifdef ES_THREADED_EXECUTOR
+#error "the threaded executor needs a host port, the PIC32 has no threads"
+#endif
+#ifdef ES_HOST_PORT
+#error "build ES_HostPort.c in place of ES_Port.c for the host"
+#endif
+
+#if NUM_INT_POST_RINGS > 0
+#if (INT_POST_RING_SIZE & (INT_POST_RING_SIZE - 1)) || (INT_POST_RING_SIZE > 128)
+#error "INT_POST_RING_SIZE must be a power of 2, no larger than 128"
+#endif
+#define INT_POST_RING_MASK (INT_POST_RING_SIZE - 1)
+
+/* Each interrupt that posts events gets its own ring. The ISR is the only
+   writer of Head and the main loop is the only writer of Tail, so neither
+   side needs a critical region. The indices run freely and are masked when
+   used, so Head - Tail is always the number of entries in the ring.
+   The rings are part of the framework context (see ES_Context.h).
+ */
+#define IntPostRings (ES_CTX->IntPostRings)
+
+static void DrainIntPostRings(void);
+#endif /* NUM_INT_POST_RINGS > 0 */
+
+static uint64_t ExtendCount(uint32_t High, uint32_t Low);
+static uint32_t UpdateHigh(uint32_t High, uint32_t Low);
 /****************************************************************************
  Function
     _HW_PIC32Init
@@ -129,6 +192,196 @@ void _HW_PIC32Init(void)
   }
 #endif
 }
+/****************************************************************************
+ Function
+    _HW_EnterCritical
+ Parameters
+    none
+ Returns
+    None.
+ Description
+    starts a critical region by raising the CPU priority to ES_CRITICAL_IPL.
+    Interrupts at or below that priority are held off until the matching
+    _HW_ExitCritical.
+ Notes
+    Never lowers the priority, so it is safe to call from an ISR running at
+    or below ES_CRITICAL_IPL. Interrupts are fully disabled only for the few
+    instructions it takes to change the status register.
+    Called through the EnterCritical() macro.
+ Author
+    karthi24, 10/18/26
+****************************************************************************/
+void _HW_EnterCritical(void)
+{
+  uint32_t Status;
+
+  // turn ints off while we work on the status register
+  Status = __builtin_disable_interrupts();
+  if (CriticalNesting == 0)
+  {
+    CriticalSavedStatus = Status;
+#ifdef CRITICAL_REGION_STATS
+    CriticalStart         = _HW_GetCoreCount();
+    CurrentCriticalCaller = (uint32_t)__builtin_return_address(0);
+#endif
+  }
+  CriticalNesting++;
+  // raise the priority to the ceiling, if we are not already there, and
+  // put IE back the way that it was
+  if (((Status & _CP0_STATUS_IPL_MASK) >> _CP0_STATUS_IPL_POSITION) <
+      ES_CRITICAL_IPL)
+  {
+    Status = (Status & ~_CP0_STATUS_IPL_MASK) |
+        (ES_CRITICAL_IPL << _CP0_STATUS_IPL_POSITION);
+  }
+  _CP0_SET_STATUS(Status);
+  _ehb();   // make sure that the new status is in effect before we go on
+}
+
+/****************************************************************************
+ Function
+    _HW_ExitCritical
+ Parameters
+    none
+ Returns
+    None.
+ Description
+    ends a critical region. The outermost exit puts the CPU status back the
+    way that it was before the matching _HW_EnterCritical.
+ Notes
+    Called through the ExitCritical() macro.
+ Author
+    karthi24, 10/18/26
+****************************************************************************/
+void _HW_ExitCritical(void)
+{
+  if (--CriticalNesting == 0)
+  {
+#ifdef CRITICAL_REGION_STATS
+    uint32_t Length = _HW_GetCoreCount() - CriticalStart;
+    if (Length > MaxCriticalTicks)
+    {
+      MaxCriticalTicks  = Length;
+      MaxCriticalCaller = CurrentCriticalCaller;
+    }
+#endif
+    _CP0_SET_STATUS(CriticalSavedStatus);
+    _ehb();
+  }
+}
+
+/****************************************************************************
+ Function
+    _HW_GetMaxCriticalTicks
+ Parameters
+    none
+ Returns
+    uint32_t length of the longest critical region, in core timer counts
+    (50ns each), 0 if CRITICAL_REGION_STATS is not defined
+ Description
+    this is the worst case latency that the framework has added to the
+    interrupts at or below ES_CRITICAL_IPL
+ Author
+    karthi24, 10/18/26
+****************************************************************************/
+uint32_t _HW_GetMaxCriticalTicks(void)
+{
+#ifdef CRITICAL_REGION_STATS
+  return MaxCriticalTicks;
+#else
+  return 0;
+#endif
+}
+
+/****************************************************************************
+ Function
+    _HW_GetMaxCriticalCaller
+ Parameters
+    none
+ Returns
+    uint32_t the address that called EnterCritical to start the longest
+    critical region, look it up in the map file
+ Author
+    karthi24, 10/18/26
+****************************************************************************/
+uint32_t _HW_GetMaxCriticalCaller(void)
+{
+#ifdef CRITICAL_REGION_STATS
+  return MaxCriticalCaller;
+#else
+  return 0;
+#endif
+}
+
+/****************************************************************************
+ Function
+    _HW_ResetCriticalStats
+ Parameters
+    none
+ Returns
+    None.
+ Description
+    starts a new measurement of the longest critical region
+ Author
+    karthi24, 10/18/26
+****************************************************************************/
+void _HW_ResetCriticalStats(void)
+{
+#ifdef CRITICAL_REGION_STATS
+  EnterCritical();
+  MaxCriticalTicks  = 0;
+  MaxCriticalCaller = 0;
+  ExitCritical();
+#endif
+}
+
+/****************************************************************************
+ Function
+    _HW_GetTickStats
+ Parameters
+    ES_TickStats_t *pStats, where to copy the statistics
+ Returns
+    None.
+ Description
+    takes a copy of the tick interrupt statistics, so that the time lost to
+    long critical regions & interrupts can be watched for
+ Notes
+    a MissedTicks that isn't 0 means that something held off the tick
+    interrupt for more than a whole tick. The ticks are made up, so the
+    timers run late rather than slow.
+ Author
+    karthi24, 10/18/26
+****************************************************************************/
+void _HW_GetTickStats(ES_TickStats_t *pStats)
+{
+  // the tick interrupt is at ES_CRITICAL_IPL, so this gets a consistent set
+  EnterCritical();
+  *pStats = TickStats;
+  ExitCritical();
+}
+
+/****************************************************************************
+ Function
+    _HW_ResetTickStats
+ Parameters
+    none
+ Returns
+    None.
+ Description
+    zeroes the tick interrupt statistics to start a new measurement
+ Author
+    karthi24, 10/18/26
+****************************************************************************/
+void _HW_ResetTickStats(void)
+{
+  EnterCritical();
+  TickStats.MissedTicks = 0;
+  TickStats.LateInts    = 0;
+  TickStats.MaxLatency  = 0;
+  TickStats.MaxBacklog  = 0;
+  ExitCritical();
+}
+
 /****************************************************************************
  Function
      _HW_Timer_Init
@@ -157,6 +410,8 @@ void _HW_Timer_Init(const TimerRate_t Rate)
         
     // get the current sys clock time
     uint32_t currTime = _CP0_GET_COUNT();
+    // and start the extension of the core count off in step with it
+    CoreCountHigh = currTime >> 31;
     // add the rate to i1t         
     // place value into compare register
     _CP0_SET_COMPARE(currTime + Rate);
@@ -204,6 +459,7 @@ void __ISR(_CORE_TIMER_VECTOR, IPL3AUTO ) _HW_SysTickIntHandler(void)
 {
   static uint32_t deltaTime; // static for speed
   static uint8_t intsThatShouldHaveHappened;
+  uint32_t savedIntState;
   
   // clear interrupt flag using the atomic write to the CLR version of the
   // interrupt flag register
@@ -214,7 +470,10 @@ void __ISR(_CORE_TIMER_VECTOR, IPL3AUTO ) _HW_SysTickIntHandler(void)
   // of the compare register. If that happened, we could end up programming the 
   // compare for a time that had already passed, resulting in a loss of 
   // tick interrupts until the CoreTimer rolled around.
-  EnterCritical();
+  // EnterCritical only holds off interrupts up to ES_CRITICAL_IPL, so this
+  // short region turns all interrupts off instead.
+  savedIntState = __builtin_get_isr_state();
+  __builtin_disable_interrupts();
   // get the time difference since the interrupt
   deltaTime = _CP0_GET_COUNT() - _CP0_GET_COMPARE();
   
@@ -252,11 +511,22 @@ void __ISR(_CORE_TIMER_VECTOR, IPL3AUTO ) _HW_SysTickIntHandler(void)
     // now update the compare register
     _CP0_SET_COMPARE(_CP0_GET_COMPARE() + 
       (intsThatShouldHaveHappened * tickPeriod));
+    // and keep track of the time that was lost
+    TickStats.MissedTicks += intsThatShouldHaveHappened - 1;
+    TickStats.LateInts++;
   }// end if (deltaTime < tickPeriod - 12)
-  ExitCritical();
+  __builtin_set_isr_state(savedIntState);
+  // recorded only now, so as not to eat into the margin above
+  if (deltaTime > TickStats.MaxLatency)
+  {
+    TickStats.MaxLatency = deltaTime;
+  }
   // and keep our tick counters going
   TickCount += intsThatShouldHaveHappened;
   SysTickCounter += intsThatShouldHaveHappened;
+  SysTickHigh = UpdateHigh(SysTickHigh, SysTickCounter);
+  // this runs far more often than every half wrap of the core count
+  CoreCountHigh = UpdateHigh(CoreCountHigh, _CP0_GET_COUNT());
 
 #ifdef LED_DEBUG
   // Toggle debug line
@@ -281,7 +551,55 @@ void __ISR(_CORE_TIMER_VECTOR, IPL3AUTO ) _HW_SysTickIntHandler(void)
 ****************************************************************************/
 uint16_t _HW_GetTickCount(void)
 {
-  return SysTickCounter;
+  return (uint16_t)SysTickCounter;
+}
+
+/****************************************************************************
+ Function
+    _HW_GetTickCount64
+ Parameters
+    none
+ Returns
+    uint64_t count of number of system ticks that have occurred.
+ Description
+    SysTickCounter, extended so that it never wraps
+ Notes
+    safe to call from the main loop or from any interrupt, see ExtendCount
+ Author
+    karthi24, 10/18/26
+****************************************************************************/
+uint64_t _HW_GetTickCount64(void)
+{
+  uint32_t High;
+
+  // the high part must be read first
+  High = SysTickHigh;
+  return ExtendCount(High, SysTickCounter);
+}
+
+/****************************************************************************
+ Function
+    _HW_GetCoreCount64
+ Parameters
+    none
+ Returns
+    uint64_t the core timer count, extended so that it never wraps
+ Description
+    a 20MHz monotonic count for time stamps and latency measurements
+ Notes
+    safe to call from the main loop or from any interrupt, see ExtendCount.
+    Relies on the tick interrupt running at least once every 107s, so it
+    is only good once _HW_Timer_Init has been called with a non-zero rate.
+ Author
+    karthi24, 10/18/26
+****************************************************************************/
+uint64_t _HW_GetCoreCount64(void)
+{
+  uint32_t High;
+
+  // the high part must be read first
+  High = CoreCountHigh;
+  return ExtendCount(High, _CP0_GET_COUNT());
 }
 
 /****************************************************************************
@@ -300,13 +618,17 @@ uint16_t _HW_GetTickCount(void)
      return true so that it can be used in the conditional while() loop in
      ES_Run. This way the test for pending interrupts get processed after every
      run function is called and even when there are no queues with events.
-     This routine could be expanded to process any other interrupt sources
-     that you would like to use to post events to the framework services.
+     Events posted by interrupts through ES_PostFromISR are moved from their
+     rings into the service queues here as well.
  Author
      J. Edward Carryer, 08/13/13 13:27
 ****************************************************************************/
 bool _HW_Process_Pending_Ints(void)
 {
+  if (TickCount > TickStats.MaxBacklog)
+  {
+    TickStats.MaxBacklog = TickCount;
+  }
   // in the case where there was a long delay in getting to this function,
   // multiple interrupts may have occurred (TickCount > 1), so process them all
   while (TickCount > 0)
@@ -315,9 +637,139 @@ bool _HW_Process_Pending_Ints(void)
     ES_Timer_Tick_Resp();
     TickCount--;
   }
+#if NUM_INT_POST_RINGS > 0
+  DrainIntPostRings();
+#endif
   return true;  // always return true to allow loop test in ES_Run to proceed
 }
 
+/****************************************************************************
+ Function
+     _HW_TakeDirtySources
+ Parameters
+     none
+ Returns
+     uint8_t a bit mask, (1 << CHECK_SRC_xx) is set for each source whose
+     flag was set
+ Description
+     tests and clears the interrupt flags used to gate the event checkers
+ Notes
+     clearing the flag before the checker has read the hardware is safe: if
+     the condition is still there the flag comes straight back, and the
+     checker just runs once more
+     With TERMINAL_RX_INT the receive interrupt takes the U1RXIF flag, so
+     the UART source stays dirty for as long as there are buffered characters
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+uint8_t _HW_TakeDirtySources(void)
+{
+  uint8_t Dirty = 0;
+
+  if (IFS1bits.CNAIF)
+  {
+    IFS1CLR = _IFS1_CNAIF_MASK;
+    Dirty |= (1 << CHECK_SRC_CN_A);
+  }
+  if (IFS1bits.CNBIF)
+  {
+    IFS1CLR = _IFS1_CNBIF_MASK;
+    Dirty |= (1 << CHECK_SRC_CN_B);
+  }
+  if (IFS0bits.AD1IF)
+  {
+    IFS0CLR = _IFS0_AD1IF_MASK;
+    Dirty |= (1 << CHECK_SRC_ADC);
+  }
+#ifdef TERMINAL_RX_INT
+  if (Terminal_IsRxData())
+  {
+    Dirty |= (1 << CHECK_SRC_UART_RX);
+  }
+#else
+  if (IFS1bits.U1RXIF)
+  {
+    IFS1CLR = _IFS1_U1RXIF_MASK;
+    Dirty |= (1 << CHECK_SRC_UART_RX);
+  }
+#endif
+  return Dirty;
+}
+
+/****************************************************************************
+ Function
+     ES_PostFromISR
+ Parameters
+     uint8_t WhichRing : the ring that belongs to the calling interrupt
+     uint8_t WhichService : the service the event is headed for
+     ES_Event_t ThisEvent : the event to post
+ Returns
+     bool false if the ring was full, true otherwise
+ Description
+     queues an event for delivery to a service's queue the next time that
+     ES_Run processes pending interrupts
+ Notes
+     Does not disable interrupts. Only one interrupt (one priority level) may
+     write any one ring. Posts are delivered in the order they were made.
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+bool ES_PostFromISR(uint8_t WhichRing, uint8_t WhichService,
+    ES_Event_t ThisEvent)
+{
+#if NUM_INT_POST_RINGS > 0
+  ES_IntPostRing_t *pRing;
+  uint8_t       Head;
+
+  // an entry for a service that doesn't exist would never leave the ring
+  if ((WhichRing >= NUM_INT_POST_RINGS) || (WhichService >= NUM_SERVICES))
+  {
+    return false;
+  }
+  pRing = &IntPostRings[WhichRing];
+  Head  = pRing->Head;
+  if ((uint8_t)(Head - pRing->Tail) >= INT_POST_RING_SIZE)
+  {
+    if (pRing->Overflows < UINT8_MAX)
+    {
+      pRing->Overflows++;
+    }
+    return false;
+  }
+  pRing->Entries[Head & INT_POST_RING_MASK].Event        = ThisEvent;
+  pRing->Entries[Head & INT_POST_RING_MASK].WhichService = WhichService;
+  // the entry must be complete before the main loop can see it
+  _HW_MemoryBarrier();
+  pRing->Head = Head + 1;
+  return true;
+#else
+  return false;
+#endif
+}
+
+/****************************************************************************
+ Function
+     ES_GetIntPostOverflows
+ Parameters
+     uint8_t WhichRing : the ring to report on
+ Returns
+     uint8_t number of posts lost because the ring was full (saturates at 255)
+ Description
+     diagnostic query for sizing INT_POST_RING_SIZE
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+uint8_t ES_GetIntPostOverflows(uint8_t WhichRing)
+{
+#if NUM_INT_POST_RINGS > 0
+  if (WhichRing < NUM_INT_POST_RINGS)
+  {
+    return IntPostRings[WhichRing].Overflows;
+  }
+#endif
+  return 0;
+}
+
 /****************************************************************************
  Function
      _HW_ConsoleInit
@@ -337,6 +789,103 @@ void _HW_ConsoleInit(void)
   Terminal_HWInit();
 }
 
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+#if NUM_INT_POST_RINGS > 0
+/****************************************************************************
+ Function
+     DrainIntPostRings
+ Parameters
+     none
+ Returns
+     none
+ Description
+     moves the events posted by interrupts into the service queues
+ Notes
+     If a service queue is full, the rest of that ring is left in place and
+     retried on the next pass, so the ring acts as extra queue space and
+     the order of posts from that interrupt is kept.
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+static void DrainIntPostRings(void)
+{
+  uint8_t         i;
+  ES_IntPostRing_t  *pRing;
+  ES_IntPostEntry_t *pEntry;
+  uint8_t         Tail;
+
+  for (i = 0; i < NUM_INT_POST_RINGS; i++)
+  {
+    pRing = &IntPostRings[i];
+    Tail  = pRing->Tail;
+    while (Tail != pRing->Head)
+    {
+      // don't read the entry until we have seen the new Head
+      _HW_MemoryBarrier();
+      pEntry = &pRing->Entries[Tail & INT_POST_RING_MASK];
+      if (ES_PostToService(pEntry->WhichService, pEntry->Event) != true)
+      {
+        break;  // service queue full, try again next time
+      }
+      Tail++;
+      // the slot is free for the ISR only after we are done with it
+      _HW_MemoryBarrier();
+      pRing->Tail = Tail;
+    }
+  }
+}
+#endif
+
+/****************************************************************************
+ Function
+     ExtendCount
+ Parameters
+     uint32_t High : bits 31 and up of the count, as last updated
+     uint32_t Low : the 32 bit count, read after High
+ Returns
+     uint64_t the full count
+ Description
+     joins a free running 32 bit count to the high part kept for it
+ Notes
+     High overlaps Low by one bit, bit 31. If that bit in Low no longer
+     matches, Low has moved into the next half of its range since High was
+     updated, so High is one behind. As long as High is updated at least
+     once every half wrap of Low, that is the only way they can differ.
+     Both are single words that are only ever written whole, and High is
+     read first, so a reader never needs a critical region and an interrupt
+     landing between the two reads, or between the two writes in the tick
+     interrupt, can't tear the result.
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+static uint64_t ExtendCount(uint32_t High, uint32_t Low)
+{
+  High = UpdateHigh(High, Low);
+  return ((uint64_t)High << 31) | (Low & 0x7FFFFFFFUL);
+}
+
+/****************************************************************************
+ Function
+     UpdateHigh
+ Parameters
+     uint32_t High : bits 31 and up of the count, as last updated
+     uint32_t Low : the current 32 bit count
+ Returns
+     uint32_t bits 31 and up of the current count
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+static uint32_t UpdateHigh(uint32_t High, uint32_t Low)
+{
+  if ((Low >> 31) != (High & 1))
+  {
+    High++;
+  }
+  return High;
+}
+
 #if 0 // moved to terminal.c
 /****************************************************************************
  Function
@@ -9,6 +9,10 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/18/26       karthi24 added ES_CountMatches for the periodic timers
+ 10/18/26       karthi24 test harness checks its results and covers splicing
+ 10/18/26       karthi24 added ES_GetNumEntries for the queue size advisor
+ 10/18/26       karthi24 added ES_SpliceQueueFront for bulk recall
  01/15/12 09:34 jec      converted to use the new C99 types from types.h
  08/09/11 18:16 jec      started coding
 *****************************************************************************/
@@ -227,6 +231,146 @@ bool ES_IsQueueEmpty(ES_Event_t *pBlock)
   return pThisQueue->NumEntries == 0;
 }
 
+/****************************************************************************
+ Function
+   ES_GetNumEntries
+ Parameters
+   ES_Event * pBlock : pointer to the block of memory in use as the Queue
+ Returns
+   uint8_t : number of entries in the Queue
+ Description
+   see above
+ Notes
+   used by ES_QueueStats to track how deep the queues get
+ Author
+   karthi24, 10/18/26
+****************************************************************************/
+uint8_t ES_GetNumEntries(ES_Event_t *pBlock)
+{
+  pQueue_t pThisQueue;
+
+  pThisQueue = (pQueue_t)pBlock;
+  return pThisQueue->NumEntries;
+}
+
+/****************************************************************************
+ Function
+   ES_SpliceQueueFront
+ Parameters
+   ES_Event * pDest : pointer to the block of memory of the Queue to add to
+   ES_Event * pSrc : pointer to the block of memory of the Queue to empty
+ Returns
+   bool : true if the events were moved (or there were none), false if
+          there was not room for all of them
+ Description
+   moves every entry of pSrc to the front of pDest, keeping their order, so
+   that the next DeQueue from pDest returns what would have been the next
+   DeQueue from pSrc. pSrc is left empty.
+ Notes
+   all or nothing: if pDest can't hold them all, neither queue is changed.
+   Done in one critical region rather than one per event, but the copy is
+   O(n) in the number of entries moved, so interrupts are held off for the
+   whole of it.
+ Author
+   karthi24, 10/18/26
+****************************************************************************/
+bool ES_SpliceQueueFront(ES_Event_t *pDest, ES_Event_t *pSrc)
+{
+  pQueue_t  pDestQueue;
+  pQueue_t  pSrcQueue;
+  uint8_t   NumToMove;
+  uint8_t   DestIndex;
+  uint8_t   SrcIndex;
+  uint8_t   i;
+
+  pDestQueue  = (pQueue_t)pDest;
+  pSrcQueue   = (pQueue_t)pSrc;
+#ifdef POST_FROM_INTS
+  EnterCritical();  // save interrupt state, turn ints off
+#endif
+  NumToMove   = pSrcQueue->NumEntries;
+  if ((NumToMove == 0) ||
+      (NumToMove > (pDestQueue->QueueSize - pDestQueue->NumEntries)))
+  {
+#ifdef POST_FROM_INTS
+    ExitCritical();    // restore saved interrupt state
+#endif
+    // nothing to do, or not enough room for all of them
+    return NumToMove == 0;
+  }
+  // back the read point of pDest up to make room for the new entries
+  if (pDestQueue->CurrentIndex >= NumToMove)
+  {
+    DestIndex = pDestQueue->CurrentIndex - NumToMove;
+  }
+  else
+  {
+    DestIndex = pDestQueue->CurrentIndex + pDestQueue->QueueSize - NumToMove;
+  }
+  pDestQueue->CurrentIndex  = DestIndex;
+  SrcIndex                  = pSrcQueue->CurrentIndex;
+  // then copy them in, oldest first
+  for (i = 0; i < NumToMove; i++)
+  {
+    pDest[1 + DestIndex] = pSrc[1 + SrcIndex];
+    if (++DestIndex >= pDestQueue->QueueSize)
+    {
+      DestIndex = 0;
+    }
+    if (++SrcIndex >= pSrcQueue->QueueSize)
+    {
+      SrcIndex = 0;
+    }
+  }
+  pDestQueue->NumEntries    += NumToMove;
+  pSrcQueue->CurrentIndex   = 0;
+  pSrcQueue->NumEntries     = 0;
+#ifdef POST_FROM_INTS
+  ExitCritical();    // restore saved interrupt state
+#endif
+  return true;
+}
+
+/****************************************************************************
+ Function
+   ES_CountMatches
+ Parameters
+   ES_Event * pBlock : pointer to the block of memory in use as the Queue
+   ES_Event Event2Match : the event to look for
+ Returns
+   uint8_t : number of entries in the Queue with the same type & param
+ Description
+   see above
+ Notes
+   used by the periodic timers to find how many events like their timeout
+   will be run before it. Walks the whole queue.
+ Author
+   karthi24, 10/18/26
+****************************************************************************/
+uint8_t ES_CountMatches(ES_Event_t *pBlock, ES_Event_t Event2Match)
+{
+  pQueue_t  pThisQueue;
+  uint8_t   Index;
+  uint8_t   NumMatches = 0;
+  uint8_t   i;
+
+  pThisQueue  = (pQueue_t)pBlock;
+  Index       = pThisQueue->CurrentIndex;
+  for (i = 0; i < pThisQueue->NumEntries; i++)
+  {
+    if ((pBlock[1 + Index].EventType == Event2Match.EventType) &&
+        (pBlock[1 + Index].EventParam == Event2Match.EventParam))
+    {
+      NumMatches++;
+    }
+    if (++Index >= pThisQueue->QueueSize)
+    {
+      Index = 0;
+    }
+  }
+  return NumMatches;
+}
+
 #if 0
 /****************************************************************************
  Function
@@ -262,74 +406,150 @@ void QueueFlushQueue(uint8_t *pBlock)
 #include <stdio.h>
 #include "ES_General.h"
 
-static ES_Event   TestQueue[3 + 1];
-volatile uint8_t  NumLeft; // for debugging visibility
+static ES_Event_t TestQueue[3 + 1];
+static ES_Event_t TestQueue2[3 + 1];
+static uint16_t   NumErrors;
 
-void main(void)
+static void Check(bool Condition, const char *pWhat)
 {
-  ES_Event  MyEvent;
-  bool      bReturn;
+  if (!Condition)
+  {
+    printf("failed: %s\n", pWhat);
+    NumErrors++;
+  }
+}
 
-  ES_InitQueue(TestQueue, ARRAY_SIZE(TestQueue));
-  MyEvent.EventType   = 0;
-  MyEvent.EventParam  = 1;
-  bReturn             = ES_EnQueueFIFO(TestQueue, MyEvent);
-  bReturn             += 1; // keep that sily optimizer away
+// pulls the next event off pBlock and checks its param & the entries left
+static void CheckNext(ES_Event_t *pBlock, uint16_t Param, uint8_t Left)
+{
+  ES_Event_t MyEvent;
+
+  Check(ES_DeQueue(pBlock, &MyEvent) == Left, "entries left after DeQueue");
+  Check(MyEvent.EventParam == Param, "DeQueue order");
+}
+
+static bool AddFIFO(ES_Event_t *pBlock, uint16_t Type, uint16_t Param)
+{
+  ES_Event_t MyEvent;
+
+  MyEvent.EventType   = (ES_EventType_t)Type;
+  MyEvent.EventParam  = Param;
+  return ES_EnQueueFIFO(pBlock, MyEvent);
+}
 
+static bool AddLIFO(ES_Event_t *pBlock, uint16_t Type, uint16_t Param)
+{
+  ES_Event_t MyEvent;
+
+  MyEvent.EventType   = (ES_EventType_t)Type;
+  MyEvent.EventParam  = Param;
+  return ES_EnQueueLIFO(pBlock, MyEvent);
+}
+
+// the host has no interrupts to hold off
+void _HW_EnterCritical(void)
+{}
+
+void _HW_ExitCritical(void)
+{}
+
+int main(void)
+{
+  ES_Event_t  MyEvent;
+  uint8_t     i;
+
+  ES_InitQueue(TestQueue, ARRAY_SIZE(TestQueue));
+  Check(AddFIFO(TestQueue, 0, 1), "FIFO add to an empty queue");
   // Try stuffing one on using the LIFO rule
-  MyEvent.EventType   = 10;
-  MyEvent.EventParam  = 11;
-  bReturn             = ES_EnQueueLIFO(TestQueue, MyEvent);
-  bReturn             += 1; // keep that sily optimizer away
+  Check(AddLIFO(TestQueue, 10, 11), "LIFO add");
 
   // at this point, the events in the queue should be 11,0
   // so pull off the 11, leaving 1 entry
-  NumLeft = ES_DeQueue(TestQueue, &MyEvent);
-  if (NumLeft != 1)
-  {
-    bReturn = 0;
-  }
-
-  MyEvent.EventType   = 2;
-  MyEvent.EventParam  = 3;
-  bReturn             = ES_EnQueueFIFO(TestQueue, MyEvent);
-  bReturn             += 1; // keep that sily optimizer away
-
-  MyEvent.EventType   = 4;
-  MyEvent.EventParam  = 5;
-  bReturn             = ES_EnQueueFIFO(TestQueue, MyEvent);
-  bReturn             += 1; // keep that sily optimizer away
+  CheckNext(TestQueue, 11, 1);
 
+  Check(AddFIFO(TestQueue, 2, 3), "FIFO add");
+  Check(AddFIFO(TestQueue, 4, 5), "FIFO add");
   // queue is now full so this one should fail
-  MyEvent.EventType   = 6;
-  MyEvent.EventParam  = 7;
-  bReturn             = ES_EnQueueFIFO(TestQueue, MyEvent);
-  bReturn             += 1; // keep that sily optimizer away
+  Check(!AddFIFO(TestQueue, 6, 7), "FIFO add to a full queue");
 
   // at this point, the events in the queue should be 0,2,4
   // so pull off the 0, leaving 2 entries
-  NumLeft = ES_DeQueue(TestQueue, &MyEvent);
-  if (NumLeft != 2)
-  {
-    bReturn = 0;
-  }
+  CheckNext(TestQueue, 1, 2);
   // Try stuffing one on using the LIFO rule
-  MyEvent.EventType   = 8;
-  MyEvent.EventParam  = 9;
-  bReturn             = ES_EnQueueLIFO(TestQueue, MyEvent);
-  bReturn             += 1; // keep that sily optimizer away
+  Check(AddLIFO(TestQueue, 8, 9), "LIFO add");
 
   // at this point, the events in the queue should be 8,2,4
   // so pull off the 8, leaving 2 entries
-  NumLeft = ES_DeQueue(TestQueue, &MyEvent);
-  NumLeft += 3; //to keep the compiler from optimizing away the last save
-
-  while (1)
+  CheckNext(TestQueue, 9, 2);
+
+  // now splice 2 events from a second queue in front of the 2 that are left
+  ES_InitQueue(TestQueue2, ARRAY_SIZE(TestQueue2));
+  Check(ES_SpliceQueueFront(TestQueue, TestQueue2), "splice of nothing");
+  Check(ES_GetNumEntries(TestQueue) == 2, "splice of nothing adds nothing");
+  Check(AddFIFO(TestQueue2, 12, 13), "FIFO add");
+  // this one won't fit in TestQueue alongside the other 2, so the splice
+  // should fail and leave both queues alone
+  Check(AddFIFO(TestQueue2, 14, 15), "FIFO add");
+  Check(!ES_SpliceQueueFront(TestQueue, TestQueue2), "splice with no room");
+  Check(ES_GetNumEntries(TestQueue) == 2, "failed splice left the dest");
+  Check(ES_GetNumEntries(TestQueue2) == 2, "failed splice left the source");
+
+  // take the 2 off the main queue, leaving 0, and then the splice fits
+  CheckNext(TestQueue, 3, 1);
+  CheckNext(TestQueue, 5, 0);
+  Check(AddFIFO(TestQueue, 16, 17), "FIFO add");
+  Check(ES_SpliceQueueFront(TestQueue, TestQueue2), "splice");
+
+  // at this point, the events in the queue should be 12,14,16 and
+  // TestQueue2 should be empty
+  Check(ES_IsQueueEmpty(TestQueue2), "splice empties the source");
+  MyEvent.EventType   = 14;
+  MyEvent.EventParam  = 15;
+  Check(ES_CountMatches(TestQueue, MyEvent) == 1, "count of one match");
+  MyEvent.EventType   = 15;
+  Check(ES_CountMatches(TestQueue, MyEvent) == 0, "count matches the type");
+  CheckNext(TestQueue, 13, 2);
+  CheckNext(TestQueue, 15, 1);
+  CheckNext(TestQueue, 17, 0);
+
+  // splice from every starting point of both queues, so the copy wraps
+  // around the end of each of them at some point
+  for (i = 0; i < 9; i++)
   {
-    ;
+    ES_InitQueue(TestQueue, ARRAY_SIZE(TestQueue));
+    ES_InitQueue(TestQueue2, ARRAY_SIZE(TestQueue2));
+    // move the read points along, i % 3 in the dest, i / 3 in the source
+    while (ES_GetNumEntries(TestQueue) < (i % 3))
+    {
+      AddFIFO(TestQueue, 0, 0);
+    }
+    while (ES_GetNumEntries(TestQueue2) < (i / 3))
+    {
+      AddFIFO(TestQueue2, 0, 0);
+    }
+    while (!ES_IsQueueEmpty(TestQueue))
+    {
+      CheckNext(TestQueue, 0, ES_GetNumEntries(TestQueue) - 1);
+    }
+    while (!ES_IsQueueEmpty(TestQueue2))
+    {
+      CheckNext(TestQueue2, 0, ES_GetNumEntries(TestQueue2) - 1);
+    }
+    AddFIFO(TestQueue, 1, 3);
+    AddFIFO(TestQueue2, 1, 1);
+    AddFIFO(TestQueue2, 1, 2);
+    Check(ES_SpliceQueueFront(TestQueue, TestQueue2), "wrapped splice");
+    MyEvent.EventType   = 1;
+    MyEvent.EventParam  = 2;
+    Check(ES_CountMatches(TestQueue, MyEvent) == 1, "wrapped count");
+    CheckNext(TestQueue, 1, 2);
+    CheckNext(TestQueue, 2, 1);
+    CheckNext(TestQueue, 3, 0);
   }
-}
 
+  printf("%u errors\n", NumErrors);
+  return NumErrors != 0;
+}
 #endif
 /*------------------------------- Footnotes -------------------------------*/
 /*------------------------------ End of file ------------------------------*/
@@ -0,0 +1,379 @@
+/****************************************************************************
+ Module
+     ES_QueueStats.c
+
+ Description
+     Keeps a histogram of how deep each service's queue is after every post,
+     and turns it into advice on how big each queue needs to be.
+
+ Notes
+     The framework calls ES_QueueStats_RecordPost from ES_PostToService and
+     ES_PostToServiceLIFO, with the number of entries in the queue once the
+     event has been added, or 0 if the queue was full and the post failed.
+
+     With a queue of size S, a post would have been lost if it found S or
+     more events already waiting, that is if the depth after it would have
+     been more than S. So the smallest size whose share of such posts is no
+     more than QUEUE_STATS_LOSS_PPM is the recommendation. Posts that failed
+     count as lost at any size up to the present one, so a queue that
+     overflowed during the run is recommended one bigger than it is now, and
+     the run should be repeated with that size.
+
+     ES_QueueStats_PrintAdvice writes the results as lines that can be
+     pasted over the SERV_n_QUEUE_SIZE lines in ES_Configure.h. The same
+     code runs on the target and in a host simulation of the services.
+     It follows them with the raw histograms, as comment lines:
+
+       // QD <service> <size> <overflows> <posts at depth 1> ... <16>
+
+     tools/queue_advisor.py reads these from terminal captures. It adds up
+     the histograms of many runs and gives advice for any loss target.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/18/26       karthi24     histograms printed as // QD lines for queue_advisor.py
+ 10/18/26       karthi24     started coding
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_General.h"
+#include "ES_QueueStats.h"
+#include "dbprintf.h"
+
+#ifdef ES_QUEUE_STATS
+
+/*----------------------------- Module Defines ----------------------------*/
+// depths above this share the last histogram entry
+#define MAX_TRACKED_DEPTH 16
+
+/*---------------------------- Module Functions ---------------------------*/
+static uint32_t CountPosts(uint8_t WhichService);
+static void PrintHistogram(uint8_t WhichService);
+
+/*---------------------------- Module Variables ---------------------------*/
+// PostsAtDepth[s][d] counts the posts that left service s with d entries
+static uint32_t PostsAtDepth[NUM_SERVICES][MAX_TRACKED_DEPTH + 1];
+// posts that failed because the queue was full
+static uint32_t Overflows[NUM_SERVICES];
+
+// the sizes in ES_Configure.h
+static uint8_t const ConfiguredSize[NUM_SERVICES] =
+{
+  SERV_0_QUEUE_SIZE
+#if NUM_SERVICES > 1
+  , SERV_1_QUEUE_SIZE
+#endif
+#if NUM_SERVICES > 2
+  , SERV_2_QUEUE_SIZE
+#endif
+#if NUM_SERVICES > 3
+  , SERV_3_QUEUE_SIZE
+#endif
+#if NUM_SERVICES > 4
+  , SERV_4_QUEUE_SIZE
+#endif
+#if NUM_SERVICES > 5
+  , SERV_5_QUEUE_SIZE
+#endif
+#if NUM_SERVICES > 6
+  , SERV_6_QUEUE_SIZE
+#endif
+#if NUM_SERVICES > 7
+  , SERV_7_QUEUE_SIZE
+#endif
+#if NUM_SERVICES > 8
+  , SERV_8_QUEUE_SIZE
+#endif
+#if NUM_SERVICES > 9
+  , SERV_9_QUEUE_SIZE
+#endif
+#if NUM_SERVICES > 10
+  , SERV_10_QUEUE_SIZE
+#endif
+#if NUM_SERVICES > 11
+  , SERV_11_QUEUE_SIZE
+#endif
+#if NUM_SERVICES > 12
+  , SERV_12_QUEUE_SIZE
+#endif
+#if NUM_SERVICES > 13
+  , SERV_13_QUEUE_SIZE
+#endif
+#if NUM_SERVICES > 14
+  , SERV_14_QUEUE_SIZE
+#endif
+#if NUM_SERVICES > 15
+  , SERV_15_QUEUE_SIZE
+#endif
+};
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     ES_QueueStats_RecordPost
+ Parameters
+     uint8_t WhichService : the service that was posted to
+     uint8_t Depth : entries in its queue after the post, 0 if it failed
+ Returns
+     None
+ Description
+     adds one post to the histogram
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+void ES_QueueStats_RecordPost(uint8_t WhichService, uint8_t Depth)
+{
+  if (WhichService >= NUM_SERVICES)
+  {
+    return;
+  }
+  if (Depth == 0)
+  {
+    Overflows[WhichService]++;
+    return;
+  }
+  if (Depth > MAX_TRACKED_DEPTH)
+  {
+    Depth = MAX_TRACKED_DEPTH;
+  }
+  PostsAtDepth[WhichService][Depth]++;
+}
+
+/****************************************************************************
+ Function
+     ES_QueueStats_Reset
+ Parameters
+     None
+ Returns
+     None
+ Description
+     clears the histograms, to start a new measurement run
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+void ES_QueueStats_Reset(void)
+{
+  uint8_t Service;
+  uint8_t Depth;
+
+  for (Service = 0; Service < NUM_SERVICES; Service++)
+  {
+    for (Depth = 0; Depth <= MAX_TRACKED_DEPTH; Depth++)
+    {
+      PostsAtDepth[Service][Depth] = 0;
+    }
+    Overflows[Service] = 0;
+  }
+}
+
+/****************************************************************************
+ Function
+     ES_QueueStats_GetPeak
+ Parameters
+     uint8_t WhichService : the service to report on
+ Returns
+     uint8_t the deepest that the queue has been, 0 if never posted to
+ Description
+     query function for the peak occupancy
+ Notes
+     a queue that overflowed reports its configured size
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+uint8_t ES_QueueStats_GetPeak(uint8_t WhichService)
+{
+  uint8_t Depth;
+
+  if (WhichService >= NUM_SERVICES)
+  {
+    return 0;
+  }
+  for (Depth = MAX_TRACKED_DEPTH; Depth > 0; Depth--)
+  {
+    if (PostsAtDepth[WhichService][Depth] != 0)
+    {
+      return Depth;
+    }
+  }
+  return 0;
+}
+
+/****************************************************************************
+ Function
+     ES_QueueStats_GetPercentile
+ Parameters
+     uint8_t WhichService : the service to report on
+     uint16_t PerThousand : the percentile, in tenths of a percent (999 for
+       the 99.9th percentile)
+ Returns
+     uint8_t the smallest depth that at least that share of the posts left
+     the queue at or below, 0 if there have been no posts
+ Description
+     query function for the occupancy percentiles
+ Notes
+     failed posts count as deeper than any depth
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+uint8_t ES_QueueStats_GetPercentile(uint8_t WhichService, uint16_t PerThousand)
+{
+  uint64_t  Needed;
+  uint64_t  SoFar = 0;
+  uint8_t   Depth;
+
+  if (WhichService >= NUM_SERVICES)
+  {
+    return 0;
+  }
+  Needed = (uint64_t)CountPosts(WhichService) * PerThousand;
+  if (Needed == 0)
+  {
+    return 0;
+  }
+  for (Depth = 1; Depth <= MAX_TRACKED_DEPTH; Depth++)
+  {
+    SoFar += PostsAtDepth[WhichService][Depth];
+    if ((SoFar * 1000) >= Needed)
+    {
+      return Depth;
+    }
+  }
+  return MAX_TRACKED_DEPTH;
+}
+
+/****************************************************************************
+ Function
+     ES_QueueStats_Recommend
+ Parameters
+     uint8_t WhichService : the service to report on
+ Returns
+     uint8_t the smallest queue size that would have lost no more than
+     QUEUE_STATS_LOSS_PPM of the posts, at least 1
+ Description
+     the queue size advisor, see the notes at the top of the module
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+uint8_t ES_QueueStats_Recommend(uint8_t WhichService)
+{
+  uint64_t  Allowed;
+  uint64_t  Lost;
+  uint8_t   Size;
+  uint8_t   Depth;
+
+  if (WhichService >= NUM_SERVICES)
+  {
+    return 0;
+  }
+  if (Overflows[WhichService] != 0)
+  {
+    return ConfiguredSize[WhichService] + 1;
+  }
+  Allowed = (uint64_t)CountPosts(WhichService) * QUEUE_STATS_LOSS_PPM;
+  for (Size = 1; Size < MAX_TRACKED_DEPTH; Size++)
+  {
+    // posts that would have found Size or more waiting
+    Lost = 0;
+    for (Depth = Size + 1; Depth <= MAX_TRACKED_DEPTH; Depth++)
+    {
+      Lost += PostsAtDepth[WhichService][Depth];
+    }
+    if ((Lost * 1000000) <= Allowed)
+    {
+      return Size;
+    }
+  }
+  return MAX_TRACKED_DEPTH;
+}
+
+/****************************************************************************
+ Function
+     ES_QueueStats_PrintAdvice
+ Parameters
+     None
+ Returns
+     None
+ Description
+     prints the recommended SERV_n_QUEUE_SIZE for every service, as lines
+     for ES_Configure.h, each with the statistics behind it, then the
+     histograms for tools/queue_advisor.py
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+void ES_QueueStats_PrintAdvice(void)
+{
+  uint8_t Service;
+
+  DB_printf("// queue sizes for a loss of no more than %u ppm\r\n",
+      QUEUE_STATS_LOSS_PPM);
+  for (Service = 0; Service < NUM_SERVICES; Service++)
+  {
+    DB_printf("#define SERV_%d_QUEUE_SIZE %d // now %d, peak %d, 99.9%% %d, "
+        "%u posts, %u overflows\r\n", Service,
+        ES_QueueStats_Recommend(Service), ConfiguredSize[Service],
+        ES_QueueStats_GetPeak(Service),
+        ES_QueueStats_GetPercentile(Service, 999),
+        CountPosts(Service), Overflows[Service]);
+  }
+  for (Service = 0; Service < NUM_SERVICES; Service++)
+  {
+    PrintHistogram(Service);
+  }
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/****************************************************************************
+ Function
+     PrintHistogram
+ Parameters
+     uint8_t WhichService : the service to print
+ Returns
+     None
+ Description
+     prints the service's histogram as a // QD line, see the notes at the
+     top of the module
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+static void PrintHistogram(uint8_t WhichService)
+{
+  uint8_t Depth;
+
+  DB_printf("// QD %d %d %u", WhichService, ConfiguredSize[WhichService],
+      Overflows[WhichService]);
+  for (Depth = 1; Depth <= MAX_TRACKED_DEPTH; Depth++)
+  {
+    DB_printf(" %u", PostsAtDepth[WhichService][Depth]);
+  }
+  DB_printf("\r\n");
+}
+
+/****************************************************************************
+ Function
+     CountPosts
+ Parameters
+     uint8_t WhichService : the service to count
+ Returns
+     uint32_t every post recorded for the service, including failures
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+static uint32_t CountPosts(uint8_t WhichService)
+{
+  uint32_t  Total;
+  uint8_t   Depth;
+
+  Total = Overflows[WhichService];
+  for (Depth = 1; Depth <= MAX_TRACKED_DEPTH; Depth++)
+  {
+    Total += PostsAtDepth[WhichService][Depth];
+  }
+  return Total;
+}
+
+#endif /* ES_QUEUE_STATS */
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -0,0 +1,258 @@
+/****************************************************************************
+ Module
+     ES_SMStats.c
+
+ Description
+     Counts, for each state of a state machine, how often it is entered and
+     how long it is active, and how often each transition is taken.
+
+ Notes
+     ES_SMStats_Update is called with the machine's state after every event.
+     It folds the time since the last call into the current visit, and if the
+     state has changed it closes that visit and counts the transition. When
+     the state has not changed this is a read of the framework time and two
+     additions.
+
+     Times come from ES_Timer_GetTime, in ms. The 16 bit difference between
+     updates is added to a 32 bit dwell, so a visit can last as long as it
+     likes as long as the machine sees an event at least every 65 seconds.
+
+     Transition counts stick at 0xFFFF. Self transitions, which leave the
+     state variable unchanged, are not seen.
+
+     Every machine that calls ES_SMStats_Init is added to a list, and
+     ES_SMStats_PrintAll reports on all of them through DB_printf.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/18/26       karthi24     started coding
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_General.h"
+#include "ES_Timers.h"
+#include "ES_SMStats.h"
+#include "dbprintf.h"
+
+#include <stddef.h>
+
+#ifdef ES_SM_STATS
+
+/*---------------------------- Module Functions ---------------------------*/
+static void PrintStateName(ES_SMStats_t *pStats, uint8_t State);
+
+/*---------------------------- Module Variables ---------------------------*/
+// the machines that have called ES_SMStats_Init
+static ES_SMStats_t *pFirstMachine;
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     ES_SMStats_Init
+ Parameters
+     ES_SMStats_t * pStats : the statistics, from ES_SM_STATS_DEFINE
+     const char * pName : the machine's name, for the report
+     const char * const * pStateNames : NumStates state names, or NULL
+     uint8_t InitialState : the state the machine starts in
+ Returns
+     None
+ Description
+     clears the statistics, starts the first visit and adds the machine to
+     the ones reported by ES_SMStats_PrintAll
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+void ES_SMStats_Init(ES_SMStats_t *pStats, const char *pName,
+    const char * const *pStateNames, uint8_t InitialState)
+{
+  ES_SMStats_t  *pMachine;
+  uint16_t      i;
+
+  for (i = 0; i < pStats->NumStates; i++)
+  {
+    pStats->pStates[i].Entries    = 0;
+    pStats->pStates[i].TotalDwell = 0;
+    pStats->pStates[i].MaxDwell   = 0;
+  }
+  for (i = 0; i < (uint16_t)pStats->NumStates * pStats->NumStates; i++)
+  {
+    pStats->pTransitions[i] = 0;
+  }
+  pStats->pName       = pName;
+  pStats->pStateNames = pStateNames;
+  pStats->Current     = InitialState;
+  pStats->LastSample  = ES_Timer_GetTime();
+  pStats->Dwell       = 0;
+  if (InitialState < pStats->NumStates)
+  {
+    pStats->pStates[InitialState].Entries = 1;
+  }
+
+  // a machine that is initialized again is already on the list
+  for (pMachine = pFirstMachine; pMachine != NULL; pMachine = pMachine->pNext)
+  {
+    if (pMachine == pStats)
+    {
+      return;
+    }
+  }
+  pStats->pNext = pFirstMachine;
+  pFirstMachine = pStats;
+}
+
+/****************************************************************************
+ Function
+     ES_SMStats_Update
+ Parameters
+     ES_SMStats_t * pStats : the machine's statistics
+     uint8_t State : the machine's state now
+ Returns
+     None
+ Description
+     adds the time since the last update to the current visit, and if the
+     state has changed, closes the visit and counts the transition
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+void ES_SMStats_Update(ES_SMStats_t *pStats, uint8_t State)
+{
+  ES_SMStateStats_t *pLeaving;
+  uint16_t          *pCount;
+  uint16_t          Now;
+
+  Now = ES_Timer_GetTime();
+  pStats->Dwell      += (uint16_t)(Now - pStats->LastSample);
+  pStats->LastSample  = Now;
+
+  if ((State == pStats->Current) || (State >= pStats->NumStates))
+  {
+    return;
+  }
+  if (pStats->Current < pStats->NumStates)
+  {
+    pLeaving = &pStats->pStates[pStats->Current];
+    pLeaving->TotalDwell += pStats->Dwell;
+    if (pStats->Dwell > pLeaving->MaxDwell)
+    {
+      pLeaving->MaxDwell = pStats->Dwell;
+    }
+    pCount = &pStats->pTransitions[
+        (uint16_t)pStats->Current * pStats->NumStates + State];
+    if (*pCount != 0xFFFF)
+    {
+      (*pCount)++;
+    }
+  }
+  pStats->pStates[State].Entries++;
+  pStats->Current = State;
+  pStats->Dwell   = 0;
+}
+
+/****************************************************************************
+ Function
+     ES_SMStats_Print
+ Parameters
+     ES_SMStats_t * pStats : the machine's statistics
+ Returns
+     None
+ Description
+     prints the entries and dwell times of every state that has been
+     entered, then every transition that has been taken
+ Notes
+     the visit in progress is shown separately, not in the totals
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+void ES_SMStats_Print(ES_SMStats_t *pStats)
+{
+  uint8_t   From;
+  uint8_t   To;
+  uint16_t  Count;
+
+  DB_printf("%s: in ", pStats->pName);
+  PrintStateName(pStats, pStats->Current);
+  DB_printf(" for %u ms\r\n", pStats->Dwell);
+  for (From = 0; From < pStats->NumStates; From++)
+  {
+    if (pStats->pStates[From].Entries == 0)
+    {
+      continue;
+    }
+    DB_printf("  ");
+    PrintStateName(pStats, From);
+    DB_printf(": %u entries, %u ms total, %u ms max\r\n",
+        pStats->pStates[From].Entries, pStats->pStates[From].TotalDwell,
+        pStats->pStates[From].MaxDwell);
+  }
+  for (From = 0; From < pStats->NumStates; From++)
+  {
+    for (To = 0; To < pStats->NumStates; To++)
+    {
+      Count = pStats->pTransitions[(uint16_t)From * pStats->NumStates + To];
+      if (Count == 0)
+      {
+        continue;
+      }
+      DB_printf("  ");
+      PrintStateName(pStats, From);
+      DB_printf(" -> ");
+      PrintStateName(pStats, To);
+      DB_printf(": %u\r\n", Count);
+    }
+  }
+}
+
+/****************************************************************************
+ Function
+     ES_SMStats_PrintAll
+ Parameters
+     None
+ Returns
+     None
+ Description
+     ES_SMStats_Print for every machine that has called ES_SMStats_Init
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+void ES_SMStats_PrintAll(void)
+{
+  ES_SMStats_t *pMachine;
+
+  for (pMachine = pFirstMachine; pMachine != NULL; pMachine = pMachine->pNext)
+  {
+    ES_SMStats_Print(pMachine);
+  }
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/****************************************************************************
+ Function
+     PrintStateName
+ Parameters
+     ES_SMStats_t * pStats : the machine's statistics
+     uint8_t State : the state to name
+ Returns
+     None
+ Description
+     prints the state's name, or its number if the machine has no names
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+static void PrintStateName(ES_SMStats_t *pStats, uint8_t State)
+{
+  if (pStats->pStateNames != NULL)
+  {
+    DB_printf("%s", pStats->pStateNames[State]);
+  }
+  else
+  {
+    DB_printf("%d", State);
+  }
+}
+
+#endif /* ES_SM_STATS */
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -0,0 +1,510 @@
+/****************************************************************************
+ Module
+     ES_Shell.c
+
+ Description
+     A line oriented command shell on the terminal. Characters are echoed
+     and collected into a line, with backspace, and a complete line is split
+     into words and handed to the registered command named by the first word.
+
+ Notes
+     Runs as a service. Check4Keystroke posts ES_SHELL_RX when the terminal
+     has received characters, and each ES_SHELL_RX takes characters until
+     one line has been run, or there are no more. Since the event checkers
+     only run with every queue empty, a pasted script is run one line at a
+     time, with the events that each line caused processed before the next.
+     The characters wait in the terminal's receive buffer meanwhile, so
+     nothing is lost as long as the script fits in RECV_BUFFER_SIZE.
+
+     A line of a single character that is not a command is posted to every
+     service as ES_NEW_KEY, so the one key test commands still work, with
+     an enter after the key.
+
+     SHELL_LINE_SIZE, SHELL_MAX_ARGS & SHELL_MAX_COMMANDS are set in
+     ES_Configure.h.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/18/26       karthi24     started coding
+****************************************************************************/
+
+/*----------------------------- Include Files -----------------------------*/
+#include <string.h>
+
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "ES_Shell.h"
+#include "terminal.h"
+#include "dbprintf.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define SHELL_PROMPT "> "
+
+// the DEL that most terminals send for the backspace key
+#define ASCII_DEL 0x7F
+
+/*---------------------------- Module Functions ---------------------------*/
+static bool AddChar(char NewChar);
+static void RunLine(void);
+static const ES_ShellCommand_t *FindCommand(const char *Name);
+static void HelpCmd(uint8_t argc, char *argv[]);
+
+/*---------------------------- Module Variables ---------------------------*/
+static uint8_t MyPriority;
+
+static const ES_ShellCommand_t *Commands[SHELL_MAX_COMMANDS];
+static uint8_t NumCommands;
+
+// the line being typed, with room for the terminating null
+static char    Line[SHELL_LINE_SIZE];
+static uint8_t LineLength;
+// set when the line outgrew Line, it is thrown away at its end
+static bool    LineTooLong;
+// so that the \n of a \r\n doesn't end a second, empty, line
+static bool    LastWasCR;
+
+static const ES_ShellCommand_t HelpCommand =
+    { "help", "help, list the commands", HelpCmd };
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     ES_Shell_AddCommand
+ Parameters
+     const ES_ShellCommand_t * : the command to add
+ Returns
+     bool, false if the table is full or the name is already taken
+ Description
+     adds a command to the shell
+ Notes
+     only the pointer is kept
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+bool ES_Shell_AddCommand(const ES_ShellCommand_t *pCommand)
+{
+  if ((NumCommands >= SHELL_MAX_COMMANDS) ||
+      (FindCommand(pCommand->Name) != NULL))
+  {
+    return false;
+  }
+  Commands[NumCommands++] = pCommand;
+  return true;
+}
+
+/****************************************************************************
+ Function
+     InitShellService
+ Parameters
+     uint8_t : the priority of this service
+ Returns
+     bool, false if error in initialization, true otherwise
+ Description
+     registers the help command and posts the initial transition
+ Notes
+     the other modules may add their commands before or after this runs
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+bool InitShellService(uint8_t Priority)
+{
+  ES_Event_t ThisEvent;
+
+  MyPriority  = Priority;
+  LineLength  = 0;
+  LineTooLong = false;
+  LastWasCR   = false;
+  ES_Shell_AddCommand(&HelpCommand);
+
+  ThisEvent.EventType = ES_INIT;
+  return ES_PostToService(MyPriority, ThisEvent);
+}
+
+/****************************************************************************
+ Function
+     PostShellService
+ Parameters
+     ES_Event_t ThisEvent : the event to post to the queue
+ Returns
+     bool false if the Enqueue operation failed, true otherwise
+ Description
+     Posts an event to this service's queue
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+bool PostShellService(ES_Event_t ThisEvent)
+{
+  return ES_PostToService(MyPriority, ThisEvent);
+}
+
+/****************************************************************************
+ Function
+     RunShellService
+ Parameters
+     ES_Event_t : the event to process
+ Returns
+     ES_Event_t, ES_NO_EVENT
+ Description
+     on ES_SHELL_RX, takes received characters until a line has been run
+     or there are no more
+ Notes
+     characters left over after a line wait for the next ES_SHELL_RX
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+ES_Event_t RunShellService(ES_Event_t ThisEvent)
+{
+  ES_Event_t ReturnEvent;
+
+  ReturnEvent.EventType = ES_NO_EVENT;
+
+  switch (ThisEvent.EventType)
+  {
+    case ES_INIT:
+    {
+      printf("\r\n" SHELL_PROMPT);
+    }
+    break;
+
+    case ES_SHELL_RX:
+    {
+      while (Terminal_IsRxData())
+      {
+        if (AddChar((char)Terminal_ReadByte()))
+        {
+          RunLine();
+          break;
+        }
+      }
+    }
+    break;
+
+    default:
+    {}
+    break;
+  }
+  return ReturnEvent;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/****************************************************************************
+ Function
+     AddChar
+ Parameters
+     char : the character that was received
+ Returns
+     bool, true when the character ended a line
+ Description
+     adds a character to the line, echoing it
+ Notes
+     characters past the end of Line are dropped, and mark the line as too
+     long to run
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+static bool AddChar(char NewChar)
+{
+  if ((NewChar == '\n') && LastWasCR)
+  {
+    LastWasCR = false;
+    return false;
+  }
+  LastWasCR = (NewChar == '\r');
+
+  if ((NewChar == '\r') || (NewChar == '\n'))
+  {
+    printf("\r\n");
+    return true;
+  }
+  if ((NewChar == '\b') || (NewChar == ASCII_DEL))
+  {
+    if (LineLength > 0)
+    {
+      LineLength--;
+      printf("\b \b");
+    }
+  }
+  else if ((NewChar >= ' ') && (NewChar < ASCII_DEL))
+  {
+    if (LineLength < (SHELL_LINE_SIZE - 1))
+    {
+      Line[LineLength++] = NewChar;
+      printf("%c", NewChar);
+    }
+    else
+    {
+      LineTooLong = true;
+    }
+  }
+  // other control characters are ignored
+  return false;
+}
+
+/****************************************************************************
+ Function
+     RunLine
+ Parameters
+     None
+ Returns
+     None
+ Description
+     splits the line into words, runs the command & starts a new line
+ Notes
+     spaces & tabs separate the words. Words past SHELL_MAX_ARGS are
+     dropped.
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+static void RunLine(void)
+{
+  char    *Args[SHELL_MAX_ARGS];
+  uint8_t NumArgs = 0;
+  char    *pNext;
+  const ES_ShellCommand_t *pCommand;
+
+  Line[LineLength] = '\0';
+  if (LineTooLong)
+  {
+    printf("line too long, the limit is %d\r\n", SHELL_LINE_SIZE - 1);
+  }
+  else
+  {
+    pNext = Line;
+    while (NumArgs < SHELL_MAX_ARGS)
+    {
+      while ((*pNext == ' ') || (*pNext == '\t'))
+      {
+        *pNext++ = '\0';
+      }
+      if (*pNext == '\0')
+      {
+        break;
+      }
+      Args[NumArgs++] = pNext;
+      while ((*pNext != '\0') && (*pNext != ' ') && (*pNext != '\t'))
+      {
+        pNext++;
+      }
+    }
+    // null terminate the last word, if there were words left over
+    *pNext = '\0';
+
+    if (NumArgs > 0)
+    {
+      pCommand = FindCommand(Args[0]);
+      if (pCommand != NULL)
+      {
+        pCommand->Func(NumArgs, Args);
+      }
+      else if ((NumArgs == 1) && (Args[0][1] == '\0'))
+      {
+        ES_Event_t KeyEvent;
+
+        KeyEvent.EventType  = ES_NEW_KEY;
+        KeyEvent.EventParam = (uint8_t)Args[0][0];
+        ES_PostAll(KeyEvent);
+      }
+      else
+      {
+        printf("unknown command %s, try help\r\n", Args[0]);
+      }
+    }
+  }
+  LineLength  = 0;
+  LineTooLong = false;
+  printf(SHELL_PROMPT);
+}
+
+/****************************************************************************
+ Function
+     FindCommand
+ Parameters
+     const char * : the command name
+ Returns
+     const ES_ShellCommand_t *, NULL if there is no command by that name
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+static const ES_ShellCommand_t *FindCommand(const char *Name)
+{
+  uint8_t i;
+
+  for (i = 0; i < NumCommands; i++)
+  {
+    if (strcmp(Commands[i]->Name, Name) == 0)
+    {
+      return Commands[i];
+    }
+  }
+  return NULL;
+}
+
+/****************************************************************************
+ Function
+     HelpCmd
+ Parameters
+     uint8_t, char *[] : the words of the line, not used
+ Returns
+     None
+ Description
+     the help command, lists the commands
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+static void HelpCmd(uint8_t argc, char *argv[])
+{
+  uint8_t i;
+
+  (void)argc;
+  (void)argv;
+  for (i = 0; i < NumCommands; i++)
+  {
+    printf("%s\r\n", Commands[i]->Help);
+  }
+}
+
+#ifdef TEST
+/****************************************************************************
+ Host test. The terminal is a string of received characters, and commands
+ record the words that they were called with. Runs a script with \r, \n &
+ \r\n line endings, backspaces, extra spaces, an overlong line and single
+ key lines, one ES_SHELL_RX at a time as the event checker would post them.
+ ****************************************************************************/
+#include <stdio.h>
+
+#undef printf
+
+static const char *RxNext;
+static char       Called[128];
+static uint8_t    NumKeys;
+static char       LastKey;
+
+bool Terminal_IsRxData(void)
+{
+  return *RxNext != '\0';
+}
+
+uint8_t Terminal_ReadByte(void)
+{
+  return (uint8_t)*RxNext++;
+}
+
+// the echo isn't checked
+void DB_printf(const char *Format, ...)
+{
+  (void)Format;
+}
+
+bool ES_PostToService(uint8_t WhichService, ES_Event_t ThisEvent)
+{
+  (void)WhichService;
+  (void)ThisEvent;
+  return true;
+}
+
+bool ES_PostAll(ES_Event_t ThisEvent)
+{
+  if (ThisEvent.EventType == ES_NEW_KEY)
+  {
+    NumKeys++;
+    LastKey = (char)ThisEvent.EventParam;
+  }
+  return true;
+}
+
+static void RecordCmd(uint8_t argc, char *argv[])
+{
+  uint8_t i;
+
+  Called[0] = '\0';
+  for (i = 0; i < argc; i++)
+  {
+    strcat(Called, argv[i]);
+    strcat(Called, "|");
+  }
+}
+
+static const ES_ShellCommand_t RiseCommand = { "rise", "", RecordCmd };
+static const ES_ShellCommand_t BeamCommand = { "beam", "", RecordCmd };
+
+// runs lines until the input is used up, returns the number run
+static uint8_t RunInput(const char *Input)
+{
+  ES_Event_t RxEvent = { ES_SHELL_RX, 0 };
+  uint8_t    NumLines = 0;
+
+  RxNext = Input;
+  while (Terminal_IsRxData())
+  {
+    RunShellService(RxEvent);
+    NumLines++;
+  }
+  return NumLines;
+}
+
+static uint16_t NumErrors;
+
+static void Expect(const char *Input, const char *Expected)
+{
+  Called[0] = '\0';
+  RunInput(Input);
+  if (strcmp(Called, Expected) != 0)
+  {
+    printf("\"%s\" called \"%s\", not \"%s\"\n", Input, Called, Expected);
+    NumErrors++;
+  }
+}
+
+int main(void)
+{
+  char LongLine[SHELL_LINE_SIZE + 10];
+
+  InitShellService(0);
+  ES_Shell_AddCommand(&RiseCommand);
+  ES_Shell_AddCommand(&BeamCommand);
+  if (ES_Shell_AddCommand(&BeamCommand))
+  {
+    printf("added a command twice\n");
+    NumErrors++;
+  }
+
+  Expect("rise 1\r", "rise|1|");
+  Expect("  rise\t 2  3 \n", "rise|2|3|");
+  Expect("beam\r\n", "beam|");
+  Expect("bx\beam\r", "beam|");
+  Expect("rise 1 2 3 4 5 6 7 8 9\r", "rise|1|2|3|4|5|6|7|");
+  Expect("\r\n\r\n", "");
+  Expect("rise", "");
+  Expect(" 3\r", "rise|3|");
+
+  memset(LongLine, 'a', sizeof(LongLine) - 2);
+  memcpy(LongLine, "rise ", 5);
+  LongLine[sizeof(LongLine) - 2] = '\r';
+  LongLine[sizeof(LongLine) - 1] = '\0';
+  Expect(LongLine, "");
+
+  // one line per ES_SHELL_RX
+  if (RunInput("rise 1\rbeam\rrise 2\r") != 3)
+  {
+    printf("the three lines weren't run one per ES_SHELL_RX\n");
+    NumErrors++;
+  }
+
+  NumKeys = 0;
+  Expect("x\r", "");
+  Expect("nosuch\r", "");
+  if ((NumKeys != 1) || (LastKey != 'x'))
+  {
+    printf("%u keys posted, last %c\n", NumKeys, LastKey);
+    NumErrors++;
+  }
+
+  printf("%u errors\n", NumErrors);
+  return NumErrors != 0;
+}
+#endif /* TEST */
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
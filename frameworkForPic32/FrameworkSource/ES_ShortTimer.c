@@ -1,24 +1,31 @@
-//#define DEBUG
 /****************************************************************************
  Module
    ES_ShortTimer.c
 
  Revision
-   1.0.1
+   2.0.0
 
  Description
    This is a library to provide for the creation of short time-outs
    (shorter than the resolution of the ES_Timer library).
 
  Notes
-   This module uses the Tiva Peripheral Driver Library functions and
-   the ability that it provides to 'hook' a function into an interrupt
-   response routine without modifying the vector table directly.
-   Uses timers A & B on 16/32 bit Timer Module 5
+   Uses Timer4 & Timer5, two of the Type B timers, one per channel. They
+   count the 20MHz PBCLK divided by 16, so one count is 0.8uS and times are
+   given in whole uS. A Type B timer is only 16 bits, 52mS at this rate, so
+   longer times are run as two periods, with the second reloaded from the
+   interrupt. The second period is always at least half the range, so the
+   interrupt has plenty of time to reload it.
+
+   The timers have no one shot mode, so the interrupt turns the timer off.
+   The timeout is posted through SHORT_TIMER_INT_RING (see ES_Configure.h).
+   Both interrupts run at the same priority, so they can share the ring.
 
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/18/26       karthi24 rewritten for the PIC32 on Timer4 & Timer5, with a
+                         host model of the timers for testing
  10/11/15 10:30 jec     first pass
  10/11/15 18:10 jec     converted to post events to the framework
 
@@ -27,161 +34,408 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdbool.h>
-#include "BITDEFS.H"
-
-// the headers to access the GPIO subsystem
-#include "inc/hw_memmap.h"
-#include "inc/hw_types.h"
-#include "inc/hw_gpio.h"
-#include "inc/hw_sysctl.h"
-#include "inc/hw_timer.h"
-#include "inc/hw_ints.h"
-
-// the headers to access the TivaWare Library
-#include "driverlib/sysctl.h"
-#include "driverlib/pin_map.h"
-#include "driverlib/gpio.h"
-#include "driverlib/timer.h"
-#include "driverlib/interrupt.h"
+
+#ifndef TEST
+#include <xc.h>
+#include <sys/attribs.h>
+#endif
 
 // the header to get the timing functions
 #include "ES_ShortTimer.h"
 
 // the framework headers
-#include "ES_Framework.h"
 #include "ES_Configure.h"
+#include "ES_Framework.h"
 
-// module level functions
+/*----------------------------- Module Defines ----------------------------*/
+// TxCON bits, the same for Timer2-5
+#define TCON_ON       0x8000
+#define TCON_TCKPS_16 (4 << 4)    // 1:16 prescale
 
-// define for the timer pre-scaler. this sets the resolution of the
-// timing functions
-// the current values are based on a 40mHz clock rate to give 1uS resolution
-#define PRE_1uS 40
+// 0.8uS per count, 4uS is exactly 5 counts
+#define COUNTS_PER_4US 5
 
-void ShortTimerAHandler(void);
-void ShortTimerBHandler(void);
+// a period is PR + 1 counts, so this is the longest one
+#define MAX_PERIOD 0x10000UL
 
-// module level variables
+// must not be above ES_CRITICAL_IPL, since the interrupts post events
+#define SHORT_TIMER_IPL 3
 
-static uint8_t  Timer_A_Priority  = SHORT_TIMER_UNUSED;
-static uint8_t  Timer_B_Priority  = SHORT_TIMER_UNUSED;
+/*------------------------------ Module Types -----------------------------*/
+// the registers of one channel's timer
+typedef struct
+{
+  volatile unsigned int *pCon;
+  volatile unsigned int *pTmr;
+  volatile unsigned int *pPr;
+  uint32_t              IntMask;  // the timer's bit in IFS0 & IEC0
+}ShortTimerHW_t;
 
-//******************************
-// ES_ShortTimerInit()
-// Initialize the timer subsystem and log the services to which the timeout
-// messages will be posted
-//******************************
-void ES_ShortTimerInit(uint8_t TimeAPrio, uint8_t TimeBPrio)
+/*---------------------------- Module Functions ---------------------------*/
+static void LoadNextPeriod(uint8_t Which);
+static void ShortTimerIntResp(uint8_t Which);
+
+/*---------------------------- Module Variables ---------------------------*/
+#ifndef TEST
+#define INT_FLAG_CLR(Mask) (IFS0CLR = (Mask))
+#define INT_ENABLE(Mask) (IEC0SET = (Mask))
+#define INT_DISABLE(Mask) (IEC0CLR = (Mask))
+
+static ShortTimerHW_t const Channels[SHORT_TIMER_NUM_CHANNELS] =
+{
+  { &T4CON, &TMR4, &PR4, _IFS0_T4IF_MASK },
+  { &T5CON, &TMR5, &PR5, _IFS0_T5IF_MASK }
+};
+#else
+// the host model stands in for the hardware, see the end of the file
+static volatile unsigned int ModelCon[SHORT_TIMER_NUM_CHANNELS];
+static volatile unsigned int ModelTmr[SHORT_TIMER_NUM_CHANNELS];
+static volatile unsigned int ModelPr[SHORT_TIMER_NUM_CHANNELS];
+static uint32_t ModelIFS0;
+static uint32_t ModelIEC0;
+
+#define INT_FLAG_CLR(Mask) (ModelIFS0 &= ~(Mask))
+#define INT_ENABLE(Mask) (ModelIEC0 |= (Mask))
+#define INT_DISABLE(Mask) (ModelIEC0 &= ~(Mask))
+
+static ShortTimerHW_t const Channels[SHORT_TIMER_NUM_CHANNELS] =
 {
-#ifdef DEBUG
-// set up I/O lines for debugging
-  SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOB);
-  GPIOPinTypeGPIOOutput(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1);
-// start with the lines low
-  GPIOPinWrite(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1, BIT0LO & BIT1LO);
+  { &ModelCon[0], &ModelTmr[0], &ModelPr[0], 1UL << 19 },
+  { &ModelCon[1], &ModelTmr[1], &ModelPr[1], 1UL << 24 }
+};
 #endif
 
-// enable the clock to the timer module
-  SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER5);
-// configure as 2 16 bit timers
-  TimerConfigure(TIMER5_BASE, TIMER_CFG_SPLIT_PAIR | TIMER_CFG_A_ONE_SHOT |
-      TIMER_CFG_B_ONE_SHOT);
-// set prescale to get 1uS resolution
-  TimerPrescaleSet(TIMER5_BASE, TIMER_BOTH, PRE_1uS);
-// log the service to which the timeout will be posted
-  Timer_A_Priority  = TimeAPrio;
-  Timer_B_Priority  = TimeBPrio;
+// the service that each channel posts to
+static uint8_t  ChannelPriority[SHORT_TIMER_NUM_CHANNELS] =
+{
+  SHORT_TIMER_UNUSED, SHORT_TIMER_UNUSED
+};
+// counts still to run after the current period, only touched by
+// ES_ShortTimerStart while the channel's interrupt is off, then by the
+// interrupt
+static uint32_t CountsLeft[SHORT_TIMER_NUM_CHANNELS];
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     ES_ShortTimerInit
+ Parameters
+     uint8_t TimeAPrio : the service that channel A's timeouts go to
+     uint8_t TimeBPrio : the service that channel B's timeouts go to
+ Returns
+     None
+ Description
+     sets up Timer4 & Timer5, stopped, and logs the services to which the
+     timeout messages will be posted
+ Notes
+     use SHORT_TIMER_UNUSED for a channel that has no service
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+void ES_ShortTimerInit(uint8_t TimeAPrio, uint8_t TimeBPrio)
+{
+  uint8_t i;
+
+  ChannelPriority[SHORT_TIMER_A] = TimeAPrio;
+  ChannelPriority[SHORT_TIMER_B] = TimeBPrio;
+
+  for (i = 0; i < SHORT_TIMER_NUM_CHANNELS; i++)
+  {
+    INT_DISABLE(Channels[i].IntMask);
+    // off, PBCLK, 16 bit, 1:16
+    *Channels[i].pCon = TCON_TCKPS_16;
+    *Channels[i].pTmr = 0;
+    INT_FLAG_CLR(Channels[i].IntMask);
+    CountsLeft[i] = 0;
+  }
+#ifndef TEST
+  IPC4bits.T4IP = SHORT_TIMER_IPL;
+  IPC5bits.T5IP = SHORT_TIMER_IPL;
+#endif
 }
 
+/****************************************************************************
+ Function
+     ES_ShortTimerStart
+ Parameters
+     uint32_t Which : SHORT_TIMER_A or SHORT_TIMER_B
+     uint16_t TimeoutValue : the time in uS until ES_SHORT_TIMEOUT is posted
+ Returns
+     None
+ Description
+     (re)starts the channel's timer
+ Notes
+     a time of 0 posts the timeout right away. Restarting a running channel
+     cancels its timeout, unless the interrupt has already posted it.
+     Call from a service, not from an interrupt.
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
 void ES_ShortTimerStart(uint32_t Which, uint16_t TimeoutValue)
 {
-  if ((Which != TIMER_A) && (Which != TIMER_B))
+  ShortTimerHW_t const  *pHW;
+  ES_Event_t            ThisEvent;
+
+  if ((Which >= SHORT_TIMER_NUM_CHANNELS) ||
+      (ChannelPriority[Which] == SHORT_TIMER_UNUSED))
   {
     return;
   }
-  // for very short delays. just immediatly post. There is 10us of overhead
-  if (TimeoutValue < 11)
-  {
-    if (Which == TIMER_A)
-    {
-      ShortTimerAHandler();
-    }
-    else
-    {
-      ShortTimerBHandler();
-    }
-  }
-  TimerLoadSet(TIMER5_BASE, Which, TimeoutValue);
+  pHW = &Channels[Which];
 
-  if (Which == TIMER_A) // local enable
-  {
-    TimerIntEnable(TIMER5_BASE, TIMER_TIMA_TIMEOUT);
-    // NVIC Enable
-    IntEnable(INT_TIMER5A_TM4C123);
-  }
-  else
+  // stop the channel before changing it, so its interrupt can't get in
+  INT_DISABLE(pHW->IntMask);
+  *pHW->pCon &= ~TCON_ON;
+  INT_FLAG_CLR(pHW->IntMask);
+
+  if (TimeoutValue == 0)
   {
-    // local enable
-    TimerIntEnable(TIMER5_BASE, TIMER_TIMB_TIMEOUT);
-    // NVIC Enable
-    IntEnable(INT_TIMER5B_TM4C123);
+    ThisEvent.EventType   = ES_SHORT_TIMEOUT;
+    ThisEvent.EventParam  = Which;
+    ES_PostToService(ChannelPriority[Which], ThisEvent);
+    return;
   }
 
-  TimerEnable(TIMER5_BASE, Which);
+  // round to the nearest count
+  CountsLeft[Which] = ((uint32_t)TimeoutValue * COUNTS_PER_4US + 2) / 4;
+  *pHW->pTmr        = 0;
+  LoadNextPeriod(Which);
+  INT_ENABLE(pHW->IntMask);
+  *pHW->pCon |= TCON_ON;
+}
+
+#ifndef TEST
+/****************************************************************************
+ Function
+     ShortTimerAIntHandler
+ Description
+     Timer4 interrupt response, channel A
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+void __ISR(_TIMER_4_VECTOR, IPL3AUTO) ShortTimerAIntHandler(void)
+{
+  ShortTimerIntResp(SHORT_TIMER_A);
+}
+
+/****************************************************************************
+ Function
+     ShortTimerBIntHandler
+ Description
+     Timer5 interrupt response, channel B
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+void __ISR(_TIMER_5_VECTOR, IPL3AUTO) ShortTimerBIntHandler(void)
+{
+  ShortTimerIntResp(SHORT_TIMER_B);
+}
+#endif
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/****************************************************************************
+ Function
+     LoadNextPeriod
+ Parameters
+     uint8_t Which : the channel
+ Returns
+     None
+ Description
+     sets the period register for the next part of the time. When more than
+     one full period is left, this period stops half a range short of the
+     end, so the final period is never short.
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+static void LoadNextPeriod(uint8_t Which)
+{
+  uint32_t Counts;
 
-#ifdef DEBUG
-// raise I/O line to show we started
-  if (Which == TIMER_A)
+  Counts = CountsLeft[Which];
+  if (Counts > MAX_PERIOD)
   {
-    GPIOPinWrite(GPIO_PORTB_BASE, BIT0HI, BIT0HI);
+    Counts -= MAX_PERIOD / 2;
+    if (Counts > MAX_PERIOD)
+    {
+      Counts = MAX_PERIOD;
+    }
   }
-  else
+  CountsLeft[Which]       -= Counts;
+  *Channels[Which].pPr    = Counts - 1;
+}
+
+/****************************************************************************
+ Function
+     ShortTimerIntResp
+ Parameters
+     uint8_t Which : the channel whose timer reached its period
+ Returns
+     None
+ Description
+     starts the next period if there is one, otherwise stops the timer and
+     posts the timeout
+ Notes
+     the timer reset itself to 0 at the end of the period and is still
+     counting, so a new period register value takes effect right away
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+static void ShortTimerIntResp(uint8_t Which)
+{
+  ShortTimerHW_t const  *pHW = &Channels[Which];
+  ES_Event_t            ThisEvent;
+
+  INT_FLAG_CLR(pHW->IntMask);
+  if (CountsLeft[Which] != 0)
   {
-    GPIOPinWrite(GPIO_PORTB_BASE, BIT1HI, BIT1HI);
+    LoadNextPeriod(Which);
+    return;
   }
-#endif
-  return;
+  *pHW->pCon &= ~TCON_ON;
+  INT_DISABLE(pHW->IntMask);
+
+  ThisEvent.EventType   = ES_SHORT_TIMEOUT;
+  ThisEvent.EventParam  = Which;
+  ES_PostFromISR(SHORT_TIMER_INT_RING, ChannelPriority[Which], ThisEvent);
+}
+
+#ifdef TEST
+/****************************************************************************
+ Host test. A model of the Type B timers stands in for the hardware: while
+ ON, TMR counts up once per 0.8uS, and on the count after it equals PR it
+ goes back to 0 and sets the interrupt flag. The interrupt response runs
+ ISR_LATENCY counts after the flag is set, if the interrupt is enabled.
+ Timeouts over the whole range, on both channels at once, are checked for
+ being posted within 1 count, plus the latency, of the time asked for.
+ ****************************************************************************/
+#include <stdlib.h>
+
+#define ISR_LATENCY 3
+
+static uint32_t ModelCount;     // counts since the test started
+static uint32_t PostedAt[SHORT_TIMER_NUM_CHANNELS];
+static uint8_t  NumPosts[SHORT_TIMER_NUM_CHANNELS];
+static uint8_t  LatencyLeft[SHORT_TIMER_NUM_CHANNELS];
+
+bool ES_PostFromISR(uint8_t WhichRing, uint8_t WhichService,
+    ES_Event_t ThisEvent)
+{
+  (void)WhichRing;
+  (void)WhichService;
+  PostedAt[ThisEvent.EventParam] = ModelCount;
+  NumPosts[ThisEvent.EventParam]++;
+  return true;
 }
 
-void ShortTimerAHandler(void)
+bool ES_PostToService(uint8_t WhichService, ES_Event_t ThisEvent)
 {
-  ES_Event_t ThisEvent;
+  return ES_PostFromISR(0, WhichService, ThisEvent);
+}
 
-// start by clearing the source of the interrupt
-  TimerIntClear(TIMER5_BASE, TIMER_TIMA_TIMEOUT);
-#ifdef DEBUG
-// lower I/O line to show we arrived
-  GPIOPinWrite(GPIO_PORTB_BASE, BIT0HI, BIT0LO);
-#endif
+// one 0.8uS count of the peripheral clock
+static void ModelTick(void)
+{
+  uint8_t i;
 
-// post the timeout for this timer
-  ThisEvent.EventType   = ES_SHORT_TIMEOUT;
-  ThisEvent.EventParam  = TIMER_A;
-// protect against timer that was not correctly initialized
-  if (Timer_A_Priority != SHORT_TIMER_UNUSED)
+  ModelCount++;
+  for (i = 0; i < SHORT_TIMER_NUM_CHANNELS; i++)
   {
-    ES_PostToService(Timer_A_Priority, ThisEvent);
+    if (ModelCon[i] & TCON_ON)
+    {
+      if (ModelTmr[i] == ModelPr[i])
+      {
+        ModelTmr[i] = 0;
+        // a flag that is already set doesn't hold the interrupt off longer
+        if (!(ModelIFS0 & Channels[i].IntMask))
+        {
+          ModelIFS0       |= Channels[i].IntMask;
+          LatencyLeft[i]  = ISR_LATENCY;
+        }
+      }
+      else
+      {
+        ModelTmr[i] = (ModelTmr[i] + 1) & 0xFFFF;
+      }
+    }
+    if ((ModelIFS0 & ModelIEC0 & Channels[i].IntMask) &&
+        (LatencyLeft[i]-- == 0))
+    {
+      ShortTimerIntResp(i);
+    }
   }
 }
 
-void ShortTimerBHandler(void)
+int main(void)
 {
-  ES_Event_t ThisEvent;
+  static const uint16_t Fixed[] = { 1, 2, 5, 10, 100, 999, 52428, 52429,
+                                    60000, 65535 };
+  uint16_t  Times[SHORT_TIMER_NUM_CHANNELS];
+  uint32_t  StartedAt;
+  uint32_t  NumErrors = 0;
+  int32_t   ErrorNs;
+  int32_t   WorstNs = 0;
+  uint16_t  Test;
+  uint8_t   i;
 
-// start by clearing the source of the interrupt
-  TimerIntClear(TIMER5_BASE, TIMER_TIMB_TIMEOUT);
-#ifdef DEBUG
-// lower I/O line to show we arrived
-  GPIOPinWrite(GPIO_PORTB_BASE, BIT1HI, BIT1LO);
-#endif
-
-// post the timeout for this timer
-  ThisEvent.EventType   = ES_SHORT_TIMEOUT;
-  ThisEvent.EventParam  = TIMER_B;
-// protect against timer that was not correctly initialized
-  if (Timer_B_Priority != SHORT_TIMER_UNUSED)
+  ES_ShortTimerInit(1, 2);
+  for (Test = 0; Test < 400; Test++)
   {
-    ES_PostToService(Timer_B_Priority, ThisEvent);
+    for (i = 0; i < SHORT_TIMER_NUM_CHANNELS; i++)
+    {
+      Times[i] = (Test < ARRAY_SIZE(Fixed)) ? Fixed[Test] :
+          (uint16_t)(1 + rand() % 65535);
+      NumPosts[i] = 0;
+    }
+    StartedAt = ModelCount;
+    ES_ShortTimerStart(SHORT_TIMER_A, Times[SHORT_TIMER_A]);
+    // start B part way through a count of A, as a service would
+    ModelTick();
+    ES_ShortTimerStart(SHORT_TIMER_B, Times[SHORT_TIMER_B]);
+    while (ModelCount - StartedAt < 90000)
+    {
+      ModelTick();
+    }
+    for (i = 0; i < SHORT_TIMER_NUM_CHANNELS; i++)
+    {
+      // in nS, from the start of the channel to the interrupt response
+      ErrorNs = (int32_t)(PostedAt[i] - StartedAt - i) * 800 -
+          (int32_t)Times[i] * 1000;
+      if (abs(ErrorNs) > abs(WorstNs))
+      {
+        WorstNs = ErrorNs;
+      }
+      if ((NumPosts[i] != 1) || (ModelCon[i] & TCON_ON) ||
+          (abs(ErrorNs) > 800 / 2 + ISR_LATENCY * 800))
+      {
+        printf("channel %u, %u uS: %u posts, %ld nS out\n", i, Times[i],
+            NumPosts[i], (long)ErrorNs);
+        NumErrors++;
+      }
+    }
   }
+  // a restart cancels the timeout that was running
+  ES_ShortTimerStart(SHORT_TIMER_A, 1000);
+  for (Test = 0; Test < 500; Test++)
+  {
+    ModelTick();
+  }
+  NumPosts[SHORT_TIMER_A] = 0;
+  ES_ShortTimerStart(SHORT_TIMER_A, 1000);
+  for (Test = 0; Test < 2000; Test++)
+  {
+    ModelTick();
+  }
+  if (NumPosts[SHORT_TIMER_A] != 1)
+  {
+    printf("restart posted %u times\n", NumPosts[SHORT_TIMER_A]);
+    NumErrors++;
+  }
+  printf("worst error %ld nS (latency %u nS), %lu errors\n", (long)WorstNs,
+      ISR_LATENCY * 800, (unsigned long)NumErrors);
+  return NumErrors != 0;
 }
-
+#endif /* TEST */
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
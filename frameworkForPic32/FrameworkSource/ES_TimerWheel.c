@@ -0,0 +1,589 @@
+/****************************************************************************
+ Module
+     ES_TimerWheel.c
+
+ Description
+     Software timers kept in a hierarchical timing wheel, with handles
+     allocated from a static pool. These add to the 16 numbered timers in
+     ES_Timers.c, for services that need more timers than there are free
+     TIMERn_RESP_FUNC slots.
+
+ Notes
+     The wheel has ES_WHEEL_LEVELS levels of ES_WHEEL_SLOTS slots. A level 0
+     slot is 1 tick long, a level 1 slot is ES_WHEEL_SLOTS ticks long and so
+     on. Each slot holds a doubly linked list of the running timers, so that
+     starting & stopping a timer are constant time.
+
+     A timer goes into the lowest level whose span covers the time it has
+     left, in the slot picked by the matching bits of its expiry time. Every
+     tick, the wheel time advances and the level 0 slot it lands on is
+     emptied, posting a timeout for everything in it. When the level 0 bits of
+     the time roll over to 0, the next level 1 slot is emptied into the lower
+     level first, and likewise for the higher levels. A timer is moved at most
+     once per level, so the cost of a tick does not depend on how many timers
+     are running, only on how many go off.
+
+     The wheel time is a uint32_t and only ever used in differences, so it can
+     wrap.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/18/26       karthi24     wheel updates locked under the threaded executor
+ 10/18/26       karthi24     started coding
+****************************************************************************/
+
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Port.h"
+#include "ES_Events.h"
+#include "ES_Timers.h"
+#include "ES_TimerWheel.h"
+#include "ES_Context.h"
+
+#ifdef ES_USE_TIMER_WHEEL
+
+/*----------------------------- Module Defines ----------------------------*/
+// the end of a list
+#define NIL 0xFF
+
+#define SLOT_MASK (ES_WHEEL_SLOTS - 1)
+
+// the wheel is part of the framework context (see ES_Context.h)
+#define WheelPool (ES_CTX->Wheel.Pool)
+#define WheelSlots (ES_CTX->Wheel.Slots)
+#define WheelFreeList (ES_CTX->Wheel.FreeList)
+#define WheelNumFree (ES_CTX->Wheel.NumFree)
+#define WheelNow (ES_CTX->Wheel.Now)
+
+// with the threaded executor, services on the worker threads start & stop
+// timers while the ES_Run thread ticks them
+#ifdef ES_THREADED_EXECUTOR
+#define TIMER_LOCK() EnterCritical()
+#define TIMER_UNLOCK() ExitCritical()
+#else
+#define TIMER_LOCK()
+#define TIMER_UNLOCK()
+#endif
+
+/*---------------------------- Module Functions ---------------------------*/
+static bool IsAllocated(ES_TimerHandle_t Handle);
+static void LinkTimer(uint8_t Index);
+static void UnlinkTimer(uint8_t Index);
+static void CascadeSlot(uint8_t Slot);
+static void ExpireSlot(uint8_t Slot);
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     ES_TimerWheel_Init
+ Parameters
+     None
+ Returns
+     None
+ Description
+     empties the wheel and puts every timer back in the pool
+ Notes
+     called from ES_Timer_Init, so handles can be allocated in the service
+     init functions
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+void ES_TimerWheel_Init(void)
+{
+  uint16_t i;
+
+  for (i = 0; i < ARRAY_SIZE(WheelSlots); i++)
+  {
+    WheelSlots[i] = NIL;
+  }
+  for (i = 0; i < TIMER_WHEEL_POOL_SIZE; i++)
+  {
+    WheelPool[i].PostFunc = (pPostFunc)0;
+    WheelPool[i].Running  = false;
+    WheelPool[i].Next     = (i + 1 < TIMER_WHEEL_POOL_SIZE) ? i + 1 : NIL;
+  }
+  WheelFreeList = (TIMER_WHEEL_POOL_SIZE > 0) ? 0 : NIL;
+  WheelNumFree  = TIMER_WHEEL_POOL_SIZE;
+  WheelNow      = 0;
+}
+
+/****************************************************************************
+ Function
+     ES_TimerWheel_Alloc
+ Parameters
+     pPostFunc PostFunc : where the timer's ES_TIMEOUT events are to go
+ Returns
+     ES_TimerHandle_t the new timer, or ES_TIMER_NO_HANDLE if the pool is
+     empty or PostFunc is NULL
+ Description
+     takes a stopped timer from the pool
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+ES_TimerHandle_t ES_TimerWheel_Alloc(pPostFunc PostFunc)
+{
+  uint8_t Index;
+
+  if (PostFunc == (pPostFunc)0)
+  {
+    return ES_TIMER_NO_HANDLE;
+  }
+  TIMER_LOCK();
+  Index = WheelFreeList;
+  if (Index != NIL)
+  {
+    WheelFreeList             = WheelPool[Index].Next;
+    WheelNumFree--;
+    WheelPool[Index].PostFunc = PostFunc;
+    WheelPool[Index].Running  = false;
+  }
+  TIMER_UNLOCK();
+  if (Index == NIL)
+  {
+    return ES_TIMER_NO_HANDLE;
+  }
+  return (ES_TimerHandle_t)(Index + ES_NUM_TIMERS);
+}
+
+/****************************************************************************
+ Function
+     ES_TimerWheel_Free
+ Parameters
+     ES_TimerHandle_t Handle : the timer to give back
+ Returns
+     ES_Timer_ERR if Handle is not an allocated timer, ES_Timer_OK otherwise
+ Description
+     stops the timer and returns it to the pool
+ Notes
+     a timeout that was already posted will still be delivered
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+ES_TimerReturn_t ES_TimerWheel_Free(ES_TimerHandle_t Handle)
+{
+  uint8_t Index;
+
+  if (!IsAllocated(Handle))
+  {
+    return ES_Timer_ERR;
+  }
+  Index = Handle - ES_NUM_TIMERS;
+  TIMER_LOCK();
+  if (WheelPool[Index].Running)
+  {
+    UnlinkTimer(Index);
+    WheelPool[Index].Running = false;
+  }
+  WheelPool[Index].PostFunc = (pPostFunc)0;
+  WheelPool[Index].Next     = WheelFreeList;
+  WheelFreeList             = Index;
+  WheelNumFree++;
+  TIMER_UNLOCK();
+  return ES_Timer_OK;
+}
+
+/****************************************************************************
+ Function
+     ES_TimerWheel_Start
+ Parameters
+     ES_TimerHandle_t Handle : the timer to start
+     uint32_t Ticks : how long until it goes off
+ Returns
+     ES_Timer_ERR if Handle is not an allocated timer, or Ticks is 0 or more
+     than ES_TIMER_WHEEL_MAX_TICKS, ES_Timer_OK otherwise
+ Description
+     starts the timer, or restarts it with the new time if it was running
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+ES_TimerReturn_t ES_TimerWheel_Start(ES_TimerHandle_t Handle, uint32_t Ticks)
+{
+  uint8_t Index;
+
+  if (!IsAllocated(Handle) || (Ticks == 0) ||
+      (Ticks > ES_TIMER_WHEEL_MAX_TICKS))
+  {
+    return ES_Timer_ERR;
+  }
+  Index = Handle - ES_NUM_TIMERS;
+  TIMER_LOCK();
+  if (WheelPool[Index].Running)
+  {
+    UnlinkTimer(Index);
+  }
+  WheelPool[Index].Expiry   = WheelNow + Ticks;
+  WheelPool[Index].Running  = true;
+  LinkTimer(Index);
+  TIMER_UNLOCK();
+  return ES_Timer_OK;
+}
+
+/****************************************************************************
+ Function
+     ES_TimerWheel_Stop
+ Parameters
+     ES_TimerHandle_t Handle : the timer to stop
+ Returns
+     ES_Timer_ERR if Handle is not an allocated timer, ES_Timer_OK otherwise
+ Description
+     takes the timer off the wheel. Stopping a stopped timer is not an error.
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+ES_TimerReturn_t ES_TimerWheel_Stop(ES_TimerHandle_t Handle)
+{
+  uint8_t Index;
+
+  if (!IsAllocated(Handle))
+  {
+    return ES_Timer_ERR;
+  }
+  Index = Handle - ES_NUM_TIMERS;
+  TIMER_LOCK();
+  if (WheelPool[Index].Running)
+  {
+    UnlinkTimer(Index);
+    WheelPool[Index].Running = false;
+  }
+  TIMER_UNLOCK();
+  return ES_Timer_OK;
+}
+
+/****************************************************************************
+ Function
+     ES_TimerWheel_IsActive
+ Parameters
+     ES_TimerHandle_t Handle : the timer to check
+ Returns
+     ES_Timer_ERR if Handle is not an allocated timer, ES_Timer_ACTIVE if it
+     is running, ES_Timer_NOT_ACTIVE if not
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+ES_TimerReturn_t ES_TimerWheel_IsActive(ES_TimerHandle_t Handle)
+{
+  if (!IsAllocated(Handle))
+  {
+    return ES_Timer_ERR;
+  }
+  return WheelPool[Handle - ES_NUM_TIMERS].Running ?
+         ES_Timer_ACTIVE : ES_Timer_NOT_ACTIVE;
+}
+
+/****************************************************************************
+ Function
+     ES_TimerWheel_GetNumFree
+ Parameters
+     None
+ Returns
+     uint8_t how many timers are left in the pool
+ Description
+     lets TIMER_WHEEL_POOL_SIZE be checked against what the application uses
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+uint8_t ES_TimerWheel_GetNumFree(void)
+{
+  return WheelNumFree;
+}
+
+/****************************************************************************
+ Function
+     ES_TimerWheel_Tick
+ Parameters
+     None
+ Returns
+     None
+ Description
+     advances the wheel by one tick, moving timers down from the higher
+     levels when their slots come round and posting ES_TIMEOUT, with the
+     handle as the parameter, for every timer that is due
+ Notes
+     called from ES_Timer_Tick_Resp
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+void ES_TimerWheel_Tick(void)
+{
+  uint32_t  Now;
+  uint8_t   Level;
+
+  TIMER_LOCK();
+  Now = ++WheelNow;
+  // find the highest level whose slot changed on this tick
+  Level = 0;
+  while ((Level < ES_WHEEL_LEVELS - 1) &&
+      (((Now >> (ES_WHEEL_SLOT_BITS * Level)) & SLOT_MASK) == 0))
+  {
+    Level++;
+  }
+  // and bring that slot's timers down, from the top, so that a timer can
+  // fall through several levels on the same tick
+  while (Level > 0)
+  {
+    CascadeSlot(Level * ES_WHEEL_SLOTS +
+        ((Now >> (ES_WHEEL_SLOT_BITS * Level)) & SLOT_MASK));
+    Level--;
+  }
+  ExpireSlot(Now & SLOT_MASK);
+  TIMER_UNLOCK();
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/****************************************************************************
+ Function
+     IsAllocated
+ Parameters
+     ES_TimerHandle_t Handle : the handle to check
+ Returns
+     bool true if Handle names a timer that has been allocated
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+static bool IsAllocated(ES_TimerHandle_t Handle)
+{
+  return (Handle >= ES_NUM_TIMERS) &&
+         (Handle < ES_NUM_TIMERS + TIMER_WHEEL_POOL_SIZE) &&
+         (WheelPool[Handle - ES_NUM_TIMERS].PostFunc != (pPostFunc)0);
+}
+
+/****************************************************************************
+ Function
+     LinkTimer
+ Parameters
+     uint8_t Index : the pool entry to put on the wheel
+ Returns
+     None
+ Description
+     adds the timer to the front of the slot for its expiry time, on the
+     lowest level whose span covers the time it has left
+ Notes
+     a timer that is due now goes into the current level 0 slot. The caller
+     holds the timer lock.
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+static void LinkTimer(uint8_t Index)
+{
+  ES_WheelTimer_t *pTimer = &WheelPool[Index];
+  uint32_t        Remaining;
+  uint8_t         Level;
+
+  Remaining = pTimer->Expiry - WheelNow;
+  Level     = 0;
+  while ((Level < ES_WHEEL_LEVELS - 1) &&
+      (Remaining >= (1UL << (ES_WHEEL_SLOT_BITS * (Level + 1)))))
+  {
+    Level++;
+  }
+  pTimer->Slot = Level * ES_WHEEL_SLOTS +
+      ((pTimer->Expiry >> (ES_WHEEL_SLOT_BITS * Level)) & SLOT_MASK);
+
+  pTimer->Prev = NIL;
+  pTimer->Next = WheelSlots[pTimer->Slot];
+  if (pTimer->Next != NIL)
+  {
+    WheelPool[pTimer->Next].Prev = Index;
+  }
+  WheelSlots[pTimer->Slot] = Index;
+}
+
+/****************************************************************************
+ Function
+     UnlinkTimer
+ Parameters
+     uint8_t Index : the pool entry to take off the wheel
+ Returns
+     None
+ Notes
+     the caller holds the timer lock
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+static void UnlinkTimer(uint8_t Index)
+{
+  ES_WheelTimer_t *pTimer = &WheelPool[Index];
+
+  if (pTimer->Prev == NIL)
+  {
+    WheelSlots[pTimer->Slot] = pTimer->Next;
+  }
+  else
+  {
+    WheelPool[pTimer->Prev].Next = pTimer->Next;
+  }
+  if (pTimer->Next != NIL)
+  {
+    WheelPool[pTimer->Next].Prev = pTimer->Prev;
+  }
+}
+
+/****************************************************************************
+ Function
+     CascadeSlot
+ Parameters
+     uint8_t Slot : the higher level slot that has come round
+ Returns
+     None
+ Description
+     empties the slot, re-linking each timer at the level that now suits it
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+static void CascadeSlot(uint8_t Slot)
+{
+  uint8_t Index;
+  uint8_t Next;
+
+  Index             = WheelSlots[Slot];
+  WheelSlots[Slot]  = NIL;
+  while (Index != NIL)
+  {
+    Next = WheelPool[Index].Next;
+    LinkTimer(Index);
+    Index = Next;
+  }
+}
+
+/****************************************************************************
+ Function
+     ExpireSlot
+ Parameters
+     uint8_t Slot : the level 0 slot for the current tick
+ Returns
+     None
+ Description
+     empties the slot, stopping each timer and posting its timeout
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+static void ExpireSlot(uint8_t Slot)
+{
+  ES_Event_t  NewEvent;
+  uint8_t     Index;
+  uint8_t     Next;
+
+  NewEvent.EventType  = ES_TIMEOUT;
+  Index               = WheelSlots[Slot];
+  WheelSlots[Slot]    = NIL;
+  while (Index != NIL)
+  {
+    Next                      = WheelPool[Index].Next;
+    WheelPool[Index].Running  = false;
+    NewEvent.EventParam       = Index + ES_NUM_TIMERS;
+    WheelPool[Index].PostFunc(NewEvent);
+    Index = Next;
+  }
+}
+
+#endif /* ES_USE_TIMER_WHEEL */
+
+#ifdef TEST
+/****************************************************************************
+ Host test. Every timer in the pool is started with a random time, some are
+ stopped or restarted along the way, and the tick each timeout arrives on is
+ checked against the tick it was due. Build with -DES_USE_TIMER_WHEEL.
+ ****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+
+ES_Context_t ES_DefaultContext;
+
+#define NUM_TEST_TICKS 3000000UL
+
+static uint32_t TestTick;
+static uint32_t DueAt[TIMER_WHEEL_POOL_SIZE];   // 0 when not running
+static uint32_t NumErrors;
+static uint32_t NumTimeouts;
+
+static bool TestPost(ES_Event_t ThisEvent)
+{
+  uint8_t Index = ThisEvent.EventParam - ES_NUM_TIMERS;
+
+  NumTimeouts++;
+  if ((ThisEvent.EventType != ES_TIMEOUT) || (DueAt[Index] != TestTick))
+  {
+    printf("timer %u went off at %lu, due at %lu\n", Index,
+        (unsigned long)TestTick, (unsigned long)DueAt[Index]);
+    NumErrors++;
+  }
+  DueAt[Index] = 0;
+  return true;
+}
+
+static uint32_t RandomTicks(void)
+{
+  // mostly short times, with some that need every level of the wheel
+  switch (rand() % 4)
+  {
+    case 0:   return 1 + rand() % 64;
+    case 1:   return 1 + rand() % 4096;
+    case 2:   return 1 + rand() % 262144;
+    default:  return 1 + rand() % 2000000;
+  }
+}
+
+int main(void)
+{
+  ES_TimerHandle_t  Handles[TIMER_WHEEL_POOL_SIZE];
+  uint32_t          Ticks;
+  uint8_t           i;
+
+  ES_TimerWheel_Init();
+  // start the wheel just short of a wrap of its time
+  ES_DefaultContext.Wheel.Now = 0xFFFFFFFFUL - 1000000UL;
+  for (i = 0; i < TIMER_WHEEL_POOL_SIZE; i++)
+  {
+    Handles[i] = ES_TimerWheel_Alloc(TestPost);
+  }
+  if ((ES_TimerWheel_Alloc(TestPost) != ES_TIMER_NO_HANDLE) ||
+      (ES_TimerWheel_GetNumFree() != 0) ||
+      (ES_TimerWheel_Start(Handles[0], 0) != ES_Timer_ERR) ||
+      (ES_TimerWheel_Start(0, 10) != ES_Timer_ERR))
+  {
+    printf("argument checks failed\n");
+    NumErrors++;
+  }
+
+  for (TestTick = 1; TestTick <= NUM_TEST_TICKS; TestTick++)
+  {
+    i = rand() % TIMER_WHEEL_POOL_SIZE;
+    if ((DueAt[i] == 0) || ((rand() % 8) == 0))
+    {
+      // (re)start a timer
+      Ticks = RandomTicks();
+      ES_TimerWheel_Start(Handles[i], Ticks);
+      DueAt[i] = TestTick - 1 + Ticks;
+    }
+    else if ((rand() % 64) == 0)
+    {
+      ES_TimerWheel_Stop(Handles[i]);
+      DueAt[i] = 0;
+    }
+    ES_TimerWheel_Tick();
+  }
+  for (i = 0; i < TIMER_WHEEL_POOL_SIZE; i++)
+  {
+    if ((ES_TimerWheel_IsActive(Handles[i]) == ES_Timer_ACTIVE) !=
+        (DueAt[i] != 0))
+    {
+      printf("timer %u active state is wrong\n", i);
+      NumErrors++;
+    }
+    ES_TimerWheel_Free(Handles[i]);
+  }
+  if (ES_TimerWheel_GetNumFree() != TIMER_WHEEL_POOL_SIZE)
+  {
+    printf("pool not full after freeing\n");
+    NumErrors++;
+  }
+  printf("%lu timeouts, %lu errors\n", (unsigned long)NumTimeouts,
+      (unsigned long)NumErrors);
+  return NumErrors != 0;
+}
+#endif /* TEST */
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -3,7 +3,7 @@
      ES_Timers.c
 
  Description
-     This is a module implementing  8 16 bit timers all using the RTI
+     This is a module implementing 16 32 bit timers all using the RTI
      timebase
 
  Notes
@@ -13,6 +13,23 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/18/26       karthi24 a periodic timer waits only for a timeout that was
+                         queued, counting the events like it queued ahead
+ 10/18/26       karthi24 a callback timer needs no response function
+ 10/18/26       karthi24 timers with a callback call it from the tick response,
+                         timed against TIMER_CALLBACK_MAX_US
+ 10/18/26       karthi24 timers post the event given by ES_Timer_SetEvent,
+                         periodic timers' deliveries matched by ES_Timer_EventDelivered
+ 10/18/26       karthi24 added ES_Timer_GetRemaining & ES_Timer_StartAt
+ 10/18/26       karthi24 timers with slack are held back to go off together
+                         with other timeouts, with wake-up statistics
+ 10/18/26       karthi24 added periodic timers, reloaded in the tick response
+ 10/18/26       karthi24 timers widened to 32 bits, added ES_Timer_GetTime64 &
+                         ES_Timer_GetMicros64
+ 10/18/26       karthi24 ticks & initializes the timing wheel too
+ 10/18/26       karthi24 timer updates locked under the threaded executor
+ 10/18/26       karthi24 timer state now lives in the current framework context,
+                         tick response scratch variables made automatic
  10/27/14 14:02 jec      moved ticking of 'time' to ES_Port to allow it to tick
                          even while blocking. required change to ES_GetTime too
  10/20/13 10:48 jec      moved definition of BITS_PER_BYTE to ES_General.h
@@ -50,48 +67,57 @@
 #include "../FrameworkHeaders/ES_LookupTables.h"
 #include "../FrameworkHeaders/ES_Timers.h"
 #include "../FrameworkHeaders/ES_Port.h"
+#include "../FrameworkHeaders/ES_Context.h"
+#include "../FrameworkHeaders/ES_TimerWheel.h"
 /*--------------------------- External Variables --------------------------*/
 
 /*----------------------------- Module Defines ----------------------------*/
 
-/*------------------------------ Module Types -----------------------------*/
+// the timers and their active flags are part of the framework context (see
+// ES_Context.h), these keep the code reading as it always has
+#define TMR_TimerArray (ES_CTX->Timers.TimerArray)
+#define TMR_ActiveFlags (ES_CTX->Timers.ActiveFlags)
+#define TMR_Periods (ES_CTX->Timers.Periods)
+#define TMR_PendingFlags (ES_CTX->Timers.PendingFlags)
+#define TMR_Overruns (ES_CTX->Timers.Overruns)
+#define TMR_PendingService (ES_CTX->Timers.PendingService)
+#define TMR_PendingCount (ES_CTX->Timers.PendingCount)
+#define TMR_Slack (ES_CTX->Timers.Slack)
+#define TMR_DueFlags (ES_CTX->Timers.DueFlags)
+#define TMR_SlackLeft (ES_CTX->Timers.SlackLeft)
+#define TMR_Expirations (ES_CTX->Timers.Expirations)
+#define TMR_Wakeups (ES_CTX->Timers.Wakeups)
+#define TMR_Events (ES_CTX->Timers.Events)
+#define TMR_Callbacks (ES_CTX->Timers.Callbacks)
+#define TMR_MaxCallbackTicks (ES_CTX->Timers.MaxCallbackTicks)
+#define TMR_SlowestCallback (ES_CTX->Timers.SlowestCallback)
+#define TMR_LongCallbacks (ES_CTX->Timers.LongCallbacks)
 
-/*
-   the size of Tflag sets the number of timers, uint8 = 8, uint16 = 16 ...)
-   to add more timers, you will need to change the data type and modify
-   the initialization of TMR_TimerArray and TMR_MaskArray
-*/
+// callbacks that take longer than this are counted in LongCallbacks
+#define CALLBACK_MAX_TICKS (TIMER_CALLBACK_MAX_US * CORE_TICKS_PER_US)
 
-typedef uint16_t Tflag_t;
+// with the threaded executor, services on the worker threads start & stop
+// timers while the ES_Run thread ticks them
+#ifdef ES_THREADED_EXECUTOR
+#define TIMER_LOCK() EnterCritical()
+#define TIMER_UNLOCK() ExitCritical()
+#else
+#define TIMER_LOCK()
+#define TIMER_UNLOCK()
+#endif
 
-typedef uint16_t Timer_t; // sets size of timers to 16 bits
+/*------------------------------ Module Types -----------------------------*/
 
 /*---------------------------- Module Functions ---------------------------*/
+static void CountOverrun(uint8_t Num);
+static void PostDueTimers(void);
+static void PostTimeout(uint8_t Num);
+static ES_Event_t TimeoutEvent(uint8_t Num);
+static void RunCallback(uint8_t Num);
+static bool HasResponse(uint8_t Num);
 
 /*---------------------------- Module Variables ---------------------------*/
-static Timer_t TMR_TimerArray[sizeof(Tflag_t) * BITS_PER_BYTE] =
-{
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0,
-  0x0
-};
-
-static Tflag_t TMR_ActiveFlags;
-
-static pPostFunc const Timer2PostFunc[sizeof(Tflag_t) * BITS_PER_BYTE] =
+static pPostFunc const Timer2PostFunc[ES_NUM_TIMERS] =
 {
   TIMER0_RESP_FUNC,
   TIMER1_RESP_FUNC,
@@ -130,6 +156,10 @@ static pPostFunc const Timer2PostFunc[sizeof(Tflag_t) * BITS_PER_BYTE] =
 ****************************************************************************/
 void ES_Timer_Init(TimerRate_t Rate)
 {
+#ifdef ES_USE_TIMER_WHEEL
+  // empty the wheel before the services start allocating from it
+  ES_TimerWheel_Init();
+#endif
   // call the hardware init routine
   _HW_Timer_Init(Rate);
 }
@@ -139,28 +169,32 @@ void ES_Timer_Init(TimerRate_t Rate)
      ES_Timer_SetTimer
  Parameters
      unsigned char Num, the number of the timer to set.
-     unsigned int NewTime, the new time to set on that timer
+     uint32_t NewTime, the new time to set on that timer
  Returns
      ES_Timer_ERR if requested timer does not exist or has no service
      ES_Timer_OK  otherwise
  Description
      sets the time for a timer, but does not make it active.
  Notes
-     None.
+     makes the timer a one shot timer
  Author
      J. Edward Carryer, 02/24/97 17:11
 ****************************************************************************/
-ES_TimerReturn_t ES_Timer_SetTimer(uint8_t Num, uint16_t NewTime)
+ES_TimerReturn_t ES_Timer_SetTimer(uint8_t Num, uint32_t NewTime)
 {
   /* tried to set a timer that doesn't exist */
-  if ((Num >= ARRAY_SIZE(TMR_TimerArray)) ||
-      /* tried to set a timer without a service */
-      (Timer2PostFunc[Num] == TIMER_UNUSED) ||
+  if ((Num >= ES_NUM_TIMERS) ||
+      /* tried to set a timer without a service or a callback */
+      !HasResponse(Num) ||
       (NewTime == 0))   /* no time being set */
   {
     return ES_Timer_ERR;
   }
+  TIMER_LOCK();
   TMR_TimerArray[Num] = NewTime;
+  TMR_Periods[Num]    = 0;
+  TMR_DueFlags        &= BitNum2ClrMask[Num];
+  TIMER_UNLOCK();
   return ES_Timer_OK;
 }
 
@@ -182,13 +216,15 @@ ES_TimerReturn_t ES_Timer_SetTimer(uint8_t Num, uint16_t NewTime)
 ES_TimerReturn_t ES_Timer_StartTimer(uint8_t Num)
 {
   /* tried to set a timer that doesn't exist */
-  if ((Num >= ARRAY_SIZE(TMR_TimerArray)) ||
+  if ((Num >= ES_NUM_TIMERS) ||
       /* tried to set a timer with no time on it */
       (TMR_TimerArray[Num] == 0))
   {
     return ES_Timer_ERR;
   }
+  TIMER_LOCK();
   TMR_ActiveFlags |= BitNum2SetMask[Num];  /* set timer as active */
+  TIMER_UNLOCK();
   return ES_Timer_OK;
 }
 
@@ -209,11 +245,14 @@ ES_TimerReturn_t ES_Timer_StartTimer(uint8_t Num)
 ****************************************************************************/
 ES_TimerReturn_t ES_Timer_StopTimer(uint8_t Num)
 {
-  if (Num >= ARRAY_SIZE(TMR_TimerArray))
+  if (Num >= ES_NUM_TIMERS)
   {
     return ES_Timer_ERR;    /* tried to set a timer that doesn't exist */
   }
+  TIMER_LOCK();
   TMR_ActiveFlags &= BitNum2ClrMask[Num];  /* set timer as inactive */
+  TMR_DueFlags    &= BitNum2ClrMask[Num];  /* and drop a held timeout */
+  TIMER_UNLOCK();
   return ES_Timer_OK;
 }
 
@@ -222,33 +261,446 @@ ES_TimerReturn_t ES_Timer_StopTimer(uint8_t Num)
      ES_Timer_InitTimer
  Parameters
      unsigned char Num, the number of the timer to start
-     unsigned int NewTime, the number of ticks to be counted
+     uint32_t NewTime, the number of ticks to be counted
  Returns
      ES_Timer_ERR if the requested timer does not exist, ES_Timer_OK otherwise.
  Description
      sets the NewTime into the chosen timer and sets the timer active to
      begin counting.
  Notes
-     None.
+     makes the timer a one shot timer
  Author
      J. Edward Carryer, 02/24/97 14:51
 ****************************************************************************/
-ES_TimerReturn_t ES_Timer_InitTimer(uint8_t Num, uint16_t NewTime)
+ES_TimerReturn_t ES_Timer_InitTimer(uint8_t Num, uint32_t NewTime)
 {
   /* tried to set a timer that doesn't exist */
-  if ((Num >= ARRAY_SIZE(TMR_TimerArray)) ||
-      /* tried to set a timer without a service */
-      (Timer2PostFunc[Num] == TIMER_UNUSED) ||
+  if ((Num >= ES_NUM_TIMERS) ||
+      /* tried to set a timer without a service or a callback */
+      !HasResponse(Num) ||
       /* tried to set a timer without putting any time on it */
       (NewTime == 0))
   {
     return ES_Timer_ERR;
   }
+  TIMER_LOCK();
   TMR_TimerArray[Num] = NewTime;
+  TMR_Periods[Num]    = 0;
+  TMR_DueFlags        &= BitNum2ClrMask[Num];
+  TMR_ActiveFlags     |= BitNum2SetMask[Num]; /* set timer as active */
+  TIMER_UNLOCK();
+  return ES_Timer_OK;
+}
+
+/****************************************************************************
+ Function
+     ES_Timer_InitPeriodic
+ Parameters
+     uint8_t Num, the number of the timer to start
+     uint32_t Period, the number of ticks between timeouts
+ Returns
+     ES_Timer_ERR if the requested timer does not exist, has no service or
+     Period is 0, ES_Timer_OK otherwise.
+ Description
+     starts the timer so that it times out every Period ticks, the first
+     time Period ticks from now, until it is stopped.
+ Notes
+     The timer is reloaded in the tick response at the moment it times out,
+     so the timeouts stay on their schedule no matter how long the service
+     takes to get to them. If a timeout is still waiting to be run when the
+     next one is due, the new one is not posted and an overrun is counted
+     instead (see ES_Timer_GetOverruns). A timeout that the service's event
+     mask filters out is never waited for.
+     ES_Timer_StopTimer & ES_Timer_StartTimer pause and resume a periodic
+     timer. ES_Timer_InitTimer or ES_Timer_SetTimer make it one shot again.
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+ES_TimerReturn_t ES_Timer_InitPeriodic(uint8_t Num, uint32_t Period)
+{
+  /* tried to set a timer that doesn't exist */
+  if ((Num >= ES_NUM_TIMERS) ||
+      /* tried to set a timer without a service or a callback */
+      !HasResponse(Num) ||
+      /* tried to set a timer without putting any time on it */
+      (Period == 0))
+  {
+    return ES_Timer_ERR;
+  }
+  TIMER_LOCK();
+  TMR_TimerArray[Num] = Period;
+  TMR_Periods[Num]    = Period;
+  TMR_Overruns[Num]   = 0;
+  TMR_PendingFlags    &= BitNum2ClrMask[Num];
+  TMR_DueFlags        &= BitNum2ClrMask[Num];
   TMR_ActiveFlags     |= BitNum2SetMask[Num]; /* set timer as active */
+  TIMER_UNLOCK();
+  return ES_Timer_OK;
+}
+
+/****************************************************************************
+ Function
+     ES_Timer_StartAt
+ Parameters
+     uint8_t Num, the number of the timer to start
+     uint64_t Deadline, the value of ES_Timer_GetTime64 at which it is to
+     time out
+ Returns
+     ES_Timer_ERR if the requested timer does not exist, has no service or
+     Deadline is more than a 32 bit time away, ES_Timer_OK otherwise.
+ Description
+     starts the timer as a one shot that times out at an absolute time,
+     rather than a time from now. Services can step a deadline along by a
+     fixed amount without the time that they take adding up.
+ Notes
+     a Deadline that has already passed times out on the next tick.
+     Ticks that the interrupt has counted but the timers have not yet seen
+     are allowed for, so the timer will see exactly the right number.
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+ES_TimerReturn_t ES_Timer_StartAt(uint8_t Num, uint64_t Deadline)
+{
+  uint64_t  Now;
+  uint64_t  NewTime;
+
+  /* tried to set a timer that doesn't exist */
+  if ((Num >= ES_NUM_TIMERS) ||
+      /* tried to set a timer without a service or a callback */
+      !HasResponse(Num))
+  {
+    return ES_Timer_ERR;
+  }
+  // the time as the timers see it: both counts are bumped by the tick
+  // interrupt, so they have to be read together
+  EnterCritical();
+  Now = _HW_GetTickCount64() - ES_CTX->TickCount;
+  ExitCritical();
+
+  if (Deadline <= Now)
+  {
+    NewTime = 1;
+  }
+  else
+  {
+    NewTime = Deadline - Now;
+    if (NewTime > UINT32_MAX)
+    {
+      return ES_Timer_ERR;
+    }
+  }
+  return ES_Timer_InitTimer(Num, (uint32_t)NewTime);
+}
+
+/****************************************************************************
+ Function
+     ES_Timer_GetRemaining
+ Parameters
+     uint8_t Num, the number of the timer
+ Returns
+     uint32_t the number of ticks until the timer times out, 0 if it is not
+     running or Num is not a timer
+ Description
+     lets a service work out how long is left, for a countdown display say,
+     when it needs it instead of keeping its own count
+ Notes
+     a timer that has reached its time and is waiting in its slack has 0
+     left. For a periodic timer this is the time to its next timeout.
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+uint32_t ES_Timer_GetRemaining(uint8_t Num)
+{
+  uint32_t Remaining = 0;
+
+  if (Num < ES_NUM_TIMERS)
+  {
+    TIMER_LOCK();
+    if ((TMR_ActiveFlags & BitNum2SetMask[Num]) &&
+        !((TMR_DueFlags & BitNum2SetMask[Num]) && (TMR_Periods[Num] == 0)))
+    {
+      Remaining = TMR_TimerArray[Num];
+    }
+    TIMER_UNLOCK();
+  }
+  return Remaining;
+}
+
+/****************************************************************************
+ Function
+     ES_Timer_GetOverruns
+ Parameters
+     uint8_t Num, the number of the timer
+ Returns
+     uint16_t the number of timeouts of a periodic timer that were lost
+     since it was started by ES_Timer_InitPeriodic, 0 if Num is not a timer
+ Description
+     a timeout is lost when the previous one was still waiting to be run,
+     or when it could not be posted
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+uint16_t ES_Timer_GetOverruns(uint8_t Num)
+{
+  uint16_t Overruns;
+
+  if (Num >= ES_NUM_TIMERS)
+  {
+    return 0;
+  }
+  TIMER_LOCK();
+  Overruns = TMR_Overruns[Num];
+  TIMER_UNLOCK();
+  return Overruns;
+}
+
+/****************************************************************************
+ Function
+     ES_Timer_EventDelivered
+ Parameters
+     uint8_t WhichService, the service that is about to run the event
+     ES_Event_t ThisEvent, an event that is about to be run
+ Returns
+     None.
+ Description
+     counts the event off against each periodic timer whose pending timeout
+     is like it and was queued for the same service. When the count gets to
+     the timeout itself, the timer's next one can be posted.
+ Notes
+     called by ES_DispatchEvent for every event, services don't need to call
+     it. Only the periodic timers with a timeout pending are checked, so it
+     is quick when there are none.
+     When its timeout was queued, each timer counted the events like it
+     already in the queue, the timeout included (see PostTimeout). The same
+     event posted by someone else ahead of the timeout is run first and
+     counted off first, so it can't be taken for the timeout. Events posted
+     behind the timeout are not counted.
+     With the threaded executor this runs on the worker threads, and the
+     timer lock keeps it from seeing a timeout that is still being posted.
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+void ES_Timer_EventDelivered(uint8_t WhichService, ES_Event_t ThisEvent)
+{
+  Tflag_t    NeedsChecking;
+  uint8_t    Num;
+  ES_Event_t Posted;
+
+  TIMER_LOCK();
+  NeedsChecking = TMR_PendingFlags;
+  while (NeedsChecking != 0)
+  {
+    Num    = ES_GetMSBitSet(NeedsChecking);
+    Posted = TimeoutEvent(Num);
+    if ((TMR_PendingService[Num] == WhichService) &&
+        (Posted.EventType == ThisEvent.EventType) &&
+        (Posted.EventParam == ThisEvent.EventParam) &&
+        (--TMR_PendingCount[Num] == 0))
+    {
+      TMR_PendingFlags &= BitNum2ClrMask[Num];
+    }
+    NeedsChecking &= BitNum2ClrMask[Num];
+  }
+  TIMER_UNLOCK();
+}
+
+/****************************************************************************
+ Function
+     ES_Timer_SetEvent
+ Parameters
+     uint8_t Num, the number of the timer
+     ES_Event_t Event, the event that the timer is to post when it goes off
+ Returns
+     ES_Timer_ERR if the requested timer does not exist, ES_Timer_OK otherwise
+ Description
+     has the timer post Event, rather than an ES_TIMEOUT with its number,
+     so the timeout can be handled like any other event:
+
+       ES_Event_t GameOver = { .EventType = ES_GAME_OVER };
+       ES_Timer_SetEvent(TID_GAME_60S, GameOver);
+       ...
+       ES_Timer_InitTimer(TID_GAME_60S, 60000);
+ Notes
+     The event stays with the timer through InitTimer, InitPeriodic etc. An
+     Event of type ES_NO_EVENT puts back the ES_TIMEOUT. A periodic timer
+     may post the same event as other timers or services, as its overrun
+     check counts the events like it that are queued ahead of its timeout.
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+ES_TimerReturn_t ES_Timer_SetEvent(uint8_t Num, ES_Event_t Event)
+{
+  if (Num >= ES_NUM_TIMERS)
+  {
+    return ES_Timer_ERR;
+  }
+  TIMER_LOCK();
+  TMR_Events[Num] = Event;
+  TIMER_UNLOCK();
+  return ES_Timer_OK;
+}
+
+/****************************************************************************
+ Function
+     ES_Timer_SetSlack
+ Parameters
+     uint8_t Num, the number of the timer
+     uint32_t Slack, how many ticks late the timer may go off
+ Returns
+     ES_Timer_ERR if the requested timer does not exist, ES_Timer_OK otherwise
+ Description
+     lets a timer wait, up to Slack ticks past its time, for another timeout
+     to go off with. A timer with no slack goes off on time and takes every
+     timer that is waiting in its slack along with it.
+ Notes
+     The slack stays with the timer through InitTimer, InitPeriodic etc. A
+     periodic timer still reloads from its schedule, so slack doesn't make
+     it drift. Keep a periodic timer's slack below its period.
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+ES_TimerReturn_t ES_Timer_SetSlack(uint8_t Num, uint32_t Slack)
+{
+  if (Num >= ES_NUM_TIMERS)
+  {
+    return ES_Timer_ERR;
+  }
+  TIMER_LOCK();
+  TMR_Slack[Num] = Slack;
+  TIMER_UNLOCK();
+  return ES_Timer_OK;
+}
+
+/****************************************************************************
+ Function
+     ES_Timer_GetTicksToNextWake
+ Parameters
+     None.
+ Returns
+     uint32_t the number of ticks until a timer must go off, 0 if no timer
+     is running
+ Description
+     the longest that a tickless idle could sleep without making a timer
+     later than its slack allows
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+uint32_t ES_Timer_GetTicksToNextWake(void)
+{
+  uint32_t  NextWake = 0;
+  uint32_t  Latest;
+  uint8_t   i;
+
+  TIMER_LOCK();
+  for (i = 0; i < ES_NUM_TIMERS; i++)
+  {
+    if (TMR_DueFlags & BitNum2SetMask[i])
+    {
+      Latest = TMR_SlackLeft[i];
+    }
+    else if (TMR_ActiveFlags & BitNum2SetMask[i])
+    {
+      Latest = TMR_TimerArray[i] + TMR_Slack[i];
+    }
+    else
+    {
+      continue;
+    }
+    if ((NextWake == 0) || (Latest < NextWake))
+    {
+      NextWake = Latest;
+    }
+  }
+  TIMER_UNLOCK();
+  return NextWake;
+}
+
+/****************************************************************************
+ Function
+     ES_Timer_SetCallback
+ Parameters
+     uint8_t Num, the number of the timer
+     ES_TimerCallback_t Callback, the function to call when it goes off
+ Returns
+     ES_Timer_ERR if the requested timer does not exist, ES_Timer_OK otherwise
+ Description
+     has the timer call Callback straight from the tick response, instead of
+     posting an event. This is for timeouts with nothing to decide, like
+     moving a servo back, which then skip the queue and the dispatch.
+ Notes
+     The callback runs in ES_Run between services, under the timer lock with
+     the threaded executor. It must be short: it must not block or post to
+     its own timer's service expecting an order. Callbacks are timed, see
+     ES_Timer_GetCallbackStats.
+     A timer that only runs a callback can be TIMER_UNUSED in ES_Configure.h.
+     A NULL Callback makes the timer post again, or stops it if it has no
+     service to post to.
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+ES_TimerReturn_t ES_Timer_SetCallback(uint8_t Num, ES_TimerCallback_t Callback)
+{
+  if (Num >= ES_NUM_TIMERS)
+  {
+    return ES_Timer_ERR;
+  }
+  TIMER_LOCK();
+  TMR_Callbacks[Num] = Callback;
+  if (!HasResponse(Num))
+  {
+    TMR_ActiveFlags &= BitNum2ClrMask[Num]; /* nothing left to do */
+    TMR_DueFlags    &= BitNum2ClrMask[Num];
+  }
+  TIMER_UNLOCK();
   return ES_Timer_OK;
 }
 
+/****************************************************************************
+ Function
+     ES_Timer_GetCallbackStats
+ Parameters
+     uint32_t *pMaxTicks, where to put the length of the longest callback,
+     in core timer counts (CORE_TICKS_PER_US per us)
+     uint8_t *pSlowest, where to put the number of the timer that called it
+     uint32_t *pLongCallbacks, where to put the number of callbacks that
+     took longer than TIMER_CALLBACK_MAX_US
+ Returns
+     None.
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+void ES_Timer_GetCallbackStats(uint32_t *pMaxTicks, uint8_t *pSlowest,
+    uint32_t *pLongCallbacks)
+{
+  TIMER_LOCK();
+  *pMaxTicks      = TMR_MaxCallbackTicks;
+  *pSlowest       = TMR_SlowestCallback;
+  *pLongCallbacks = TMR_LongCallbacks;
+  TIMER_UNLOCK();
+}
+
+/****************************************************************************
+ Function
+     ES_Timer_GetWakeupStats
+ Parameters
+     uint32_t *pExpirations, where to put the number of timeouts posted
+     uint32_t *pWakeups, where to put the number of ticks that posted any
+ Returns
+     None.
+ Description
+     the difference between the two is the number of wake-ups saved by
+     coalescing timeouts
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+void ES_Timer_GetWakeupStats(uint32_t *pExpirations, uint32_t *pWakeups)
+{
+  TIMER_LOCK();
+  *pExpirations = TMR_Expirations;
+  *pWakeups     = TMR_Wakeups;
+  TIMER_UNLOCK();
+}
+
 /****************************************************************************
  Function
      ES_Timer_GetTime
@@ -270,6 +722,45 @@ uint16_t ES_Timer_GetTime(void)
   return _HW_GetTickCount();
 }
 
+/****************************************************************************
+ Function
+     ES_Timer_GetTime64
+ Parameters
+     None.
+ Returns
+     uint64_t the number of ticks since the timers were started
+ Description
+     the same count as ES_Timer_GetTime, without the wrap every 65.5s, for
+     long sessions and for time stamps that must never repeat
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+uint64_t ES_Timer_GetTime64(void)
+{
+  return _HW_GetTickCount64();
+}
+
+/****************************************************************************
+ Function
+     ES_Timer_GetMicros64
+ Parameters
+     None.
+ Returns
+     uint64_t microseconds, counted by the core timer
+ Description
+     a monotonic high resolution time for measuring latencies & time stamping
+     traces. It does not depend on the tick rate.
+ Notes
+     the count starts from whatever the core timer held at reset, so only
+     differences are meaningful
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+uint64_t ES_Timer_GetMicros64(void)
+{
+  return _HW_GetCoreCount64() / CORE_TICKS_PER_US;
+}
+
 /****************************************************************************
  Function
      ES_Timer_Tick_Resp
@@ -283,7 +774,10 @@ uint16_t ES_Timer_GetTime(void)
      GetTime() timer and it will check through the active timers,
      decrementing each active timers count, if the count goes to 0, it
      will post an event to the corresponding SM and clear the active flag to
-     prevent further counting.
+     prevent further counting. A periodic timer is reloaded instead.
+     A timer with slack is held back until a timer without slack goes off,
+     or its slack runs out, and then all of the timers being held back are
+     posted together.
  Notes
      Called from _Timer_Int_Resp in ES_Port.c.
  Author
@@ -291,10 +785,22 @@ uint16_t ES_Timer_GetTime(void)
 ****************************************************************************/
 void ES_Timer_Tick_Resp(void)
 {
-  static Tflag_t  NeedsProcessing;
-  static uint8_t  NextTimer2Process;
-  static ES_Event_t NewEvent;
+  Tflag_t     NeedsProcessing;
+  uint8_t     NextTimer2Process;
+  bool        MustWake = false;
 
+  TIMER_LOCK();
+  // the timers already held back use up another tick of their slack
+  NeedsProcessing = TMR_DueFlags;
+  while (NeedsProcessing != 0)
+  {
+    NextTimer2Process = ES_GetMSBitSet(NeedsProcessing);
+    if (--TMR_SlackLeft[NextTimer2Process] == 0)
+    {
+      MustWake = true;
+    }
+    NeedsProcessing &= BitNum2ClrMask[NextTimer2Process];
+  }
   if (TMR_ActiveFlags != 0) /* if !=0 , then at least 1 timer is active */
   {
     // start by getting a list of all the active timers
@@ -306,17 +812,229 @@ void ES_Timer_Tick_Resp(void)
       /* decrement that timer, check if timed out */
       if (--TMR_TimerArray[NextTimer2Process] == 0)
       {
-        NewEvent.EventType  = ES_TIMEOUT;
-        NewEvent.EventParam = NextTimer2Process;
-        /* post the timeout event to the right Service */
-        Timer2PostFunc[NextTimer2Process](NewEvent);
-        /* and stop counting */
-        TMR_ActiveFlags &= BitNum2ClrMask[NextTimer2Process];
+        if (TMR_Periods[NextTimer2Process] == 0)
+        {
+          /* stop counting */
+          TMR_ActiveFlags &= BitNum2ClrMask[NextTimer2Process];
+        }
+        else
+        {
+          /* reload from the schedule, not from when the service runs */
+          TMR_TimerArray[NextTimer2Process] = TMR_Periods[NextTimer2Process];
+        }
+        if (TMR_DueFlags & BitNum2SetMask[NextTimer2Process])
+        {
+          /* a whole period went by in the slack */
+          CountOverrun(NextTimer2Process);
+        }
+        else
+        {
+          /* the timeout is due, now or within its slack */
+          TMR_DueFlags |= BitNum2SetMask[NextTimer2Process];
+          TMR_SlackLeft[NextTimer2Process] = TMR_Slack[NextTimer2Process];
+          if (TMR_Slack[NextTimer2Process] == 0)
+          {
+            MustWake = true;
+          }
+        }
       }
       // mark off the active timer that we just processed
       NeedsProcessing &= BitNum2ClrMask[NextTimer2Process];
     } while (NeedsProcessing != 0);
   }
+  if (MustWake)
+  {
+    PostDueTimers();
+  }
+  TIMER_UNLOCK();
+#ifdef ES_USE_TIMER_WHEEL
+  ES_TimerWheel_Tick();
+#endif
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/****************************************************************************
+ Function
+     CountOverrun
+ Parameters
+     uint8_t Num, the periodic timer that lost a timeout
+ Returns
+     None.
+ Description
+     bumps the timer's overrun count, stopping at the top
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+static void CountOverrun(uint8_t Num)
+{
+  if (TMR_Overruns[Num] != 0xFFFF)
+  {
+    TMR_Overruns[Num]++;
+  }
+}
+
+/****************************************************************************
+ Function
+     PostDueTimers
+ Parameters
+     None.
+ Returns
+     None.
+ Description
+     posts the timeouts of all of the timers that are due, as one wake-up
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+static void PostDueTimers(void)
+{
+  Tflag_t NeedsProcessing;
+  uint8_t NextTimer2Process;
+
+  NeedsProcessing = TMR_DueFlags;
+  TMR_DueFlags    = 0;
+  TMR_Wakeups++;
+  while (NeedsProcessing != 0)
+  {
+    NextTimer2Process = ES_GetMSBitSet(NeedsProcessing);
+    PostTimeout(NextTimer2Process);
+    TMR_Expirations++;
+    NeedsProcessing &= BitNum2ClrMask[NextTimer2Process];
+  }
+}
+
+/****************************************************************************
+ Function
+     PostTimeout
+ Parameters
+     uint8_t Num, the timer that has gone off
+ Returns
+     None.
+ Description
+     posts the timer's event to its service, or runs its callback. A
+     periodic timer's timeout is counted as an overrun instead if its last
+     one hasn't been run yet.
+ Notes
+     A periodic timer only waits for a timeout that ES_PostToService queued.
+     One that the service's event mask filtered out, or that a post function
+     handled some other way, leaves LastQueued at ES_NO_SERVICE and isn't
+     waited for, so the timer keeps posting.
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+static void PostTimeout(uint8_t Num)
+{
+  ES_Event_t NewEvent;
+
+  if (TMR_Callbacks[Num] != NULL)
+  {
+    RunCallback(Num);
+    return;
+  }
+  NewEvent = TimeoutEvent(Num);
+  if (TMR_Periods[Num] == 0)
+  {
+    /* post the timeout event to the right Service */
+    Timer2PostFunc[Num](NewEvent);
+    return;
+  }
+  /* post, unless the last timeout hasn't been run yet */
+  if (TMR_PendingFlags & BitNum2SetMask[Num])
+  {
+    CountOverrun(Num);
+    return;
+  }
+  ES_CTX->LastQueued = ES_NO_SERVICE;
+  if (!Timer2PostFunc[Num](NewEvent))
+  {
+    CountOverrun(Num);
+  }
+  else if (ES_CTX->LastQueued != ES_NO_SERVICE)
+  {
+    /* wait for the service to run it, and any like it queued ahead of it */
+    TMR_PendingService[Num] = ES_CTX->LastQueued;
+    TMR_PendingCount[Num]   = ES_CountQueued(ES_CTX->LastQueued, NewEvent);
+    if (TMR_PendingCount[Num] != 0)
+    {
+      TMR_PendingFlags |= BitNum2SetMask[Num];
+    }
+  }
+}
+
+/****************************************************************************
+ Function
+     TimeoutEvent
+ Parameters
+     uint8_t Num, the number of the timer
+ Returns
+     ES_Event_t the event that the timer posts
+ Description
+     the event set with ES_Timer_SetEvent, or an ES_TIMEOUT with the timer's
+     number if none has been set
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+static ES_Event_t TimeoutEvent(uint8_t Num)
+{
+  ES_Event_t NewEvent;
+
+  NewEvent = TMR_Events[Num];
+  if (NewEvent.EventType == ES_NO_EVENT)
+  {
+    NewEvent.EventType  = ES_TIMEOUT;
+    NewEvent.EventParam = Num;
+  }
+  return NewEvent;
+}
+
+/****************************************************************************
+ Function
+     RunCallback
+ Parameters
+     uint8_t Num, the timer that has gone off
+ Returns
+     None.
+ Description
+     calls the timer's callback and keeps the statistics on how long it took
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+static void RunCallback(uint8_t Num)
+{
+  uint32_t Start;
+  uint32_t Length;
+
+  Start = _HW_GetCoreCount();
+  TMR_Callbacks[Num](Num);
+  Length = _HW_GetCoreCount() - Start;
+  if (Length > TMR_MaxCallbackTicks)
+  {
+    TMR_MaxCallbackTicks = Length;
+    TMR_SlowestCallback  = Num;
+  }
+  if (Length > CALLBACK_MAX_TICKS)
+  {
+    TMR_LongCallbacks++;
+  }
+}
+
+/****************************************************************************
+ Function
+     HasResponse
+ Parameters
+     uint8_t Num, the number of the timer
+ Returns
+     bool true if the timer has a service to post to or a callback to run
+ Description
+     a timer with neither can't be started
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+static bool HasResponse(uint8_t Num)
+{
+  return (Timer2PostFunc[Num] != TIMER_UNUSED) ||
+         (TMR_Callbacks[Num] != NULL);
 }
 
 /*------------------------------- Footnotes -------------------------------*/
@@ -165,6 +165,35 @@ int circular_buf_get(cbuf_handle_t cbuf, uint8_t * data)
   return r;
 }
 
+// only reads head, so the consumer can call it while the producer puts
+size_t circular_buf_peek_contig(cbuf_handle_t cbuf, uint8_t ** data)
+{
+  assert(cbuf && data && cbuf->buffer);
+
+  size_t head = cbuf->head;
+
+  *data = &cbuf->buffer[cbuf->tail];
+  if(head >= cbuf->tail)
+  {
+    return head - cbuf->tail;
+  }
+  // up to the end of the storage, the rest is at the start
+  return cbuf->max - cbuf->tail;
+}
+
+void circular_buf_skip(cbuf_handle_t cbuf, size_t len)
+{
+  assert(cbuf && (len <= circular_buf_size(cbuf)));
+
+  size_t tail = cbuf->tail + len;
+
+  if(tail >= cbuf->max)
+  {
+    tail -= cbuf->max;
+  }
+  cbuf->tail = tail;
+}
+
 bool circular_buf_empty(cbuf_handle_t cbuf)
 {
 	assert(cbuf);
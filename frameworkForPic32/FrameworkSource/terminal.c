@@ -15,6 +15,13 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/18/26       karthi24  host harness built by TEST, like the other modules
+ 10/18/26       karthi24  _fassert stops the DMA channel and sends by polling
+ 10/18/26       karthi24  TERMINAL_RX_INT receives into a buffer from the RX
+                          interrupt, counting the characters lost
+ 10/18/26       karthi24  TERMINAL_TX_DMA sends the transmit buffer by DMA, with
+                          a host model of the UART & DMA for testing
+ 10/18/26       karthi24  Terminal_MoveBuffer2UART reports if it moved anything
  08/29/20 14:46 ram     first pass
  10/05/20 19:38 ram     starting work on PIC32 port
  ***************************************************************************/
@@ -23,6 +30,8 @@
 
 // Hardware
 #include <xc.h>
+#include <sys/attribs.h>
+#include <sys/kmem.h>
 #include <stdio.h>
 
 #include "ES_General.h"
@@ -36,15 +45,92 @@
 #define BAUD_CONST 42 // sets up baud rate for 115200
 //#define BAUD_CONST 21 // sets up baud rate for 230400
 
+// with TERMINAL_TX_DMA, the TEST harness runs on the host, with a model of
+// the UART & DMA channel standing in for the registers. Without it, TEST
+// builds the original loop for the PIC32.
+#if defined(TEST) && defined(TERMINAL_TX_DMA)
+#define TERMINAL_MODEL
+#endif
+
+#ifdef TERMINAL_TX_DMA
+// must not be above ES_CRITICAL_IPL, so that EnterCritical holds it off
+#define TX_DMA_IPL 3
+
+#ifndef TERMINAL_MODEL
+// DMA channel 0 moves one byte per UART1 TX interrupt request, from the
+// transmit buffer to U1TXREG, and interrupts when the block is done
+#define TX_DMA_SET_SOURCE(pData, Len) \
+  do { DCH0SSA = KVA_TO_PA(pData); DCH0SSIZ = (Len); } while (0)
+#define TX_DMA_ENABLE() (DCH0CONSET = _DCH0CON_CHEN_MASK)
+#define TX_DMA_INT_CLR() \
+  do { DCH0INTCLR = _DCH0INT_CHBCIF_MASK; IFS1CLR = _IFS1_DMA0IF_MASK; } \
+  while (0)
+// the channel starts on the rising edge of the request, which the UART
+// raises again at once when its FIFO has room
+#define UART_TX_REQ_CLR() (IFS1CLR = _IFS1_U1TXIF_MASK)
+#else
+// the host model stands in for the hardware, see the end of the file
+static uint8_t  *ModelSource;
+static uint32_t ModelSize;
+static bool     ModelEnabled;
+static bool     ModelDone;
+
+#define TX_DMA_SET_SOURCE(pData, Len) \
+  do { ModelSource = (pData); ModelSize = (Len); } while (0)
+#define TX_DMA_ENABLE() (ModelEnabled = true)
+#define TX_DMA_INT_CLR() (ModelDone = false)
+#define UART_TX_REQ_CLR()
+#endif
+#endif /* TERMINAL_TX_DMA */
+
+#ifdef TERMINAL_RX_INT
+// must not be above ES_CRITICAL_IPL, like the other framework interrupts
+#define RX_INT_IPL 3
+#endif
+
 /*---------------------------- Module Functions ---------------------------*/
 /* prototypes for private functions for this service.They should be functions
    relevant to the behavior of this service
 */
+static void QueueTxByte(uint8_t txByte);
+#ifndef TERMINAL_MODEL
+static bool PollBuffer2UART(void);
+#endif
+#ifdef TERMINAL_TX_DMA
+#ifndef TERMINAL_MODEL
+static void TxDmaInit(void);
+#endif
+static void StartTxChunk(void);
+static void TxDmaIntResp(void);
+#endif
+#if defined(TERMINAL_RX_INT) && !defined(TERMINAL_MODEL)
+static void RxIntInit(void);
+#endif
 
 /*---------------------------- Module Variables ---------------------------*/
 static uint8_t xmitBuffer[XMIT_BUFFER_SIZE];
 static cbuf_handle_t xmitBufferHandle;
 
+#ifdef TERMINAL_TX_DMA
+// true while the DMA channel is sending a chunk of the buffer. Set with the
+// DMA interrupt held off, cleared by the interrupt when the buffer is empty
+static volatile bool TxBusy;
+// the length of the chunk being sent, which the interrupt then drops
+static size_t TxChunkLen;
+// bytes thrown away because the buffer was full
+static uint32_t TxDropped;
+#endif
+
+#ifdef TERMINAL_RX_INT
+#ifndef TERMINAL_MODEL
+static uint8_t recvBuffer[RECV_BUFFER_SIZE];
+static cbuf_handle_t recvBufferHandle;
+#endif
+// characters lost to a full buffer, and UART overruns, each of which may
+// have lost several
+static volatile uint32_t RxLost;
+#endif
+
 /*------------------------------ Module Code ------------------------------*/
 /*******************************************************************************
  * Function: TerminalInit
@@ -55,6 +141,7 @@ static cbuf_handle_t xmitBufferHandle;
  * Description: Sets up UART1 to serve as the terminal interface. Sets the baud
  * rate and maps the needed pins
  ******************************************************************************/
+#ifndef TERMINAL_MODEL
 void Terminal_HWInit(void)
 {
 //#define USE_RB2_3
@@ -103,6 +190,13 @@ void Terminal_HWInit(void)
   
   // now initialize the circular buffer for transmitting
   xmitBufferHandle = circular_buf_init( xmitBuffer, ARRAY_SIZE(xmitBuffer) );
+#ifdef TERMINAL_TX_DMA
+  TxDmaInit();
+#endif
+#ifdef TERMINAL_RX_INT
+  recvBufferHandle = circular_buf_init( recvBuffer, ARRAY_SIZE(recvBuffer) );
+  RxIntInit();
+#endif
   
   return;
 }
@@ -116,6 +210,14 @@ void Terminal_HWInit(void)
  ******************************************************************************/
 uint8_t Terminal_ReadByte(void)
 {
+#ifdef TERMINAL_RX_INT
+  uint8_t rxByte;
+
+  // wait for the interrupt to put something in the buffer
+  while(circular_buf_get(recvBufferHandle, &rxByte) != 0)
+  {}
+  return rxByte;
+#else
   // wait for there to be something
   while(!(U1STAbits.URXDA))
   {}
@@ -123,7 +225,9 @@ uint8_t Terminal_ReadByte(void)
   if(U1STAbits.OERR) U1STAbits.OERR = 0;
   // return the content of the receive register
   return U1RXREG;
+#endif
 }
+#endif /* TERMINAL_MODEL */
 /*******************************************************************************
  * Function: Terminal_Write
  * Arguments: byte to write
@@ -141,10 +245,11 @@ void Terminal_WriteByte(uint8_t txByte)
   // write the byte to the register
   U1TXREG = txByte;
 #else
-  circular_buf_put(xmitBufferHandle, txByte);
+  QueueTxByte(txByte);
 #endif  
   return;
 }
+#ifndef TERMINAL_MODEL
 /*******************************************************************************
  * Function: Terminal_IsRxData
  * Arguments: none
@@ -156,6 +261,9 @@ void Terminal_WriteByte(uint8_t txByte)
  ******************************************************************************/
 bool Terminal_IsRxData(void)
 {
+#ifdef TERMINAL_RX_INT
+    return !circular_buf_empty(recvBufferHandle);
+#else
   
     if(U1STAbits.FERR != 0 ){
         U1RXREG; // in case of a framing error, read the data reg to clear err
@@ -163,7 +271,9 @@ bool Terminal_IsRxData(void)
     }
     // Return Rx Data bit from status register
     return U1STAbits.URXDA;
+#endif
 }
+#endif /* TERMINAL_MODEL */
 
 /*******************************************************************************
  * Function: _mon_putc
@@ -177,48 +287,318 @@ bool Terminal_IsRxData(void)
  ******************************************************************************/
 void _mon_putc (char c)
 {
-  circular_buf_put(xmitBufferHandle, c);
+  QueueTxByte(c);
 }
 
 /*******************************************************************************
  * Function: Terminal_MoveBuffer2UART
  * Arguments: none
- * Returns none
+ * Returns true if any bytes were moved
  * 
  * Created by: Ed Carryer
  * Description: this functions pulls bytes, if any available, from the
  *              circular buffer and stuffs them into the UART1 buffer
  *              until we either run out of bytes in the circular buffer
  *              or we run out of space in the UART FIFO
+ *              With TERMINAL_TX_DMA the DMA channel does that, so this only
+ *              makes sure that it is running, and always returns false.
  ******************************************************************************/
-void Terminal_MoveBuffer2UART( void )
+bool Terminal_MoveBuffer2UART( void )
 {
-  while ( (!circular_buf_empty(xmitBufferHandle)) && (!U1STAbits.UTXBF))
+  bool movedBytes = false;
+  
+#ifdef TERMINAL_TX_DMA
+  if (!TxBusy)
   {
-    uint8_t byte2Xmit;
-    circular_buf_get(xmitBufferHandle, &byte2Xmit);
-    U1TXREG = byte2Xmit;
+    EnterCritical();
+    if (!TxBusy)
+    {
+      StartTxChunk();
+    }
+    ExitCritical();
+  }
+#else
+  movedBytes = PollBuffer2UART();
+#endif
+  return movedBytes;
+}
+
+/*******************************************************************************
+ * Function: Terminal_GetTxDropped
+ * Arguments: none
+ * Returns the number of bytes thrown away because the buffer was full
+ * 
+ * Created by: karthi24
+ * Description: with TERMINAL_TX_DMA, a byte written while the buffer is full
+ *              is dropped rather than overwriting the oldest one, which the
+ *              DMA channel may be reading. Without it, always 0.
+ ******************************************************************************/
+uint32_t Terminal_GetTxDropped(void)
+{
+#ifdef TERMINAL_TX_DMA
+  return TxDropped;
+#else
+  return 0;
+#endif
+}
+
+/*******************************************************************************
+ * Function: Terminal_GetRxLost
+ * Arguments: none
+ * Returns the number of times that received characters were lost
+ * 
+ * Created by: karthi24
+ * Description: counts each character that arrived to a full buffer, and each
+ *              UART FIFO overrun. Without TERMINAL_RX_INT, always 0.
+ ******************************************************************************/
+uint32_t Terminal_GetRxLost(void)
+{
+#ifdef TERMINAL_RX_INT
+  return RxLost;
+#else
+  return 0;
+#endif
+}
+
+#if defined(TERMINAL_RX_INT) && !defined(TERMINAL_MODEL)
+/*******************************************************************************
+ * Function: TerminalRxIntHandler
+ * Arguments: none
+ * Returns nothing
+ * 
+ * Created by: karthi24
+ * Description: UART1 interrupt response, only the receive interrupt is
+ *              enabled. Empties the FIFO into the receive buffer.
+ ******************************************************************************/
+void __ISR(_UART_1_VECTOR, IPL3AUTO) TerminalRxIntHandler(void)
+{
+  uint8_t rxByte;
+
+  while (U1STAbits.URXDA)
+  {
+    // a byte with a framing error is read & kept, like any other
+    rxByte = U1RXREG;
+    if (circular_buf_put2(recvBufferHandle, rxByte) != 0)
+    {
+      RxLost++;
+    }
+  }
+  // the FIFO is empty, so clearing an overrun loses nothing more
+  if (U1STAbits.OERR)
+  {
+    U1STACLR = _U1STA_OERR_MASK;
+    RxLost++;
   }
+  IFS1CLR = _IFS1_U1RXIF_MASK;
 }
+#endif
 
+#ifdef TERMINAL_TX_DMA
+#ifndef TERMINAL_MODEL
+/*******************************************************************************
+ * Function: TerminalTxDmaIntHandler
+ * Arguments: none
+ * Returns nothing
+ * 
+ * Created by: karthi24
+ * Description: DMA channel 0 interrupt response, the chunk has been sent
+ ******************************************************************************/
+void __ISR(_DMA_0_VECTOR, IPL3AUTO) TerminalTxDmaIntHandler(void)
+{
+  TxDmaIntResp();
+}
+#endif
+#endif
+
+#ifndef TERMINAL_MODEL
 void __attribute__((noreturn)) _fassert(int nLineNumber,
                                         const char * sFileName,
                                         const char * sFailedExpression,
                                         const char * sFunction )
 {
+#ifdef TERMINAL_TX_DMA
+  // the DMA interrupt never runs if the assert came from an interrupt or a
+  // critical region, so stop the channel and send the rest by polling.
+  // TxBusy stays set, so that nothing starts the channel again.
+  IEC1CLR = _IEC1_DMA0IE_MASK;
+  DCH0CONCLR = _DCH0CON_CHEN_MASK;
+  while (DCH0CON & _DCH0CON_CHBUSY_MASK)
+  {}
+  if (TxBusy)
+  {
+    // drop what the channel had already sent of its chunk, all of it if
+    // the block was done
+    circular_buf_skip(xmitBufferHandle, (DCH0INT & _DCH0INT_CHBCIF_MASK) ?
+        TxChunkLen : DCH0SPTR);
+  }
+  TxBusy = true;
+#endif
   DB_printf("Assert \"%s\" Failed at Line: %d, in File: %s \n\r", 
             sFailedExpression, nLineNumber, sFileName, sFunction);
     // now pump the bytes out of the buffer into the UART
     while(1) 
     {
-        Terminal_MoveBuffer2UART();
+        PollBuffer2UART();
     }
 }
+#endif /* TERMINAL_MODEL */
 /***************************************************************************
  private functions
  ***************************************************************************/
+/*******************************************************************************
+ * Function: QueueTxByte
+ * Arguments: byte to send
+ * Returns nothing
+ * 
+ * Created by: karthi24
+ * Description: puts the byte in the transmit buffer, and with
+ *              TERMINAL_TX_DMA starts the DMA channel if it was idle
+ ******************************************************************************/
+static void QueueTxByte(uint8_t txByte)
+{
+#ifdef TERMINAL_TX_DMA
+  if (circular_buf_put2(xmitBufferHandle, txByte) != 0)
+  {
+    TxDropped++;
+  }
+  if (!TxBusy)
+  {
+    EnterCritical();
+    if (!TxBusy)
+    {
+      StartTxChunk();
+    }
+    ExitCritical();
+  }
+#else
+  circular_buf_put(xmitBufferHandle, txByte);
+#endif
+}
+
+#ifndef TERMINAL_MODEL
+/*******************************************************************************
+ * Function: PollBuffer2UART
+ * Arguments: none
+ * Returns true if any bytes were moved
+ * 
+ * Created by: Ed Carryer
+ * Description: copies bytes from the circular buffer into the UART1 FIFO
+ *              until one or the other runs out. Without TERMINAL_TX_DMA this
+ *              is how all output goes, with it only the output of _fassert.
+ ******************************************************************************/
+static bool PollBuffer2UART(void)
+{
+  bool movedBytes = false;
+
+  while ( (!circular_buf_empty(xmitBufferHandle)) && (!U1STAbits.UTXBF))
+  {
+    uint8_t byte2Xmit;
+    circular_buf_get(xmitBufferHandle, &byte2Xmit);
+    U1TXREG = byte2Xmit;
+    movedBytes = true;
+  }
+  return movedBytes;
+}
+#endif /* TERMINAL_MODEL */
+
+#ifdef TERMINAL_TX_DMA
+#ifndef TERMINAL_MODEL
+/*******************************************************************************
+ * Function: TxDmaInit
+ * Arguments: none
+ * Returns nothing
+ * 
+ * Created by: karthi24
+ * Description: sets up DMA channel 0 to move bytes to U1TXREG, one for each
+ *              UART1 TX request, with an interrupt when a block is done.
+ *              The UART requests while there is room in its FIFO
+ *              (UTXISEL = 00, from U1STA = 0 in Terminal_HWInit).
+ ******************************************************************************/
+static void TxDmaInit(void)
+{
+  IEC1CLR = _IEC1_DMA0IE_MASK;
+  DMACONSET = _DMACON_ON_MASK;
+  DCH0CON = 3;    // highest channel priority, not auto enabled
+  DCH0ECON = (_UART1_TX_IRQ << _DCH0ECON_CHSIRQ_POSITION) |
+      _DCH0ECON_SIRQEN_MASK;
+  DCH0DSA = KVA_TO_PA(&U1TXREG);
+  DCH0DSIZ = 1;
+  DCH0CSIZ = 1;   // one byte per request
+  DCH0INTCLR = 0x00FF00FF;  // all of the flags & enables
+  DCH0INTSET = _DCH0INT_CHBCIE_MASK;
+  IPC10bits.DMA0IP = TX_DMA_IPL;
+  IFS1CLR = _IFS1_DMA0IF_MASK;
+  IEC1SET = _IEC1_DMA0IE_MASK;
+  TxBusy = false;
+}
+#endif
+#endif /* TERMINAL_TX_DMA */
+
+#if defined(TERMINAL_RX_INT) && !defined(TERMINAL_MODEL)
+/*******************************************************************************
+ * Function: RxIntInit
+ * Arguments: none
+ * Returns nothing
+ * 
+ * Created by: karthi24
+ * Description: enables the UART1 receive interrupt, on every character
+ *              (URXISEL = 00, from U1STA = 0 in Terminal_HWInit)
+ ******************************************************************************/
+static void RxIntInit(void)
+{
+  IEC1CLR = _IEC1_U1RXIE_MASK;
+  IPC8bits.U1IP = RX_INT_IPL;
+  IFS1CLR = _IFS1_U1RXIF_MASK;
+  IEC1SET = _IEC1_U1RXIE_MASK;
+}
+#endif
+
+#ifdef TERMINAL_TX_DMA
+
+/*******************************************************************************
+ * Function: StartTxChunk
+ * Arguments: none
+ * Returns nothing
+ * 
+ * Created by: karthi24
+ * Description: starts the DMA channel on the oldest bytes in the buffer that
+ *              sit in one piece, or marks it idle if the buffer is empty
+ * Notes: call with the DMA interrupt held off, or from it
+ ******************************************************************************/
+static void StartTxChunk(void)
+{
+  uint8_t *pChunk;
+
+  TxChunkLen = circular_buf_peek_contig(xmitBufferHandle, &pChunk);
+  if (TxChunkLen == 0)
+  {
+    TxBusy = false;
+    return;
+  }
+  TxBusy = true;
+  TX_DMA_SET_SOURCE(pChunk, TxChunkLen);
+  UART_TX_REQ_CLR();
+  TX_DMA_ENABLE();
+}
+
+/*******************************************************************************
+ * Function: TxDmaIntResp
+ * Arguments: none
+ * Returns nothing
+ * 
+ * Created by: karthi24
+ * Description: the chunk is all in the UART, so its space in the buffer is
+ *              given back and the next chunk started
+ ******************************************************************************/
+static void TxDmaIntResp(void)
+{
+  TX_DMA_INT_CLR();
+  circular_buf_skip(xmitBufferHandle, TxChunkLen);
+  StartTxChunk();
+}
+#endif /* TERMINAL_TX_DMA */
 // module test harness:
-#ifdef TEST
+#if defined(TEST) && !defined(TERMINAL_MODEL)
 int main(void)
 {
   
@@ -247,5 +627,123 @@ int main(void)
   return 0;
 }
 #endif
+
+#ifdef TERMINAL_MODEL
+/****************************************************************************
+ Host test. A model of the UART & DMA channel stands in for the hardware:
+ each step the channel, while enabled, moves one byte into the UART FIFO if
+ there is room, and when its block is done the interrupt response runs. The
+ UART sends a byte from its FIFO every BYTE_STEPS steps. Bursts of writes
+ go in between steps, as services would, without Terminal_MoveBuffer2UART
+ ever being called, and everything written must come out in order.
+ ****************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+
+// the results go to the host's printf, not the transmit buffer under test
+#undef printf
+
+#define FIFO_DEPTH  8
+#define BYTE_STEPS  10
+#define NUM_BYTES   200000
+
+static uint8_t  ModelFifo[FIFO_DEPTH];
+static uint8_t  FifoCount;
+static uint32_t ModelPos;
+static uint32_t StepCount;
+static uint8_t  Sent[NUM_BYTES];
+static uint8_t  Received[NUM_BYTES];
+static uint32_t NumReceived;
+
+void _HW_EnterCritical(void) {}
+void _HW_ExitCritical(void) {}
+
+// one step of the model
+static void ModelStep(void)
+{
+  StepCount++;
+  if (ModelEnabled && (FifoCount < FIFO_DEPTH))
+  {
+    ModelFifo[FifoCount++] = ModelSource[ModelPos++];
+    if (ModelPos == ModelSize)
+    {
+      ModelEnabled  = false;
+      ModelPos      = 0;
+      ModelDone     = true;
+      TxDmaIntResp();
+    }
+  }
+  if (((StepCount % BYTE_STEPS) == 0) && (FifoCount != 0))
+  {
+    if (NumReceived < NUM_BYTES)
+    {
+      Received[NumReceived] = ModelFifo[0];
+    }
+    NumReceived++;
+    memmove(ModelFifo, ModelFifo + 1, --FifoCount);
+  }
+}
+
+static void Drain(void)
+{
+  while (TxBusy || (FifoCount != 0))
+  {
+    ModelStep();
+  }
+}
+
+int main(void)
+{
+  uint32_t NumSent = 0;
+  uint32_t NumErrors = 0;
+  uint32_t Burst;
+  uint32_t i;
+
+  xmitBufferHandle = circular_buf_init(xmitBuffer, ARRAY_SIZE(xmitBuffer));
+
+  // bursts of up to half the buffer, with gaps that let the UART keep up
+  while (NumSent < NUM_BYTES)
+  {
+    Burst = 1 + rand() % (XMIT_BUFFER_SIZE / 2);
+    for (i = 0; (i < Burst) && (NumSent < NUM_BYTES); i++, NumSent++)
+    {
+      Sent[NumSent] = (uint8_t)rand();
+      Terminal_WriteByte(Sent[NumSent]);
+    }
+    for (i = Burst * BYTE_STEPS + rand() % (Burst * BYTE_STEPS); i > 0; i--)
+    {
+      ModelStep();
+    }
+  }
+  Drain();
+  if ((NumReceived != NUM_BYTES) || (TxDropped != 0) ||
+      (memcmp(Sent, Received, NUM_BYTES) != 0))
+  {
+    printf("bursts: %u of %u bytes out, %u dropped\n", NumReceived,
+        NUM_BYTES, TxDropped);
+    NumErrors++;
+  }
+
+  // too much at once: the oldest bytes are kept, the rest dropped
+  NumReceived = 0;
+  TxDropped   = 0;
+  for (i = 0; i < 3 * XMIT_BUFFER_SIZE; i++)
+  {
+    Sent[i] = (uint8_t)(i * 7);
+    _mon_putc(Sent[i]);
+  }
+  Drain();
+  if ((NumReceived != XMIT_BUFFER_SIZE - 1) ||
+      (TxDropped != 2 * XMIT_BUFFER_SIZE + 1) ||
+      (memcmp(Sent, Received, NumReceived) != 0))
+  {
+    printf("overflow: %u bytes out, %u dropped\n", NumReceived, TxDropped);
+    NumErrors++;
+  }
+  printf("%u bytes in %u steps, %u errors\n", NUM_BYTES + NumReceived,
+      StepCount, NumErrors);
+  return NumErrors != 0;
+}
+#endif /* TERMINAL_MODEL */
 /*------------------------------- Footnotes -------------------------------*/
 /*------------------------------ End of file ------------------------------*/
@@ -8,6 +8,7 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/18/26       karthi24 exported the slider and ALS mailboxes
  10/18/15 11:50 jec      added #include for stdint & stdbool
  08/06/13 14:37 jec      started coding
 *****************************************************************************/
@@ -19,6 +20,7 @@
 //#include <stdint.h>
 #include <stdbool.h>
 #include "PIC32_AD_Lib.h"
+#include "ES_Mailbox.h"
 // prototypes for event checkers
 
 bool Check4Keystroke(void);
@@ -30,4 +32,9 @@ bool Check4LaserHits(void);
 
 void Targets_SetBaselines(uint16_t b12, uint16_t b5, uint16_t b4);
 
+// latest slider position (0-100%), notifies with ES_DIFFICULTY_CHANGED
+extern ES_Mailbox_t DifficultyMailbox;
+// latest raw ALS readings, indexed like the baselines: 0=B1, 1=B2, 2=B3
+extern ES_Mailbox_t AlsMailbox[3];
+
 #endif /* EventCheckers_H */
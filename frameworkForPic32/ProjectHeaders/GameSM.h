@@ -11,6 +11,7 @@
 // Event Definitions
 #include "ES_Configure.h" /* gets us event definitions */
 #include "ES_Types.h"     /* gets bool type for returns */
+#include "ES_Framework.h" /* gets ES_Instance_t */
 
 // ======= PIN MAP:(PIC32MX170F256B) =======
 
@@ -18,6 +19,7 @@
 #define BEAM_BREAK_TRIS      TRISBbits.TRISB8
 #define BEAM_BREAK_PORT      PORTBbits.RB8
 #define BEAM_BREAK_CNPU      CNPUBbits.CNPUB8   // enable internal pull-up for clean idle-high
+#define BEAM_BREAK_CNEN      CNENBbits.CNIEB8   // change notice, gates Check4HandWave
 
 
 // --- Slider (difficulty) on AN11 / RPB13 ---
@@ -44,11 +46,23 @@ typedef enum{
     GS_TestMode // used only for testing
 }GameState_t;
 
+// the state of one game, one per framework context (see ES_Context.h)
+typedef struct
+{
+    ES_Instance_t Base;           // must be first, the framework uses it for posting
+    GameState_t   CurrentState;
+    bool          LedPushPending; // display rows still to be sent
+    uint16_t      Score;          // running score for the current game
+}GameSM_t;
+
+// the instance named in SERV_2_CONTEXT
+extern GameSM_t GameSMInstance;
+
 // Public Function Prototypes
 
-bool InitGameSM(uint8_t Priority);
+bool InitGameSM(void *pContext, uint8_t Priority);
 bool PostGameSM(ES_Event_t ThisEvent);
-ES_Event_t RunGameSM(ES_Event_t ThisEvent);
+ES_Event_t RunGameSM(void *pContext, ES_Event_t ThisEvent);
 GameState_t QueryGameSM(void);
 
 #endif /* GameSM_H */
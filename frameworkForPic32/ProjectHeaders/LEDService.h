@@ -9,6 +9,7 @@
 #define LEDService_H
 
 #include "ES_Types.h"
+#include "ES_Framework.h"
 //typedefs
 
 
@@ -18,11 +19,21 @@ typedef enum {
   // add more if you want other fixed messages later
 } LED_MessageID_t;
 
+// what one game has shown, one per framework context (see ES_Context.h)
+typedef struct {
+  ES_Instance_t Base;             // must be first, the framework uses it for posting
+  bool          LedPushPending;   // display rows still to be sent
+  uint8_t       LastDifficultyBucket; // neopixel bucket on show, 0xFF for none
+} LEDService_t;
+
+// the instance named in SERV_4_CONTEXT
+extern LEDService_t LEDServiceInstance;
+
 // Public Function Prototypes
 
-bool InitLEDService(uint8_t Priority);
+bool InitLEDService(void *pContext, uint8_t Priority);
 bool PostLEDService(ES_Event_t ThisEvent);
-ES_Event_t RunLEDService(ES_Event_t ThisEvent);
+ES_Event_t RunLEDService(void *pContext, ES_Event_t ThisEvent);
 
 #endif /* LEDService_H */
 
@@ -9,6 +9,7 @@
 #define MotorCtrl_H
 
 #include "ES_Types.h"
+#include "ES_Framework.h"
 
 
 // Servo channel mapping
@@ -26,6 +27,16 @@ typedef struct {
   int32_t  ceiling_ticks;   // top limit
 } Axis_t;
 
+// the balloons of one game, one per framework context (see ES_Context.h)
+typedef struct {
+  ES_Instance_t Base;     // must be first, the framework uses it for posting
+  Axis_t   Ax[3];         // each axis has one balloon
+  bool     Crashed;       // a balloon has hit the floor this game
+} MotorCtrl_t;
+
+// the instance named in SERV_3_CONTEXT
+extern MotorCtrl_t MotorCtrlInstance;
+
 
 // Public Function Prototypes
 void MC_SetDifficultyPercent(uint8_t pct); // sets per-axis max_step
@@ -36,9 +47,9 @@ void MC_DispenseTwoGearsOnce(void);
 void MC_DebugPrintAxes(void);
 uint8_t MC_CountBalloonsAboveDangerline(void);
 
-bool InitMotorCtrl(uint8_t Priority);
+bool InitMotorCtrl(void *pContext, uint8_t Priority);
 bool PostMotorCtrl(ES_Event_t ThisEvent);
-ES_Event_t RunMotorCtrl(ES_Event_t ThisEvent);
+ES_Event_t RunMotorCtrl(void *pContext, ES_Event_t ThisEvent);
 
 #endif /* MotorCtrl_H */
 
@@ -0,0 +1,33 @@
+/****************************************************************************
+
+  Header file for template multi-instance service
+  based on the Gen 2 Events and Services Framework
+
+ ****************************************************************************/
+
+#ifndef ServTemplateInstance_H
+#define ServTemplateInstance_H
+
+#include "ES_Types.h"
+#include "ES_Framework.h"
+
+// the context for one instance of the service
+typedef struct
+{
+  ES_Instance_t Base;     // must be first, the framework uses it for posting
+  uint8_t       Channel;  // which hardware this instance looks after
+}TemplateInstance_t;
+
+#define NUM_TEMPLATE_INSTANCES 2
+
+// one context per instance, name these in SERV_n_CONTEXT
+extern TemplateInstance_t TemplateInstances[NUM_TEMPLATE_INSTANCES];
+
+// Public Function Prototypes
+
+bool InitTemplateInstance(void *pContext, uint8_t Priority);
+bool PostTemplateInstance(TemplateInstance_t *pThis, ES_Event_t ThisEvent);
+ES_Event_t RunTemplateInstance(void *pContext, ES_Event_t ThisEvent);
+
+#endif /* ServTemplateInstance_H */
+
@@ -16,6 +16,8 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/18/26       karthi24     keystrokes go to the command shell
+ 10/18/26       karthi24     slider and ALS readings go to mailboxes, not queues
  11/14/25       karthi24     completed integration testing and minor bug fixes
  11/12/25       karthi24     adding code/pseudocode for the final event checker
  11/11/25       karthi24     started adding event checker pseudocode
@@ -48,6 +50,15 @@
 // Baselines: index 0=B1(AN12), 1=B2(AN5), 2=B3(AN4)
 static uint16_t Baselines[3] = {0,0,0}; 
 
+// the slider and ALS readings are state, so they live in mailboxes rather
+// than being queued as events
+ES_Mailbox_t DifficultyMailbox =
+    ES_MAILBOX_INITIALIZER(0, ES_DIFFICULTY_CHANGED);
+ES_Mailbox_t AlsMailbox[3] = {
+    ES_MAILBOX_INITIALIZER(0, ES_NO_EVENT),
+    ES_MAILBOX_INITIALIZER(0, ES_NO_EVENT),
+    ES_MAILBOX_INITIALIZER(0, ES_NO_EVENT) };
+
 /*---------------------------- Module Variables ---------------------------*/
 // with the introduction of Gen2, we need a module level Priority variable
 /*----------------------------- Module Defines ----------------------------*/
@@ -73,17 +84,16 @@ void Targets_SetBaselines(uint16_t, uint16_t, uint16_t);
  Parameters
    None
  Returns
-   bool: true if a new key was detected & posted
+   bool: true if received characters were found & the shell told
  Description
-   checks to see if a new key from the keyboard is detected and, if so,
-   retrieves the key and posts an ES_NewKey event to TestHarnessService0
+   checks to see if the terminal has received characters and, if so, posts
+   ES_SHELL_RX to the command shell, which reads them
  Notes
-   The functions that actually check the serial hardware for characters
-   and retrieve them are assumed to be in ES_Port.c
-   Since we always retrieve the keystroke when we detect it, thus clearing the
-   hardware flag that indicates that a new key is ready this event checker
-   will only generate events on the arrival of new characters, even though we
-   do not internally keep track of the last keystroke that we retrieved.
+   The shell reads at most one line per ES_SHELL_RX, leaving the rest in the
+   terminal's receive buffer. Since this checker only runs with every queue
+   empty, each line of a pasted script is run, and the events that it
+   caused are processed, before the next. The shell posts single key lines
+   to every service as ES_NEW_KEY.
  Author
    J. Edward Carryer, 08/06/13, 13:48
 ****************************************************************************/
@@ -92,9 +102,8 @@ bool Check4Keystroke(void)
     if (IsNewKeyReady())   // new key waiting?
     {
       ES_Event_t ThisEvent;
-      ThisEvent.EventType   = ES_NEW_KEY;
-      ThisEvent.EventParam  = GetNewKey();
-      ES_PostAll(ThisEvent);
+      ThisEvent.EventType   = ES_SHELL_RX;
+      PostShellService(ThisEvent);
       return true;
     }
     return false;
@@ -144,10 +153,9 @@ bool Check4Difficulty(void){
     if (diff >= RAW_DEADBAND) { 
         uint16_t pct = (uint16_t)((raw * 100u) / 1024u);
 //        printf("%u\r\n",pct);
-        ES_Event_t e = { .EventType = ES_DIFFICULTY_CHANGED, .EventParam = (pct) };
-        PostGameSM(e); PostLEDService(e);
+        // subscribers get ES_DIFFICULTY_CHANGED, at most one at a time
         lastRaw = raw;
-        return true;
+        return ES_Mailbox_Write(&DifficultyMailbox, pct);
     }
     
     return false;
@@ -186,6 +194,8 @@ bool Check4LaserHits(void){
 
     for (int i = 0; i < 3; i++) {
         
+        ES_Mailbox_Write(&AlsMailbox[i], v[i]);   // for anyone who wants the level
+
         uint16_t hiThresh = (uint16_t)(Baselines[i] + HIT_DELTA);
         uint16_t loThresh = (uint16_t)(Baselines[i] + RELEASE_DELTA);
 
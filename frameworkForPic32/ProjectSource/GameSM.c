@@ -14,6 +14,18 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/18/26   karthi24    multi-instance service, the game state is kept per context
+ 10/18/26   karthi24    3 s mode timer posts ES_MODE_DONE, no timeout demux
+ 10/18/26   karthi24    -Wextra clean
+ 10/18/26   karthi24    test mode keys are also shell commands
+ 10/18/26   karthi24    game timers post their own events, no timeout demux
+ 10/18/26   karthi24    countdown read from the game timer, no SecondsLeft
+ 10/18/26   karthi24    1s countdown tick may wait for a balloon frame
+ 10/18/26   karthi24    1s countdown tick is a periodic timer
+ 10/18/26   karthi24    state statistics under ES_SM_STATS
+ 10/18/26   karthi24    dispatch through a (state, event) handler table
+ 10/18/26   karthi24    difficulty comes from the slider mailbox
+ 10/18/26   karthi24    enabled change notice on the beam break for checker gating
  11/19/25   karthi24    Completed tuning of motor limits for final project
  11/17/25   karthi24    started minor functionality changes, scoring system, LED service, longer messages
  11/14/25   karthi24    completed integration testing
@@ -30,9 +42,14 @@
 /* include header files for this state machine as well as any machines at the
    next lower level in the hierarchy that are sub-machines to this machine
 */
+#include <string.h>
+
 #include "ES_Configure.h"
 #include "EventCheckers.h"
 #include "ES_Framework.h"
+#include "ES_EventTable.h"
+#include "ES_SMStats.h"
+#include "ES_Shell.h"
 #include "DM_Display.h"
 #include "GameSM.h"
 #include "MotorCtrl.h"
@@ -45,14 +62,39 @@
 
 //#define START_IN_TEST_MODE // used for debugging and testing modules in the state machine, comment out for final functionality
 
+#define NUM_GAME_STATES (GS_TestMode + 1)
+
 #define SERVO_US_TO_TICKS(us)   ((uint16_t)(((us) * 5u) / 2u)) // 0.4 s per tick
 
 /*---------------------------- Module Functions ---------------------------*/
 /* prototypes for private functions for this machine.They should be functions
    relevant to the behavior of this state machine
 */
+static GameSM_t *This(void);
 static void GameHW_InitPins(void);
 static void CaptureALS_Baselines_Init(void);
+static void ReturnToWelcome(void);
+static uint16_t GetSecondsLeft(void);
+static void PostTestKey(char Key);
+static void TestKeyCmd(uint8_t argc, char *argv[]);
+static void BalloonCmd(uint8_t argc, char *argv[]);
+
+// event handlers, named for the state and the event they handle
+static ES_Event_t Any_DifficultyChanged(ES_Event_t ThisEvent);
+static ES_Event_t Any_LedPushStep(ES_Event_t ThisEvent);
+static ES_Event_t InitPState_Init(ES_Event_t ThisEvent);
+static ES_Event_t Waiting_DifficultyChanged(ES_Event_t ThisEvent);
+static ES_Event_t Waiting_HandWave(ES_Event_t ThisEvent);
+static ES_Event_t Gameplay_Hit(ES_Event_t ThisEvent);
+static ES_Event_t Gameplay_NoHit(ES_Event_t ThisEvent);
+static ES_Event_t Gameplay_CountdownTick(ES_Event_t ThisEvent);
+static ES_Event_t Gameplay_GameOver(ES_Event_t ThisEvent);
+static ES_Event_t Gameplay_Inactive(ES_Event_t ThisEvent);
+static ES_Event_t Gameplay_Crashed(ES_Event_t ThisEvent);
+static ES_Event_t NoUserInput_ModeDone(ES_Event_t ThisEvent);
+static ES_Event_t GameOver_ModeDone(ES_Event_t ThisEvent);
+static ES_Event_t TestMode_Any(ES_Event_t ThisEvent);
+static ES_Event_t TestMode_NewKey(ES_Event_t ThisEvent);
 
 #include "LEDService.h"
 
@@ -60,27 +102,102 @@ static void CaptureALS_Baselines_Init(void);
    relevant to the behavior of this state machine
 */
 /*---------------------------- Module Variables ---------------------------*/
-// everybody needs a state variable, you may need others as well.
-// type of state variable should match that of enum in header file
-static GameState_t CurrentState;
-static uint8_t     SecondsLeft;
-
-// g stands for global, GS stands for Game State, BC stands for Balloon control
-static bool g_LedPushPending = false;
-static bool g_DisplayInitDone = false;
-static bool g_SPI_InitDone = false;
+// the instance named in SERV_2_CONTEXT. A framework context may be given
+// another one of its own, see ES_Context.h
+GameSM_t GameSMInstance;
 
-static uint16_t    g_Score; // running variable for score
+// everybody needs a state variable, you may need others as well.
+// These live in the instance of the current context (see This), and the
+// names below reach them there, so that each context plays its own game.
+#define CurrentState (This()->CurrentState)
+#define g_LedPushPending (This()->LedPushPending)
+#define g_Score (This()->Score)
 
 // with the introduction of Gen2, we need a module level Priority var as well
+// It is the same in every context, so it stays a module variable.
 static uint8_t MyPriority;
 
+// the test mode keys, as shell commands that post the key
+typedef struct {
+    ES_ShellCommand_t Command;
+    char              Key;
+} TestCommand_t;
+
+static const TestCommand_t TestCommands[] = {
+    { { "baseline", "baseline, capture the ALS baselines", TestKeyCmd }, '1' },
+    { { "beam",     "beam, read the beam break sensor",    TestKeyCmd }, '2' },
+    { { "top",      "top, raise all balloons to the top",  TestKeyCmd }, '3' },
+    { { "servo",    "servo, pulse the B1 servo",           TestKeyCmd }, 'm' },
+    { { "adc",      "adc, read the analog inputs",         TestKeyCmd }, 'a' },
+    { { "gears",    "gears, dispense two gears",           TestKeyCmd }, 'g' },
+    { { "axes",     "axes, print the balloon positions",   TestKeyCmd }, 'd' },
+    { { "welcome",  "welcome, show the welcome message",   TestKeyCmd }, 'l' },
+    { { "play",     "play, leave test mode for the game",  TestKeyCmd }, 'x' },
+};
+
+// rise & fall take the balloon number, and post one of these keys
+static const ES_ShellCommand_t RiseCommand =
+    { "rise", "rise <1-3>, raise a balloon", BalloonCmd };
+static const ES_ShellCommand_t FallCommand =
+    { "fall", "fall <1-3>, lower a balloon", BalloonCmd };
+static const char RiseKeys[] = "89f";
+static const char FallKeys[] = "qwe";
+
+// the slider value must be taken, and the LED rows pushed, in every state
+#define GAME_ROW_DEFAULTS ES_ROW_DEFAULTS, \
+    [ES_DIFFICULTY_CHANGED] = Any_DifficultyChanged, \
+    [ES_LED_PUSH_STEP]      = Any_LedPushStep
+
+ES_TABLE_BEGIN
+static ES_EventHandler_t const GameTable[NUM_GAME_STATES][ES_NUM_EVENT_TYPES] =
+{
+    ES_TABLE_DEFAULTS(NUM_GAME_STATES),
+    [GS_InitPState] = { GAME_ROW_DEFAULTS,
+        [ES_INIT]               = InitPState_Init },
+    [GS_Welcome] = { GAME_ROW_DEFAULTS },
+    [GS_WaitingForHandWave] = { GAME_ROW_DEFAULTS,
+        [ES_DIFFICULTY_CHANGED] = Waiting_DifficultyChanged,
+        [ES_HAND_WAVE_DETECTED] = Waiting_HandWave },
+    [GS_Gameplay] = { GAME_ROW_DEFAULTS,
+        [DIRECT_HIT_B1]         = Gameplay_Hit,
+        [DIRECT_HIT_B2]         = Gameplay_Hit,
+        [DIRECT_HIT_B3]         = Gameplay_Hit,
+        [NO_HIT_B1]             = Gameplay_NoHit,
+        [NO_HIT_B2]             = Gameplay_NoHit,
+        [NO_HIT_B3]             = Gameplay_NoHit,
+        [ES_COUNTDOWN_TICK]     = Gameplay_CountdownTick,
+        [ES_GAME_OVER]          = Gameplay_GameOver,
+        [ES_USER_INACTIVE]      = Gameplay_Inactive,
+        [ES_OBJECT_CRASHED]     = Gameplay_Crashed },
+    [GS_NoUserInput] = { GAME_ROW_DEFAULTS,
+        [ES_MODE_DONE]          = NoUserInput_ModeDone },
+    [GS_LosingMode] = { GAME_ROW_DEFAULTS,
+        [ES_MODE_DONE]          = GameOver_ModeDone },
+    [GS_CompletingMode] = { GAME_ROW_DEFAULTS,
+        [ES_MODE_DONE]          = GameOver_ModeDone },
+    // motor control stays stopped whatever arrives in test mode
+    [GS_TestMode] = { ES_ROW_FILL(TestMode_Any),
+        [ES_DIFFICULTY_CHANGED] = Any_DifficultyChanged,
+        [ES_LED_PUSH_STEP]      = Any_LedPushStep,
+        [ES_NEW_KEY]            = TestMode_NewKey },
+};
+ES_TABLE_END
+
+#ifdef ES_SM_STATS
+ES_SM_STATS_DEFINE(GameStats, NUM_GAME_STATES);
+static const char * const GameStateNames[NUM_GAME_STATES] = {
+    "InitPState", "Welcome", "WaitingForHandWave", "Gameplay",
+    "CompletingMode", "LosingMode", "NoUserInput", "TestMode"
+};
+#endif
+
 /*------------------------------ Module Code ------------------------------*/
 /****************************************************************************
  Function
      InitGameSM
 
  Parameters
+     void * : the instance for this context
      uint8_t : the priorty of this service
 
  Returns
@@ -90,16 +207,37 @@ static uint8_t MyPriority;
      Saves away the priority, sets up the initial transition and does any
      other required initialization for this state machine
  Notes
+     the framework has already made pContext the instance of this context,
+     which is where CurrentState now points. The mailbox subscription and
+     the shell commands are shared, adding them again changes nothing.
 
  Author
      J. Edward Carryer, 10/23/11, 18:55
 ****************************************************************************/
-bool InitGameSM(uint8_t Priority)
+bool InitGameSM(void *pContext, uint8_t Priority)
 {
+    (void)pContext;
     
     ES_Event_t e = { .EventType = ES_INIT };
     
     MyPriority = Priority;
+    ES_Mailbox_Subscribe(&DifficultyMailbox, MyPriority);
+    for (uint8_t i = 0; i < ARRAY_SIZE(TestCommands); i++){
+        ES_Shell_AddCommand(&TestCommands[i].Command);
+    }
+    ES_Shell_AddCommand(&RiseCommand);
+    ES_Shell_AddCommand(&FallCommand);
+    // the game timers post straight to their handlers
+    ES_Event_t timerEvt = { .EventType = ES_COUNTDOWN_TICK };
+    ES_Timer_SetEvent(TID_TICK_1S, timerEvt);
+    timerEvt.EventType = ES_GAME_OVER;
+    ES_Timer_SetEvent(TID_GAME_60S, timerEvt);
+    timerEvt.EventType = ES_USER_INACTIVE;
+    ES_Timer_SetEvent(TID_INACTIVITY_20S, timerEvt);
+    timerEvt.EventType = ES_MODE_DONE;
+    ES_Timer_SetEvent(TID_MODE_3S, timerEvt);
+    // the countdown can go off with the next balloon frame, one wake-up
+    ES_Timer_SetSlack(TID_TICK_1S, 100);
     
     GameHW_InitPins();
     
@@ -109,6 +247,12 @@ bool InitGameSM(uint8_t Priority)
     #else
     CurrentState = GS_InitPState;
     #endif
+    g_LedPushPending = false;
+    g_Score = 0;
+    
+#ifdef ES_SM_STATS
+    ES_SMStats_Init(&GameStats, "GameSM", GameStateNames, CurrentState);
+#endif
     
     return ES_PostToService(MyPriority, e);   
 }
@@ -140,383 +284,404 @@ bool PostGameSM(ES_Event_t ThisEvent)
     RunGameSM
 
  Parameters
+   void * : the instance for this context
    ES_Event_t : the event to process
 
  Returns
    ES_Event_t, ES_NO_EVENT if no error ES_ERROR otherwise
 
  Description
-   add your description here
+   runs the handler for the current state and the event type
  Notes
-   uses nested switch/case to implement the machine.
+   uses the GameTable (state, event) handler table to implement the machine.
+   The handlers reach the instance through This(), which is pContext.
  Author
    J. Edward Carryer, 01/15/12, 15:23
 ****************************************************************************/
-ES_Event_t RunGameSM(ES_Event_t ThisEvent)
+ES_Event_t RunGameSM(void *pContext, ES_Event_t ThisEvent)
 {
-    printf("Entering Run function because of event: %lu\r\n", ThisEvent.EventType);
-    ES_Event_t ReturnEvent = { .EventType = ES_NO_EVENT };
-//     printf("Entering RunGameSM because of event: %lu\r\n", ThisEvent.EventType);
-    // Global handler: row-by-row LED update: handled regardless of CurrentState
-    if (ThisEvent.EventType == ES_LED_PUSH_STEP){
-//        printf("Pushing to LED\r\n");
-        if (g_LedPushPending){
-            bool done = DM_TakeDisplayUpdateStep();   // sends 1 row this call 
-            if (!done){
-                // not finished: post yourself again to send the next row later
-                ES_Event_t again = { .EventType = ES_LED_PUSH_STEP };
-                PostGameSM(again);
-            } else {
-              g_LedPushPending = false;               // all 8 rows sent
-            }
-        }    
-        return ReturnEvent;
-    }
-    
-    switch (CurrentState)
-    {
-        case GS_InitPState:        // If current state is initial Psedudo State
-        {
-            //
-            if (ThisEvent.EventType == ES_INIT)    // only respond to ES_Init
-            {
-
-                // Capture baselines for ALS-PT19 sensors once at boot
-                CaptureALS_Baselines_Init();
-                
-                // Display welcome message
-                ES_Event_t ledEvt = {
-                                        .EventType = ES_LED_SHOW_MESSAGE,
-                                        .EventParam = (uint16_t)LED_MSG_WELCOME
-                                    };
-                PostLEDService(ledEvt);
-                
-                MC_RaiseAllToTop();
-                
-                CurrentState = GS_WaitingForHandWave;
-            }
-        }break;
+    (void)pContext;
+    ES_Event_t ReturnEvent = ES_DISPATCH_TABLE(GameTable, CurrentState, ThisEvent);
+#ifdef ES_SM_STATS
+    ES_SMStats_Update(&GameStats, CurrentState);
+#endif
+    return ReturnEvent;
+}
 
-        case GS_WaitingForHandWave: {
-            switch(ThisEvent.EventType){
-
-                case ES_DIFFICULTY_CHANGED:{
-                      uint8_t pct = ThisEvent.EventParam;
-
-                      ES_Event_t ledEvt = {
-                          .EventType = ES_LED_SHOW_DIFFICULTY,
-                          .EventParam = pct
-                      };
-
-                      PostLEDService(ledEvt);
-
-                      MC_SetDifficultyPercent(pct);     // update motion speeds
-                }break;
-
-                case ES_HAND_WAVE_DETECTED:{// from event checker
-                    g_Score     = 0;
-
-                    SecondsLeft = 60;
-
-                    ES_Event_t ledEvt = {
-                        .EventType = ES_LED_SHOW_COUNTDOWN,
-                        .EventParam = SecondsLeft
-                    };
-                    
-                    PostLEDService(ledEvt);
-
-                    // Start timers: 60s gameplay, 20s inactivity, 1s tick
-                    ES_Timer_InitTimer(TID_GAME_60S,     60000);
-                    ES_Timer_InitTimer(TID_INACTIVITY_20S, 20000);
-                    ES_Timer_InitTimer(TID_TICK_1S,       1000);
-                    // Begin falling all balloons
-                    MC_CommandFall(1); 
-                    MC_CommandFall(2); 
-                    MC_CommandFall(3);
-                    CurrentState = GS_Gameplay;
-
-                      
-                    
-                }break; 
-                      
-                  
-            }break;
-            
-        }break;
 
-        case GS_Gameplay: {
-            switch(ThisEvent.EventType){
+/****************************************************************************
+ Function
+     QueryGameSM
 
-                // Laser hit logic (laser hit implies RISE; no hit implies FALL)
-                case DIRECT_HIT_B1: {MC_CommandRise(1); ES_Timer_InitTimer(TID_INACTIVITY_20S,20000);} break;
+ Parameters
+     None
 
-                case DIRECT_HIT_B2: {MC_CommandRise(2); ES_Timer_InitTimer(TID_INACTIVITY_20S,20000);} break;
+ Returns
+     GameState_t The current state of the game state machine
 
-                case DIRECT_HIT_B3: {MC_CommandRise(3); ES_Timer_InitTimer(TID_INACTIVITY_20S,20000);} break;
+ Description
+     returns the current state of the game state machine
+ Notes
+     the state of the game in the current framework context
 
-                case NO_HIT_B1:{    MC_CommandFall(1);} break;
+ Author
+     J. Edward Carryer, 10/23/11, 19:21
+****************************************************************************/
+GameState_t QueryGameSM(void)
+{
+  return CurrentState;
+}
 
-                case NO_HIT_B2:{    MC_CommandFall(2);} break;
+/***************************************************************************
+ event handlers, one per (state, event) pair in GameTable
+ ***************************************************************************/
 
-                case NO_HIT_B3:{    MC_CommandFall(3);} break;
+// take the latest slider value in every state, to re-arm the notification
+static ES_Event_t Any_DifficultyChanged(ES_Event_t ThisEvent){
+    (void)ThisEvent;
+    ES_Mailbox_Take(&DifficultyMailbox, MyPriority);
+    return ES_EVENT_HANDLED;
+}
 
-                case ES_TIMEOUT:
-                    
-                    if (ThisEvent.EventParam == TID_TICK_1S){            // 1 Hz display update
-                        
-                        if (SecondsLeft) SecondsLeft--;
+// row-by-row LED update: handled regardless of CurrentState
+static ES_Event_t Any_LedPushStep(ES_Event_t ThisEvent){
+    (void)ThisEvent;
+    if (g_LedPushPending){
+        bool done = DM_TakeDisplayUpdateStep();   // sends 1 row this call 
+        if (!done){
+            // not finished: post yourself again to send the next row later
+            ES_Event_t again = { .EventType = ES_LED_PUSH_STEP };
+            PostGameSM(again);
+        } else {
+          g_LedPushPending = false;               // all 8 rows sent
+        }
+    }    
+    return ES_EVENT_HANDLED;
+}
 
-                        ES_Event_t ledEvt = {
-                            .EventType = ES_LED_SHOW_COUNTDOWN,
-                            .EventParam = SecondsLeft
+static ES_Event_t InitPState_Init(ES_Event_t ThisEvent){
+    (void)ThisEvent;
+    // Capture baselines for ALS-PT19 sensors once at boot
+    CaptureALS_Baselines_Init();
+    
+    // Display welcome message
+    ES_Event_t ledEvt = {
+                            .EventType = ES_LED_SHOW_MESSAGE,
+                            .EventParam = (uint16_t)LED_MSG_WELCOME
                         };
+    PostLEDService(ledEvt);
+    
+    MC_RaiseAllToTop();
+    
+    CurrentState = GS_WaitingForHandWave;
+    return ES_EVENT_HANDLED;
+}
 
-                        PostLEDService(ledEvt);
+static ES_Event_t Waiting_DifficultyChanged(ES_Event_t ThisEvent){
+    (void)ThisEvent;
+    uint8_t pct = ES_Mailbox_Take(&DifficultyMailbox, MyPriority);
 
-                        uint8_t afloat = MC_CountBalloonsAboveDangerline();
-                        g_Score += afloat;
+    ES_Event_t ledEvt = {
+        .EventType = ES_LED_SHOW_DIFFICULTY,
+        .EventParam = pct
+    };
 
-                        ES_Timer_InitTimer(TID_TICK_1S,1000);
-                        
-                    } else if (ThisEvent.EventParam == TID_GAME_60S){ // Victory - Game over
-                        
-                        CurrentState = GS_CompletingMode;
-                        
-                        ES_Event_t ledEvt = {
-                            .EventType = ES_LED_SHOW_SCORE,
-                            .EventParam = g_Score
-                        };
-                        PostLEDService(ledEvt);
+    PostLEDService(ledEvt);
 
-                        ES_Timer_InitTimer(TID_MODE_3S,3000);
+    MC_SetDifficultyPercent(pct);     // update motion speeds
+    return ES_EVENT_HANDLED;
+}
 
-                    } else if (ThisEvent.EventParam == TID_INACTIVITY_20S){ // User inactive - Game over
+static ES_Event_t Waiting_HandWave(ES_Event_t ThisEvent){// from event checker
+    (void)ThisEvent;
+    g_Score     = 0;
 
-                      CurrentState = GS_NoUserInput;
-                      ES_Timer_InitTimer(TID_MODE_3S,3000);
+    // Start timers: 60s gameplay, 20s inactivity, 1s tick
+    ES_Timer_InitTimer(TID_GAME_60S,     60000);
+    ES_Timer_InitTimer(TID_INACTIVITY_20S, 20000);
+    ES_Timer_InitPeriodic(TID_TICK_1S,    1000);
 
-                    }break;
-                    
-                    case ES_OBJECT_CRASHED:
-                        CurrentState = GS_LosingMode;
-                        
-                        ES_Event_t ledEvt = {
-                            .EventType = ES_LED_SHOW_SCORE,
-                            .EventParam = g_Score
-                        };
-                        PostLEDService(ledEvt);
-                        
-                        ES_Timer_InitTimer(TID_MODE_3S,3000);
-                        break;
+    ES_Event_t ledEvt = {
+        .EventType = ES_LED_SHOW_COUNTDOWN,
+        .EventParam = GetSecondsLeft()
+    };
+    
+    PostLEDService(ledEvt);
+    // Begin falling all balloons
+    MC_CommandFall(1); 
+    MC_CommandFall(2); 
+    MC_CommandFall(3);
+    CurrentState = GS_Gameplay;
+    return ES_EVENT_HANDLED;
+}
 
-            }break;
+// Laser hit logic (laser hit implies RISE; no hit implies FALL)
+static ES_Event_t Gameplay_Hit(ES_Event_t ThisEvent){
+    MC_CommandRise(ThisEvent.EventType - DIRECT_HIT_B1 + 1);
+    ES_Timer_InitTimer(TID_INACTIVITY_20S,20000);
+    return ES_EVENT_HANDLED;
+}
 
-        }break;
+static ES_Event_t Gameplay_NoHit(ES_Event_t ThisEvent){
+    MC_CommandFall(ThisEvent.EventType - NO_HIT_B1 + 1);
+    return ES_EVENT_HANDLED;
+}
+
+static ES_Event_t Gameplay_CountdownTick(ES_Event_t ThisEvent){ // 1 Hz display update
+    (void)ThisEvent;
+    ES_Event_t ledEvt = {
+        .EventType = ES_LED_SHOW_COUNTDOWN,
+        .EventParam = GetSecondsLeft()
+    };
+
+    PostLEDService(ledEvt);
+
+    uint8_t afloat = MC_CountBalloonsAboveDangerline();
+    g_Score += afloat;
+    return ES_EVENT_HANDLED;
+}
+
+static ES_Event_t Gameplay_GameOver(ES_Event_t ThisEvent){ // Victory - Game over
+    (void)ThisEvent;
+    CurrentState = GS_CompletingMode;
+    ES_Timer_StopTimer(TID_TICK_1S);
+    
+    ES_Event_t ledEvt = {
+        .EventType = ES_LED_SHOW_SCORE,
+        .EventParam = g_Score
+    };
+    PostLEDService(ledEvt);
+
+    ES_Timer_InitTimer(TID_MODE_3S,3000);
+    return ES_EVENT_HANDLED;
+}
+
+static ES_Event_t Gameplay_Inactive(ES_Event_t ThisEvent){ // User inactive - Game over
+    (void)ThisEvent;
+    CurrentState = GS_NoUserInput;
+    ES_Timer_StopTimer(TID_TICK_1S);
+    ES_Timer_InitTimer(TID_MODE_3S,3000);
+    return ES_EVENT_HANDLED;
+}
+
+static ES_Event_t Gameplay_Crashed(ES_Event_t ThisEvent){
+    (void)ThisEvent;
+    CurrentState = GS_LosingMode;
+    ES_Timer_StopTimer(TID_TICK_1S);
+    
+    ES_Event_t ledEvt = {
+        .EventType = ES_LED_SHOW_SCORE,
+        .EventParam = g_Score
+    };
+    PostLEDService(ledEvt);
+    
+    ES_Timer_InitTimer(TID_MODE_3S,3000);
+    return ES_EVENT_HANDLED;
+}
+
+static ES_Event_t NoUserInput_ModeDone(ES_Event_t ThisEvent){
+    (void)ThisEvent;
+    ReturnToWelcome();
+    return ES_EVENT_HANDLED;
+}
+
+// the end of both a win (GS_CompletingMode) and a loss (GS_LosingMode)
+static ES_Event_t GameOver_ModeDone(ES_Event_t ThisEvent){
+    (void)ThisEvent;
+    MC_DispenseTwoGearsOnce();                      // sweep min to max one time
+    ReturnToWelcome();
+    return ES_EVENT_HANDLED;
+}
+
+// entering calibration mode this stops motor ctrl:
+static ES_Event_t TestMode_Any(ES_Event_t ThisEvent){
+    (void)ThisEvent;
+    ES_Timer_StopTimer(TID_BALLOON_UPDATE);  // MotorCtrl won't run updates 
+    return ES_EVENT_HANDLED;
+}
+
+static ES_Event_t TestMode_NewKey(ES_Event_t ThisEvent){
+    char k = (char)ThisEvent.EventParam;
+
+    TestMode_Any(ThisEvent);
+
+    switch (k) {
+        
+        case '1':
+            printf("setting als sensor baselines\r\n");
+            CaptureALS_Baselines_Init();
+            
+            break;
         
-        case GS_NoUserInput: {
-            if (ThisEvent.EventType == ES_TIMEOUT && ThisEvent.EventParam == TID_MODE_3S){
-                MC_RaiseAllToTop();
-                ES_Event_t ledEvt = {
-                                        .EventType = ES_LED_SHOW_MESSAGE,
-                                        .EventParam = (uint16_t)LED_MSG_WELCOME
-                                    };
-                PostLEDService(ledEvt);
-                CurrentState = GS_WaitingForHandWave;
-            }
+        case '2':
+            printf("testing the beam break sensor\r\n");
+            printf("value at digital input is : %lu\r\n",
+                   BEAM_BREAK_PORT);
+            break;
+        
+        case '3':{   // 
+            //
+            
+            MC_RaiseAllToTop();
+            
+            
         }break;
         
-        case GS_LosingMode: {
-            if (ThisEvent.EventType == ES_TIMEOUT && ThisEvent.EventParam == TID_MODE_3S){
-                MC_RaiseAllToTop();
-                MC_DispenseTwoGearsOnce();
-                ES_Event_t ledEvt = {
-                                        .EventType = ES_LED_SHOW_MESSAGE,
-                                        .EventParam = (uint16_t)LED_MSG_WELCOME
-                                    };
-                PostLEDService(ledEvt);
-                CurrentState = GS_WaitingForHandWave;
-            } 
+        
+        case 'm':
+            printf("testing servo motors\r\n");
+            // 500-2500 us for the SKU: 2000-0025-0504 super speed servo
+            // 437-2637 us for the SKU: 31318 HS-318 servo
+            static uint16_t TestPulseUs    = 550; // 500-2500 us for the SKU: 2000-0025-0504 super speed
+            uint16_t ticks = SERVO_US_TO_TICKS(TestPulseUs);
+            
+            printf("Commanding Channel 3 OC3 pin 10. Motor for B2. Commanding it to pwm microsecond value %lu\r\n", TestPulseUs);
+            PWMOperate_SetPulseWidthOnChannel(ticks, B1_SERVO_CHANNEL);
+            // similar print state
+            break;
+        
+        case 'a':{   // analog test
+            // read ADCs once and print
+            GameHW_InitPins();
+            uint32_t adc[8];
+            ADC_MultiRead(adc);
+            printf("AN11(slider)=%lu AN12(B1)=%lu AN5(B2)=%lu AN4(B3)=%lu\r\n",
+                   adc[2], adc[3], adc[1], adc[0]);
         }break;
         
-        case GS_CompletingMode: {
-            if (ThisEvent.EventType == ES_TIMEOUT && ThisEvent.EventParam == TID_MODE_3S){
-                MC_RaiseAllToTop();
-                MC_DispenseTwoGearsOnce();                      // sweep min to max one time
-                ES_Event_t ledEvt = {
-                                        .EventType = ES_LED_SHOW_MESSAGE,
-                                        .EventParam = (uint16_t)LED_MSG_WELCOME
-                                    };
-                PostLEDService(ledEvt);
-                CurrentState = GS_WaitingForHandWave;
-            }
+
+        case '8':   // move B1 up : Requires re-enabling of the motor control timer
+            MC_CommandRise(1);
+            printf("B1 rise\r\n");
+            break;
+
+        case 'q':   // move B1 down : Requires re-enabling of the motor control timer
+            MC_CommandFall(1);
+            printf("B1 fall\r\n");
+            break;
+
+        case '9':   // B2 up : Requires re-enabling of the motor control timer
+            MC_CommandRise(2);
+            printf("B2 rise\r\n");
+            break;
+
+        case 'w':   // B2 down : Requires re-enabling of the motor control timer
+            MC_CommandFall(2);
+            printf("B2 fall\r\n");
+            break;
+
+        case 'f':   // B3 up : Requires re-enabling of the motor control timer
+            MC_CommandRise(3);
+            printf("B3 rise\r\n");
+            break;
+
+        case 'e':   // B3 down : Requires re-enabling of the motor control timer
+            MC_CommandFall(3);
+            printf("B3 fall\r\n");
+            break;
+
+        case 'g':   // test gear dispenser
+            MC_DispenseTwoGearsOnce();
+            printf("Dispense test\r\n");
+            break;
+        
+        
+
+        case 'd':   // dump positions
+            MC_DebugPrintAxes();
+            break;
+        
+        case 'l':{
+            ES_Event_t ledEvt = {  // leave test mode, run actual game
+                    .EventType = ES_LED_SHOW_MESSAGE,
+                    .EventParam = (uint16_t)LED_MSG_WELCOME
+                };
+            PostLEDService(ledEvt);
         }break;
         
-        case GS_TestMode: {
-            // entering calibration mode this stops motor ctrl:
-            ES_Timer_StopTimer(TID_BALLOON_UPDATE);  // MotorCtrl won?t run updates 
+        case 'x':{
+            ES_Event_t ledEvt = {  // leave test mode, run actual game
+                    .EventType = ES_LED_SHOW_MESSAGE,
+                    .EventParam = (uint16_t)LED_MSG_WELCOME
+                };
+            PostLEDService(ledEvt);
+            CurrentState = GS_WaitingForHandWave;
+            printf("Exiting TestMode and restarting motor Ctrl timer ? WaitingForHandWave\r\n");
+            ES_Timer_StartTimer(TID_BALLOON_UPDATE);  // Restart MotorCtrl timer
             
-            switch (ThisEvent.EventType) {
-                case ES_NEW_KEY: {
-                        char k = (char)ThisEvent.EventParam;
-
-                        switch (k) {
-                            
-                            case '1':
-                                printf("setting als sensor baselines\r\n");
-                                CaptureALS_Baselines_Init();
-                                
-                                break;
-                            
-                            case '2':
-                                printf("testing the beam break sensor\r\n");
-                                printf("value at digital input is : %lu\r\n",
-                                       BEAM_BREAK_PORT);
-                                break;
-                            
-                            case '3':{   // 
-                                //
-                                
-                                MC_RaiseAllToTop();
-                                
-                                
-                            }break;
-                            
-                            
-                            case 'm':
-                                printf("testing servo motors\r\n");
-                                // 500-2500 us for the SKU: 2000-0025-0504 super speed servo
-                                // 437-2637 us for the SKU: 31318 HS-318 servo
-                                static uint16_t TestPulseUs    = 550; // 500-2500 us for the SKU: 2000-0025-0504 super speed
-                                uint16_t ticks = SERVO_US_TO_TICKS(TestPulseUs);
-                                
-                                printf("Commanding Channel 3 OC3 pin 10. Motor for B2. Commanding it to pwm microsecond value %lu\r\n", TestPulseUs);
-                                PWMOperate_SetPulseWidthOnChannel(ticks, B1_SERVO_CHANNEL);
-                                // similar print state
-                                break;
-                            
-                            case 'a':{   // analog test
-                                // read ADCs once and print
-                                GameHW_InitPins();
-                                uint32_t adc[8];
-                                ADC_MultiRead(adc);
-                                printf("AN11(slider)=%lu AN12(B1)=%lu AN5(B2)=%lu AN4(B3)=%lu\r\n",
-                                       adc[2], adc[3], adc[1], adc[0]);
-                            }break;
-                            
-
-                            case '8':   // move B1 up : Requires re-enabling of the motor control timer
-                                MC_CommandRise(1);
-                                printf("B1 rise\r\n");
-                                break;
-
-                            case 'q':   // move B1 down : Requires re-enabling of the motor control timer
-                                MC_CommandFall(1);
-                                printf("B1 fall\r\n");
-                                break;
-
-                            case '9':   // B2 up : Requires re-enabling of the motor control timer
-                                MC_CommandRise(2);
-                                printf("B2 rise\r\n");
-                                break;
-
-                            case 'w':   // B2 down : Requires re-enabling of the motor control timer
-                                MC_CommandFall(2);
-                                printf("B2 fall\r\n");
-                                break;
-
-                            case 'f':   // B3 up : Requires re-enabling of the motor control timer
-                                MC_CommandRise(3);
-                                printf("B3 rise\r\n");
-                                break;
-
-                            case 'e':   // B3 down : Requires re-enabling of the motor control timer
-                                MC_CommandFall(3);
-                                printf("B3 fall\r\n");
-                                break;
-
-                            case 'g':   // test gear dispenser
-                                MC_DispenseTwoGearsOnce();
-                                printf("Dispense test\r\n");
-                                break;
-                            
-                            
-
-                            case 'd':   // dump positions
-                                MC_DebugPrintAxes();
-                                break;
-                            
-                            case 'l':{
-                                ES_Event_t ledEvt = {  // leave test mode, run actual game
-                                        .EventType = ES_LED_SHOW_MESSAGE,
-                                        .EventParam = (uint16_t)LED_MSG_WELCOME
-                                    };
-                                PostLEDService(ledEvt);
-                            }break;
-                            
-                            case 'x':{
-                                ES_Event_t ledEvt = {  // leave test mode, run actual game
-                                        .EventType = ES_LED_SHOW_MESSAGE,
-                                        .EventParam = (uint16_t)LED_MSG_WELCOME
-                                    };
-                                PostLEDService(ledEvt);
-                                CurrentState = GS_WaitingForHandWave;
-                                printf("Exiting TestMode and restarting motor Ctrl timer ? WaitingForHandWave\r\n");
-                                ES_Timer_StartTimer(TID_BALLOON_UPDATE);  // Restart MotorCtrl timer
-                                
-                                
-                            }break;  
-                                
-                        }//switch (k)
-                        
-                }break; //case ES_NEW_KEY:
-
-                default:
-                // ignore other events in TestMode
-                break;
-                
-            }//switch (ThisEvent.EventType)
             
-        } break; // case GS_TestMode:
-        
-        default: break;
-        
-    }
-  return ReturnEvent;
-  
+        }break;  
+            
+    }//switch (k)
+    return ES_EVENT_HANDLED;
 }
 
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+// the game of the current framework context
+static GameSM_t *This(void){
+    return (GameSM_t *)ES_GetServiceContext(MyPriority);
+}
 
-/****************************************************************************
- Function
-     QueryGameSM
+// whole seconds left on the game timer, rounded up so the display reads 60
+// at the start and 0 only once the game is over
+static uint16_t GetSecondsLeft(void){
+    return (uint16_t)((ES_Timer_GetRemaining(TID_GAME_60S) + 999) / 1000);
+}
 
- Parameters
-     None
+// test commands run through TestMode_NewKey, as if the key had been typed
+static void PostTestKey(char Key){
+    if (CurrentState != GS_TestMode){
+        printf("not in test mode\r\n");
+        return;
+    }
+    ES_Event_t keyEvt = { .EventType = ES_NEW_KEY, .EventParam = (uint8_t)Key };
+    PostGameSM(keyEvt);
+}
 
- Returns
-     GameState_t The current state of the game state machine
+// shell command for the keys in TestCommands
+static void TestKeyCmd(uint8_t argc, char *argv[]){
+    (void)argc;
+    for (uint8_t i = 0; i < ARRAY_SIZE(TestCommands); i++){
+        if (strcmp(argv[0], TestCommands[i].Command.Name) == 0){
+            PostTestKey(TestCommands[i].Key);
+            return;
+        }
+    }
+}
 
- Description
-     returns the current state of the game state machine
- Notes
+// shell command for rise <1-3> & fall <1-3>
+static void BalloonCmd(uint8_t argc, char *argv[]){
+    const char *keys = (strcmp(argv[0], "rise") == 0) ? RiseKeys : FallKeys;
 
- Author
-     J. Edward Carryer, 10/23/11, 19:21
-****************************************************************************/
-GameState_t QueryGameSM(void)
-{
-  return CurrentState;
+    if ((argc != 2) || (argv[1][0] < '1') || (argv[1][0] > '3') ||
+        (argv[1][1] != '\0')){
+        printf("%s <1-3>\r\n", argv[0]);
+        return;
+    }
+    PostTestKey(keys[argv[1][0] - '1']);
 }
 
-/***************************************************************************
- private functions
- ***************************************************************************/
+// back to the welcome message with the balloons up, ready for a new game
+static void ReturnToWelcome(void){
+    MC_RaiseAllToTop();
+    ES_Event_t ledEvt = {
+                            .EventType = ES_LED_SHOW_MESSAGE,
+                            .EventParam = (uint16_t)LED_MSG_WELCOME
+                        };
+    PostLEDService(ledEvt);
+    CurrentState = GS_WaitingForHandWave;
+}
 
 
 static void GameHW_InitPins(void){
     // --- Beam-break: digital input, pull-up, digital mode ---
     BEAM_BREAK_TRIS = 1;
     BEAM_BREAK_CNPU = 0;
+    // change notice on RB8 sets CNBIF, which lets Check4HandWave run
+    CNCONBbits.ON = 1;
+    BEAM_BREAK_CNEN = 1;
     
 
     // --- Slider (AN11): analog input ---
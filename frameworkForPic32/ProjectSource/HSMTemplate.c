@@ -13,6 +13,7 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/18/26       karthi24 added the hook for state statistics
  02/27/17 09:48 jec      another correction to re-assign both CurrentEvent
                          and ReturnEvent to the result of the During function
                          this eliminates the need for the prior fix and allows
@@ -57,6 +58,7 @@
    next lower level in the hierarchy that are sub-machines to this machine
 */
 #include "HSMTemplate.h"
+#include "ES_SMStats.h"
 
 /*----------------------------- Module Defines ----------------------------*/
 // define constants for the states for this machine
@@ -75,6 +77,11 @@ static ES_Event_t DuringStateOne( ES_Event_t Event);
 // everybody needs a state variable, you may need others as well
 static TemplateState_t CurrentState;
 
+#ifdef ES_SM_STATS
+// entries, dwell times and transitions for each state, see ES_SMStats.h
+ES_SM_STATS_DEFINE(TemplateStats, STATE_TWO + 1);
+#endif
+
 /*------------------------------ Module Code ------------------------------*/
 /****************************************************************************
  Function
@@ -142,6 +149,9 @@ ES_Event_t RunTemplateSM( ES_Event_t CurrentEvent )
        // this defaults to ES_ENTRY
        RunTemplateSM(EntryEventKind);
      }
+#ifdef ES_SM_STATS
+     ES_SMStats_Update(&TemplateStats, CurrentState);
+#endif
      return(ReturnEvent);
 }
 /****************************************************************************
@@ -171,6 +181,13 @@ void StartTemplateSM ( ES_Event_t CurrentEvent )
    {
         CurrentState = ENTRY_STATE;
    }
+#ifdef ES_SM_STATS
+   // a sub-machine is started on every entry, but only counted from the first
+   if (TemplateStats.pName == NULL)
+   {
+      ES_SMStats_Init(&TemplateStats, "TemplateSM", NULL, CurrentState);
+   }
+#endif
    // call the entry function (if any) for the ENTRY_STATE
    RunTemplateSM(CurrentEvent);
 }
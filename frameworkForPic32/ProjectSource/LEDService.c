@@ -14,6 +14,10 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/18/26      karthi24  multi-instance service, push & bucket state kept per context
+ 10/18/26      karthi24  -Wextra clean
+ 10/18/26      karthi24  dispatch through an event handler table
+ 10/18/26      karthi24  difficulty comes from the slider mailbox
  11/17/25      karthi24  began conversion from TemplateService.c
  01/16/12 09:58 jec      began conversion from TemplateFSM.c
 ****************************************************************************/
@@ -23,9 +27,11 @@
 */
 #include "ES_Configure.h"
 #include "ES_Framework.h"
+#include "ES_EventTable.h"
 
 #include "LEDService.h"
 #include "GameSM.h"
+#include "EventCheckers.h"
 #include "DM_Display.h"
 #include "FontStuff.h"
 #include "PIC32_SPI_HAL.h"
@@ -38,6 +44,7 @@
 /* prototypes for private functions for this service.They should be functions
    relevant to the behavior of this service
 */
+static LEDService_t *This(void);
 static void LED_SPI_Init(void);
 static void LED_NeopixelInit(void);
 static uint8_t ScaleWithBrightness(uint8_t);
@@ -48,19 +55,52 @@ static void LED_RenderDifficulty(uint8_t pct);
 static void LED_RenderCountdown(uint8_t seconds_remaining);
 static void LED_RenderScore(uint16_t score);
 static void LED_RenderMessage(LED_MessageID_t msgID);
+
+// event handlers, one per event type in LEDTable
+static ES_Event_t LED_Init(ES_Event_t ThisEvent);
+static ES_Event_t LED_ShowDifficulty(ES_Event_t ThisEvent);
+static ES_Event_t LED_ShowCountdown(ES_Event_t ThisEvent);
+static ES_Event_t LED_ShowScore(ES_Event_t ThisEvent);
+static ES_Event_t LED_ShowMessage(ES_Event_t ThisEvent);
+static ES_Event_t LED_PushStep(ES_Event_t ThisEvent);
+static ES_Event_t LED_DifficultyChanged(ES_Event_t ThisEvent);
 /*---------------------------- Module Variables ---------------------------*/
 // with the introduction of Gen2, we need a module level Priority variable
+// It is the same in every context, so it stays a module variable.
 static uint8_t MyPriority;
-static bool    g_LedPushPending = false;
+// the display is hardware, there is one however many contexts there are
 static bool g_DisplayInitDone = false;
-static uint8_t LastDifficultyBucket = 0xFF; // invalid to force first update
+
+// the instance named in SERV_4_CONTEXT. A framework context may be given
+// another one of its own, see ES_Context.h
+LEDService_t LEDServiceInstance;
+
+// these live in the instance of the current context (see This), and the
+// names reach them there
+#define g_LedPushPending (This()->LedPushPending)
+#define LastDifficultyBucket (This()->LastDifficultyBucket)
+
+ES_TABLE_BEGIN
+static ES_EventHandler_t const LEDTable[ES_NUM_EVENT_TYPES] =
+{
+    ES_ROW_DEFAULTS,
+    [ES_INIT]                 = LED_Init,
+    [ES_LED_SHOW_DIFFICULTY]  = LED_ShowDifficulty,
+    [ES_LED_SHOW_COUNTDOWN]   = LED_ShowCountdown,
+    [ES_LED_SHOW_SCORE]       = LED_ShowScore,
+    [ES_LED_SHOW_MESSAGE]     = LED_ShowMessage,
+    [ES_LED_PUSH_STEP]        = LED_PushStep,
+    [ES_DIFFICULTY_CHANGED]   = LED_DifficultyChanged,
+};
+ES_TABLE_END
 
 /*------------------------------ Module Code ------------------------------*/
 /****************************************************************************
  Function
-     InitTemplateService
+     InitLEDService
 
  Parameters
+     void * : the instance for this context
      uint8_t : the priorty of this service
 
  Returns
@@ -70,13 +110,18 @@ static uint8_t LastDifficultyBucket = 0xFF; // invalid to force first update
      Saves away the priority, and does any
      other required initialization for this service
  Notes
+     the framework has already made pContext the instance of this context
 
  Author
      J. Edward Carryer, 01/16/12, 10:00
 ****************************************************************************/
-bool InitLEDService(uint8_t Priority)
+bool InitLEDService(void *pContext, uint8_t Priority)
 {
+    (void)pContext;
     MyPriority = Priority;
+    g_LedPushPending = false;
+    LastDifficultyBucket = 0xFF; // invalid to force first update
+    ES_Mailbox_Subscribe(&DifficultyMailbox, MyPriority);
     /********************************************
      in here you write your initialization code
      *******************************************/
@@ -119,88 +164,108 @@ bool PostLEDService(ES_Event_t ThisEvent)
     RunLEDService
 
  Parameters
+   void * : the instance for this context
    ES_Event_t : the event to process
 
  Returns
    ES_Event, ES_NO_EVENT if no error ES_ERROR otherwise
 
  Description
-   add your description here
+   runs the handler for the event type from LEDTable
  Notes
+   the handlers reach the instance through This(), which is pContext
 
  Author
    J. Edward Carryer, 01/15/12, 15:23
 ****************************************************************************/
-ES_Event_t RunLEDService(ES_Event_t ThisEvent)
+ES_Event_t RunLEDService(void *pContext, ES_Event_t ThisEvent)
 {
-  ES_Event_t ReturnEvent = { .EventType = ES_NO_EVENT };
-  /********************************************
-   in here you write your service code
-   *******************************************/
-  switch(ThisEvent.EventType){
-        case ES_INIT:{
-            // --- Code : Display init sequence ---
-            if (!g_DisplayInitDone) {
-                bool done = DM_TakeInitDisplayStep();   // performs 1 small init step
-
-                if (!done) {
-                    // Not finished yet: re-post ES_INIT to ourselves so that
-                    // the next step happens on the next framework dispatch.
-                    ES_Event_t again = { .EventType = ES_INIT };
-                    PostLEDService(again);
-
-                    // Stay in GS_InitPState and DO NOT fall through to the rest yet.
-                    return ReturnEvent;
-                }
-
-                    // At this point the display is fully initialized.
-                    g_DisplayInitDone = true;
-            }
-        }break;
-        
-        case ES_LED_SHOW_DIFFICULTY:
-            LED_RenderDifficulty((uint8_t)ThisEvent.EventParam);
-            break;
-            
-        case ES_LED_SHOW_COUNTDOWN:
-            LED_RenderCountdown((uint8_t)ThisEvent.EventParam);
-            break;
-        
-        case ES_LED_SHOW_SCORE:
-            LED_RenderScore((uint16_t)ThisEvent.EventParam);
-            break;
-            
-        case ES_LED_SHOW_MESSAGE:
-            LED_RenderMessage((LED_MessageID_t)ThisEvent.EventParam);
-            break;
-        
-        case ES_LED_PUSH_STEP:{
-            // Row-by-row non-blocking push to the physical display
-            if (g_LedPushPending) {
-                bool done = DM_TakeDisplayUpdateStep();   // sends 1 row this call
-                if (!done) {
-                    ES_Event_t again = { .EventType = ES_LED_PUSH_STEP };
-                    PostLEDService(again);
-                } else {
-                    g_LedPushPending = false;             // all 8 rows sent
-                }
-            }      
-        }break;
-        
-        case ES_DIFFICULTY_CHANGED:{
-          uint8_t diffPct = (uint8_t)ThisEvent.EventParam;  // assuming 0?100
-          LED_UpdateDifficultyNeopixels(diffPct);
-        }break;
-          
-   
-            
-  }
-  return ReturnEvent;
+  (void)pContext;
+  return ES_DISPATCH_ROW(LEDTable, ThisEvent);
+}
+
+/***************************************************************************
+ event handlers, one per event type in LEDTable
+ ***************************************************************************/
+static ES_Event_t LED_Init(ES_Event_t ThisEvent)
+{
+    (void)ThisEvent;
+    // --- Code : Display init sequence ---
+    if (!g_DisplayInitDone) {
+        bool done = DM_TakeInitDisplayStep();   // performs 1 small init step
+
+        if (!done) {
+            // Not finished yet: re-post ES_INIT to ourselves so that
+            // the next step happens on the next framework dispatch.
+            ES_Event_t again = { .EventType = ES_INIT };
+            PostLEDService(again);
+            return ES_EVENT_HANDLED;
+        }
+
+            // At this point the display is fully initialized.
+            g_DisplayInitDone = true;
+    }
+    return ES_EVENT_HANDLED;
+}
+
+static ES_Event_t LED_ShowDifficulty(ES_Event_t ThisEvent)
+{
+    LED_RenderDifficulty((uint8_t)ThisEvent.EventParam);
+    return ES_EVENT_HANDLED;
+}
+
+static ES_Event_t LED_ShowCountdown(ES_Event_t ThisEvent)
+{
+    LED_RenderCountdown((uint8_t)ThisEvent.EventParam);
+    return ES_EVENT_HANDLED;
+}
+
+static ES_Event_t LED_ShowScore(ES_Event_t ThisEvent)
+{
+    LED_RenderScore((uint16_t)ThisEvent.EventParam);
+    return ES_EVENT_HANDLED;
+}
+
+static ES_Event_t LED_ShowMessage(ES_Event_t ThisEvent)
+{
+    LED_RenderMessage((LED_MessageID_t)ThisEvent.EventParam);
+    return ES_EVENT_HANDLED;
+}
+
+static ES_Event_t LED_PushStep(ES_Event_t ThisEvent)
+{
+    (void)ThisEvent;
+    // Row-by-row non-blocking push to the physical display
+    if (g_LedPushPending) {
+        bool done = DM_TakeDisplayUpdateStep();   // sends 1 row this call
+        if (!done) {
+            ES_Event_t again = { .EventType = ES_LED_PUSH_STEP };
+            PostLEDService(again);
+        } else {
+            g_LedPushPending = false;             // all 8 rows sent
+        }
+    }      
+    return ES_EVENT_HANDLED;
+}
+
+static ES_Event_t LED_DifficultyChanged(ES_Event_t ThisEvent)
+{
+    (void)ThisEvent;
+    // latest slider value, which also re-arms the notification
+    uint8_t diffPct = (uint8_t)ES_Mailbox_Take(&DifficultyMailbox, MyPriority);
+    LED_UpdateDifficultyNeopixels(diffPct);
+    return ES_EVENT_HANDLED;
 }
 
 /***************************************************************************
  private functions
  ***************************************************************************/
+// the LED state of the current framework context
+static LEDService_t *This(void)
+{
+    return (LEDService_t *)ES_GetServiceContext(MyPriority);
+}
+
 static void LED_SPI_Init(void)
 {
   // Basic SPI1 setup for MAX7219 dot-matrix
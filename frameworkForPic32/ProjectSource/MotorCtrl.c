@@ -14,6 +14,11 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/18/26   karthi24    multi-instance service, the axes are kept per context
+ 10/18/26   karthi24    gear servo timer has no response function
+ 10/18/26   karthi24    gear servo returns to rest from a timer callback
+ 10/18/26   karthi24    balloon update timer posts ES_BALLOON_FRAME
+ 10/18/26   karthi24    balloon update frames come from a periodic timer
  11/19/25   karthi24    Completed tuning of motor limits for final project
  11/17/25   karthi24    started minor functionality changes, scoring system, LED service, longer messages
  11/14/25   karthi24    completed integration testing
@@ -75,7 +80,9 @@
    relevant to the behavior of this service
 */
 
+static MotorCtrl_t *This(void);
 static void MotorHW_InitServos(void);
+static void GearServoToRest(uint8_t Num);
 
 /* prototypes for public functions for this service.They should be functions
    relevant to the behavior of this service
@@ -87,10 +94,17 @@ void MC_CommandFall(uint8_t idx);
 uint8_t MC_CountBalloonsAboveMidline(void);
 /*---------------------------- Module Variables ---------------------------*/
 // with the introduction of Gen2, we need a module level Priority variable
+// It is the same in every context, so it stays a module variable.
 static uint8_t MyPriority;
 
-static Axis_t Ax[3]; // each axis has one balloon
-static bool g_crashed = false;
+// the instance named in SERV_3_CONTEXT. A framework context may be given
+// another one of its own, see ES_Context.h
+MotorCtrl_t MotorCtrlInstance;
+
+// the axes live in the instance of the current context (see This), and
+// these names reach them there
+#define Ax (This()->Ax)
+#define g_crashed (This()->Crashed)
 
 const uint8_t chan[3] = {   B1_SERVO_CHANNEL,
                             B2_SERVO_CHANNEL,
@@ -101,6 +115,7 @@ const uint8_t chan[3] = {   B1_SERVO_CHANNEL,
      InitMotorCtrl
 
  Parameters
+     void * : the instance for this context
      uint8_t : the priorty of this service
 
  Returns
@@ -110,17 +125,24 @@ const uint8_t chan[3] = {   B1_SERVO_CHANNEL,
      Saves away the priority, and does any
      other required initialization for this service
  Notes
+     the framework has already made pContext the instance of this context,
+     which is where Ax now points
 
  Author
      J. Edward Carryer, 01/16/12, 10:00
 ****************************************************************************/
-bool InitMotorCtrl(uint8_t Priority)
+bool InitMotorCtrl(void *pContext, uint8_t Priority)
 {
+    (void)pContext;
     ES_Event_t e = { .EventType = ES_INIT };
 
     MyPriority = Priority;
    
-    ES_Timer_InitTimer(TID_BALLOON_UPDATE, 100); // Tunable parameter for the update rate of the servos
+    ES_Event_t frame = { .EventType = ES_BALLOON_FRAME };
+    ES_Timer_SetEvent(TID_BALLOON_UPDATE, frame);
+    ES_Timer_InitPeriodic(TID_BALLOON_UPDATE, 100); // Tunable parameter for the update rate of the servos
+    // nothing to decide when the gear servo dwell ends, so skip the queue
+    ES_Timer_SetCallback(TID_GEAR_SERVO, GearServoToRest);
     
     MotorHW_InitServos();
     
@@ -137,6 +159,7 @@ bool InitMotorCtrl(uint8_t Priority)
         Ax[i].tgt_ticks     = Ax[i].ceiling_ticks;
         Ax[i].max_step      = 50;                  // will be overridden by MC_SetDifficultyPercent
     }
+    g_crashed = false;
     
 //    printf("Initializing motor control\r\n");
     /********************************************
@@ -173,6 +196,7 @@ bool PostMotorCtrl(ES_Event_t ThisEvent)
     RunMotorCtrl
 
  Parameters
+   void * : the instance for this context
    ES_Event_t : the event to process
 
  Returns
@@ -181,17 +205,19 @@ bool PostMotorCtrl(ES_Event_t ThisEvent)
  Description
    add your description here
  Notes
+   Ax reaches the instance through This(), which is pContext
 
  Author
    J. Edward Carryer, 01/15/12, 15:23
 ****************************************************************************/
-ES_Event_t RunMotorCtrl(ES_Event_t ThisEvent)
+ES_Event_t RunMotorCtrl(void *pContext, ES_Event_t ThisEvent)
 {
+    (void)pContext;
     ES_Event_t ret = { .EventType=ES_NO_EVENT };
     /********************************************
      in here you write your service code
      *******************************************/
-    if((ThisEvent.EventType == ES_TIMEOUT) && (ThisEvent.EventParam == TID_BALLOON_UPDATE)){
+    if(ThisEvent.EventType == ES_BALLOON_FRAME){
         
         // Slew each axis toward target
         if(QueryGameSM() == GS_Gameplay){
@@ -223,14 +249,6 @@ ES_Event_t RunMotorCtrl(ES_Event_t ThisEvent)
             }
         }
         
-        ES_Timer_InitTimer(TID_BALLOON_UPDATE, 100); // new update frame
-        return ret;
-    }
-// Handling gear dispensing
-    if (ThisEvent.EventType == ES_TIMEOUT && ThisEvent.EventParam == TID_GEAR_SERVO){
-//        if the timer expires, it means the servo is in the dispensing position and so needs to now come back to the resting position
-        uint16_t restTicks     = SERVO_US_TO_TICKS(GEAR_SERVO_REST_US);
-        PWMOperate_SetPulseWidthOnChannel(restTicks, GEAR_SERVO_CHANNEL);
         return ret;
     }
 
@@ -314,6 +332,11 @@ uint8_t MC_CountBalloonsAboveDangerline(void)
 /***************************************************************************
  private functions
  ***************************************************************************/
+// the balloons of the current framework context
+static MotorCtrl_t *This(void){
+    return (MotorCtrl_t *)ES_GetServiceContext(MyPriority);
+}
+
 static void MotorHW_InitServos(void){
     // We will use channels 1, 3, 4, 5 (OC1, OC3, OC4, OC5)
     PWMSetup_BasicConfig(5);   // init all 5 channels in the library
@@ -335,6 +358,14 @@ static void MotorHW_InitServos(void){
     PWMSetup_MapChannelToOutputPin(4, PWM_RPA4);   // B2
     PWMSetup_MapChannelToOutputPin(5, PWM_RPA2);   // B3
 }
+
+// TID_GEAR_SERVO callback, run from the timer tick response
+static void GearServoToRest(uint8_t Num){
+    (void)Num;
+//        if the timer expires, it means the servo is in the dispensing position and so needs to now come back to the resting position
+    uint16_t restTicks     = SERVO_US_TO_TICKS(GEAR_SERVO_REST_US);
+    PWMOperate_SetPulseWidthOnChannel(restTicks, GEAR_SERVO_CHANNEL);
+}
 /*------------------------------- Footnotes -------------------------------*/
 /*------------------------------ End of file ------------------------------*/
 
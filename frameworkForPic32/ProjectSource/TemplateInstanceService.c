@@ -0,0 +1,142 @@
+/****************************************************************************
+ Module
+   TemplateInstanceService.c
+
+ Revision
+   1.0.1
+
+ Description
+   This is a template file for implementing a service that is registered
+   more than once under the Gen2 Events and Services Framework, with one
+   context per instance.
+
+ Notes
+   To register instance 0 of this service as service n, ES_Configure.h has:
+   #define SERV_n_HEADER "TemplateInstanceService.h"
+   #define SERV_n_INIT InitTemplateInstance
+   #define SERV_n_RUN RunTemplateInstance
+   #define SERV_n_CONTEXT (&TemplateInstances[0])
+   All of the state of an instance lives in its context, never in module
+   level variables.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/18/26       karthi24     began conversion from TemplateService.c
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "TemplateInstanceService.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+
+/*---------------------------- Module Functions ---------------------------*/
+/* prototypes for private functions for this service.They should be functions
+   relevant to the behavior of this service, and take the context as their
+   first parameter
+*/
+
+/*---------------------------- Module Variables ---------------------------*/
+// the instance contexts. Anything that would have been a module variable in
+// a single instance service goes into TemplateInstance_t instead
+TemplateInstance_t TemplateInstances[NUM_TEMPLATE_INSTANCES] =
+{
+  { { 0 }, 0 },
+  { { 0 }, 1 }
+};
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     InitTemplateInstance
+
+ Parameters
+     void * : the context of this instance
+     uint8_t : the priorty of this instance
+
+ Returns
+     bool, false if error in initialization, true otherwise
+
+ Description
+     does any required initialization for this instance
+ Notes
+     the framework has already stored Priority in the context
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+bool InitTemplateInstance(void *pContext, uint8_t Priority)
+{
+  TemplateInstance_t  *pThis = (TemplateInstance_t *)pContext;
+  ES_Event_t          ThisEvent;
+
+  (void)Priority;
+  /********************************************
+   in here you write your initialization code
+   *******************************************/
+  // post the initial transition event
+  ThisEvent.EventType = ES_INIT;
+  return PostTemplateInstance(pThis, ThisEvent);
+}
+
+/****************************************************************************
+ Function
+     PostTemplateInstance
+
+ Parameters
+     TemplateInstance_t * : the instance to post to
+     ES_Event_t ThisEvent ,the event to post to the queue
+
+ Returns
+     bool false if the Enqueue operation failed, true otherwise
+
+ Description
+     Posts an event to the queue of one instance
+ Notes
+
+ Author
+     karthi24, 10/18/26
+****************************************************************************/
+bool PostTemplateInstance(TemplateInstance_t *pThis, ES_Event_t ThisEvent)
+{
+  return ES_PostToInstance(pThis, ThisEvent);
+}
+
+/****************************************************************************
+ Function
+    RunTemplateInstance
+
+ Parameters
+   void * : the context of this instance
+   ES_Event_t : the event to process
+
+ Returns
+   ES_Event, ES_NO_EVENT if no error ES_ERROR otherwise
+
+ Description
+   add your description here
+ Notes
+
+ Author
+   karthi24, 10/18/26
+****************************************************************************/
+ES_Event_t RunTemplateInstance(void *pContext, ES_Event_t ThisEvent)
+{
+  TemplateInstance_t  *pThis = (TemplateInstance_t *)pContext;
+  ES_Event_t          ReturnEvent;
+
+  (void)pThis;
+  (void)ThisEvent;
+  ReturnEvent.EventType = ES_NO_EVENT; // assume no errors
+  /********************************************
+   in here you write your service code, using pThis for all state
+   *******************************************/
+  return ReturnEvent;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -14,6 +14,12 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/18/26       karthi24 'k' key prints the timer callback statistics too
+ 10/18/26       karthi24 'j' key prints the tick interrupt statistics
+ 10/18/26       karthi24 'k' key prints the timer wake-up statistics
+ 10/18/26       karthi24 't' key prints the state machine statistics
+ 10/18/26       karthi24 's' key prints the queue size advice
+ 10/18/26       karthi24 Timer2ISR posts through its interrupt post ring
  10/26/17 18:26 jec     moves definition of ALL_BITS to ES_Port.h
  10/19/17 21:28 jec     meaningless change to test updating
  10/19/17 18:42 jec     removed referennces to driverlib and programmed the
@@ -39,6 +45,8 @@
 #include "ES_Configure.h"
 #include "ES_Framework.h"
 #include "ES_DeferRecall.h"
+#include "ES_QueueStats.h"
+#include "ES_SMStats.h"
 #include "ES_Port.h"
 #include "terminal.h"
 #include "dbprintf.h"
@@ -237,6 +245,44 @@ ES_Event_t RunTestHarnessService0(ES_Event_t ThisEvent)
         StartTMR2();
       }
 #endif
+#ifdef ES_QUEUE_STATS
+      if ('s' == ThisEvent.EventParam)
+      {
+        ES_QueueStats_PrintAdvice();
+        ES_QueueStats_Reset();
+      }
+#endif
+#ifdef ES_SM_STATS
+      if ('t' == ThisEvent.EventParam)
+      {
+        ES_SMStats_PrintAll();
+      }
+#endif
+      if ('k' == ThisEvent.EventParam)
+      {
+        uint32_t Expirations;
+        uint32_t Wakeups;
+        uint32_t MaxTicks;
+        uint8_t  Slowest;
+        uint32_t LongCallbacks;
+
+        ES_Timer_GetWakeupStats(&Expirations, &Wakeups);
+        DB_printf("timeouts %u in %u wake-ups, %u saved by slack\r\n",
+            Expirations, Wakeups, Expirations - Wakeups);
+        ES_Timer_GetCallbackStats(&MaxTicks, &Slowest, &LongCallbacks);
+        DB_printf("longest callback %u us (timer %u), %u over %u us\r\n",
+            MaxTicks / CORE_TICKS_PER_US, Slowest, LongCallbacks,
+            TIMER_CALLBACK_MAX_US);
+      }
+      if ('j' == ThisEvent.EventParam)
+      {
+        ES_TickStats_t TickStats;
+
+        _HW_GetTickStats(&TickStats);
+        DB_printf("ticks missed %u in %u late ints, latency %u us, backlog %u\r\n",
+            TickStats.MissedTicks, TickStats.LateInts,
+            TickStats.MaxLatency / CORE_TICKS_PER_US, TickStats.MaxBacklog);
+      }
     }
     break;
     default:
@@ -304,9 +350,9 @@ void __ISR(_TIMER_2_VECTOR, IPL2AUTO) Timer2ISR(void)
 {
   // clear flag
   IFS0bits.T2IF = 0;
-  // post event
+  // post event, through our own ring so no critical region is needed
   static ES_Event_t interruptEvent = {ES_SHORT_TIMEOUT, 0};
-  PostTestHarnessService0(interruptEvent);
+  ES_PostFromISR(TEST_HARNESS_INT_RING, MyPriority, interruptEvent);
   
   // stop timer
   T2CONbits.ON = 0;
@@ -0,0 +1,212 @@
+#!/usr/bin/env python3
+"""
+ Module
+     queue_advisor.py
+
+ Description
+     Host side queue size advisor. Reads the "// QD" histogram lines that
+     ES_QueueStats_PrintAdvice (key 's' in TestHarnessService0) writes to
+     the terminal, adds up the runs found in any number of captures, and
+     prints SERV_n_QUEUE_SIZE lines for ES_Configure.h.
+
+ Notes
+     Each QD line holds one service's histogram from one run:
+
+       // QD <service> <size> <overflows> <posts at depth 1> ... <16>
+
+     where depth is the number of entries in the queue once the post was
+     made. The last depth counts every post that left 16 or more.
+
+     The advice follows ES_QueueStats_Recommend: the smallest size for which
+     the posts that would have found the queue full are no more than the
+     allowed parts per million. A service whose queue overflowed in any run
+     is given at least one more entry than the largest size that overflowed,
+     and should be measured again at that size.
+
+     Build the firmware with ES_QUEUE_STATS defined, exercise it with the
+     terminal output captured to a file, press 's' at the end of each run,
+     then:
+
+       python3 queue_advisor.py capture1.txt capture2.txt --loss-ppm 100
+
+     With no files it reads standard input. --test runs the self test.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/18/26       karthi24     started coding
+"""
+
+import argparse
+import re
+import sys
+
+# depths above this share the last histogram entry, as in ES_QueueStats.c
+MAX_TRACKED_DEPTH = 16
+
+QD_LINE = re.compile(r"//\s*QD\s+([\d\s]+)")
+
+
+class ServiceStats:
+    """the histograms of one service, summed over every run read"""
+
+    def __init__(self):
+        self.posts_at_depth = [0] * (MAX_TRACKED_DEPTH + 1)
+        self.overflows = 0
+        self.sizes = set()
+        self.overflowed_sizes = set()
+        self.runs = 0
+
+    def add_run(self, size, overflows, depths):
+        self.runs += 1
+        self.sizes.add(size)
+        self.overflows += overflows
+        if overflows != 0:
+            self.overflowed_sizes.add(size)
+        for depth, count in enumerate(depths, start=1):
+            self.posts_at_depth[min(depth, MAX_TRACKED_DEPTH)] += count
+
+    def count_posts(self):
+        return self.overflows + sum(self.posts_at_depth)
+
+    def peak(self):
+        for depth in range(MAX_TRACKED_DEPTH, 0, -1):
+            if self.posts_at_depth[depth] != 0:
+                return depth
+        return 0
+
+    def percentile(self, per_thousand):
+        """smallest depth that at least that share of the posts stayed at
+        or below, failed posts counting as deeper than any depth"""
+        needed = self.count_posts() * per_thousand
+        if needed == 0:
+            return 0
+        so_far = 0
+        for depth in range(1, MAX_TRACKED_DEPTH + 1):
+            so_far += self.posts_at_depth[depth]
+            if so_far * 1000 >= needed:
+                return depth
+        return MAX_TRACKED_DEPTH
+
+    def recommend(self, loss_ppm):
+        allowed = self.count_posts() * loss_ppm
+        size = MAX_TRACKED_DEPTH
+        for candidate in range(1, MAX_TRACKED_DEPTH):
+            # posts that would have found candidate or more waiting
+            lost = sum(self.posts_at_depth[candidate + 1:])
+            if lost * 1000000 <= allowed:
+                size = candidate
+                break
+        if self.overflowed_sizes:
+            size = max(size, max(self.overflowed_sizes) + 1)
+        return size
+
+
+def parse(lines):
+    """returns {service: ServiceStats} from the QD lines among lines"""
+    services = {}
+    for line in lines:
+        match = QD_LINE.search(line)
+        if match is None:
+            continue
+        fields = [int(field) for field in match.group(1).split()]
+        if len(fields) < 3:
+            continue
+        service, size, overflows = fields[0:3]
+        services.setdefault(service, ServiceStats()).add_run(
+            size, overflows, fields[3:])
+    return services
+
+
+def advise(services, loss_ppm):
+    """returns the ES_Configure.h fragment as a list of lines"""
+    out = ["// queue sizes for a loss of no more than %u ppm, from %u run(s)"
+           % (loss_ppm, max([s.runs for s in services.values()] + [0]))]
+    now_total = 0
+    new_total = 0
+    for service in sorted(services):
+        stats = services[service]
+        size = stats.recommend(loss_ppm)
+        now = max(stats.sizes)
+        now_total += now
+        new_total += size
+        out.append("#define SERV_%d_QUEUE_SIZE %d // now %s, peak %d, "
+                   "99.9%% %d, %u posts, %u overflows"
+                   % (service, size, "/".join(str(s) for s in sorted(stats.sizes)),
+                      stats.peak(), stats.percentile(999),
+                      stats.count_posts(), stats.overflows))
+    out.append("// %d queue entries in all, now %d" % (new_total, now_total))
+    return out
+
+
+def self_test():
+    """checks the advice against histograms worked out by hand"""
+    capture = [
+        "junk before the stats\r",
+        "// QD 0 3 0 100 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0\r",
+        # 1000 posts, 2 of them at depth 4: 2000 ppm lost at size 3
+        "// QD 1 5 0 900 90 8 2 0 0 0 0 0 0 0 0 0 0 0 0",
+        "#define SERV_1_QUEUE_SIZE 4 // pasted advice is ignored",
+        # a second run of service 1 that overflowed its 5 entries
+        "  // QD 1 5 1 10 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0",
+        "// QD 2 5 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0",
+    ]
+    services = parse(capture)
+    errors = 0
+    checks = [
+        (services[0].recommend(1000), 1),
+        (services[0].peak(), 1),
+        (services[1].count_posts(), 1011),
+        (services[1].peak(), 4),
+        (services[1].percentile(999), 4),
+        (services[1].recommend(1000000), 6),    # overflowed at 5
+        (services[2].recommend(1000), 1),
+        (services[2].count_posts(), 0),
+    ]
+    services[1].overflowed_sizes.clear()
+    checks += [
+        (services[1].recommend(2000), 3),
+        (services[1].recommend(1000), 4),
+        (services[1].recommend(0), 4),
+    ]
+    for number, (got, expected) in enumerate(checks):
+        if got != expected:
+            print("check %d: got %d, not %d" % (number, got, expected))
+            errors += 1
+    print("%d errors" % errors)
+    return errors == 0
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="recommend SERV_n_QUEUE_SIZE values from the // QD "
+                    "lines of ES_QueueStats captures")
+    parser.add_argument("captures", nargs="*",
+                        help="terminal captures, standard input if none")
+    parser.add_argument("--loss-ppm", type=int, default=1000,
+                        help="posts that may be lost, parts per million "
+                             "(default 1000, QUEUE_STATS_LOSS_PPM)")
+    parser.add_argument("--test", action="store_true",
+                        help="run the self test")
+    args = parser.parse_args()
+
+    if args.test:
+        return 0 if self_test() else 1
+    lines = []
+    if args.captures:
+        for name in args.captures:
+            with open(name, errors="replace") as capture:
+                lines.extend(capture)
+    else:
+        lines.extend(sys.stdin)
+    services = parse(lines)
+    if not services:
+        print("no // QD lines found, is ES_QUEUE_STATS defined?",
+              file=sys.stderr)
+        return 1
+    print("\n".join(advise(services, args.loss_ppm)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())